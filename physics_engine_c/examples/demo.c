@@ -1,4 +1,5 @@
 #include "../include/physics_world.h"
+#include "../include/world_batch.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <time.h>
@@ -53,12 +54,12 @@ void demo_bouncing_spheres(void) {
     
     // Add some walls
     RigidBody* left_wall = rigid_body_create();
-    rigid_body_init_plane(left_wall, vector3_create(1.0f, 0.0f, 0.0f), 10.0f);
+    rigid_body_init_plane(left_wall, vector3_create(1.0f, 0.0f, 0.0f), -10.0f);
     rigid_body_set_restitution(left_wall, 0.9f);
     physics_world_add_body(world, left_wall);
     
     RigidBody* right_wall = rigid_body_create();
-    rigid_body_init_plane(right_wall, vector3_create(-1.0f, 0.0f, 0.0f), 10.0f);
+    rigid_body_init_plane(right_wall, vector3_create(-1.0f, 0.0f, 0.0f), -10.0f);
     rigid_body_set_restitution(right_wall, 0.9f);
     physics_world_add_body(world, right_wall);
     
@@ -122,37 +123,87 @@ void demo_sphere_box_collision(void) {
     rigid_body_init_aabb(box, vector3_create(0.0f, 2.0f, 0.0f), 
                         vector3_create(1.0f, 1.0f, 1.0f), 5.0f);
     rigid_body_set_restitution(box, 0.6f);
-    physics_world_add_body(world, box);
+    BodyHandle box_handle = physics_world_add_body_handle(world, box);
     
     // Create a sphere that will hit the box
     RigidBody* sphere = rigid_body_create();
     rigid_body_init_sphere(sphere, vector3_create(-5.0f, 5.0f, 0.0f), 0.5f, 1.0f);
     rigid_body_set_velocity(sphere, vector3_create(3.0f, -1.0f, 0.0f));
     rigid_body_set_restitution(sphere, 0.8f);
-    physics_world_add_body(world, sphere);
+    BodyHandle sphere_handle = physics_world_add_body_handle(world, sphere);
     
     printf("Sphere starts at (-5, 5, 0) moving towards box at (0, 2, 0)\n");
     printf("Time\tSphere Position\t\tBox Position\n");
     
-    float simulation_time = 0.0f;
     float total_time = 5.0f;
-    
-    while (simulation_time < total_time) {
-        physics_world_step(world);
-        simulation_time += world->timestep;
+    int total_steps = (int)(total_time / world->timestep);
+    int print_every = (int)(0.2f / world->timestep + 0.5f);
+    
+    // Print the last finished step while the next one runs in the background
+    PhysicsFence fence = physics_world_step_async(world);
+    for (int step = 1; step < total_steps; step++) {
+        physics_world_wait(world, fence);
+        const BodyStateSnapshot* state = physics_world_acquire_state(world);
+        fence = physics_world_step_async(world);
         
-        if (fmodf(simulation_time, 0.2f) < world->timestep) {
+        float state_time = (float)state->step * world->timestep;
+        int s = body_state_snapshot_find(state, sphere_handle);
+        int b = body_state_snapshot_find(state, box_handle);
+        
+        if (state->step > 0 && state->step % (uint64_t)print_every == 0 && s >= 0 && b >= 0) {
             printf("%.1fs\t(%.2f, %.2f, %.2f)\t(%.2f, %.2f, %.2f)\n",
-                   simulation_time,
-                   sphere->position.x, sphere->position.y, sphere->position.z,
-                   box->position.x, box->position.y, box->position.z);
+                   state_time,
+                   state->positions[s].x, state->positions[s].y, state->positions[s].z,
+                   state->positions[b].x, state->positions[b].y, state->positions[b].z);
         }
+        physics_world_release_state(world, state);
     }
+    physics_world_wait(world, fence);
     
     physics_world_destroy(world);
     printf("Sphere-Box demo completed!\n");
 }
 
+// Demo stepping many small independent worlds at once
+void demo_world_batch(void) {
+    printf("\n=== World Batch Demo ===\n");
+    
+    int world_count = 1000;
+    PhysicsWorldBatch* batch = physics_world_batch_create(world_count);
+    if (!batch) {
+        printf("Failed to create world batch!\n");
+        return;
+    }
+    physics_world_batch_set_thread_count(batch, 4);
+    
+    // Each world drops a short row of spheres from a slightly different height
+    for (int w = 0; w < world_count; w++) {
+        PhysicsWorld* world = physics_world_batch_get_world(batch, w);
+        
+        RigidBody* ground = physics_world_create_body(world);
+        rigid_body_init_plane(ground, vector3_create(0.0f, 1.0f, 0.0f), 0.0f);
+        physics_world_add_body(world, ground);
+        
+        for (int i = 0; i < 8; i++) {
+            RigidBody* sphere = physics_world_create_body(world);
+            rigid_body_init_sphere(sphere, vector3_create((float)i * 1.2f, 2.0f + (float)w * 0.01f, 0.0f), 0.5f, 1.0f);
+            physics_world_add_body(world, sphere);
+        }
+    }
+    
+    for (int step = 0; step < 120; step++) {
+        physics_world_batch_step(batch);
+    }
+    
+    printf("Stepped %d worlds for 120 steps\n", world_count);
+    printf("Throughput: %.0f world-steps/s\n", physics_world_batch_get_world_steps_per_second(batch));
+    printf("First world kinetic energy: %.2f J\n",
+           physics_world_get_total_kinetic_energy(physics_world_batch_get_world(batch, 0)));
+    
+    physics_world_batch_destroy(batch);
+    printf("World batch demo completed!\n");
+}
+
 // Test basic physics engine functionality
 void run_basic_tests(void) {
     printf("\n=== Basic Physics Engine Tests ===\n");
@@ -196,6 +247,7 @@ int main(void) {
     run_basic_tests();
     demo_bouncing_spheres();
     demo_sphere_box_collision();
+    demo_world_batch();
     
     printf("\nAll demos completed successfully!\n");
     return 0;
@@ -0,0 +1,111 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "../include/partition.h"
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// Partitioned world demo: one process per slab, exchanging borders through
+// the shared-memory rings of a single PartitionDomain
+
+#define PARTITION_COUNT 4
+#define BODIES_PER_PARTITION 64
+#define STEP_COUNT 300
+
+// Body of each child process; returns the exit status
+static int run_partition(PartitionDomain* domain, int index) {
+    Partition partition;
+    if (!partition_init(&partition, domain, index)) {
+        fprintf(stderr, "Partition %d: init failed\n", index);
+        return 1;
+    }
+
+    PhysicsWorld* world = partition.world;
+    physics_world_set_gravity(world, vector3_create(0.0f, -9.81f, 0.0f));
+
+    // Every partition has its own copy of the ground
+    RigidBody* ground = physics_world_create_body(world);
+    rigid_body_init_plane(ground, vector3_create(0.0f, 1.0f, 0.0f), 0.0f);
+    physics_world_add_body(world, ground);
+
+    // A grid of spheres drifting across the slab borders, alternating direction by row
+    float slab_width = 40.0f / (float)PARTITION_COUNT;
+    for (int i = 0; i < BODIES_PER_PARTITION; i++) {
+        RigidBody* sphere = physics_world_create_body(world);
+        float x = -20.0f + slab_width * (float)index + 0.6f + (float)(i % 8) * (slab_width - 1.2f) / 7.0f;
+        float y = 0.5f + (float)(i / 8) * 1.1f;
+        rigid_body_init_sphere(sphere, vector3_create(x, y, 0.0f), 0.4f, 1.0f);
+        rigid_body_set_velocity(sphere, vector3_create((i / 8) % 2 ? -3.0f : 3.0f, 0.0f, 0.0f));
+        if (partition_add_body(&partition, sphere) == 0) {
+            physics_world_destroy_body(world, sphere);
+        }
+    }
+
+    for (int step = 0; step < STEP_COUNT; step++) {
+        partition_step(&partition);
+    }
+
+    partition_release(&partition);
+    partition_domain_destroy(domain);
+    return 0;
+}
+
+int main(void) {
+    printf("Charvak Physics Engine Partition Demo\n");
+    printf("=====================================\n");
+
+    // Slabs 10 m wide along x, ghosts within 1 m of a border
+    PartitionDomain* domain = partition_domain_create(PARTITION_COUNT, -20.0f, 20.0f, 1.0f, 256);
+    if (!domain) {
+        printf("Failed to create partition domain!\n");
+        return 1;
+    }
+
+    pid_t children[PARTITION_COUNT];
+    for (int p = 0; p < PARTITION_COUNT; p++) {
+        children[p] = fork();
+        if (children[p] == 0) {
+            _exit(run_partition(domain, p));
+        }
+        if (children[p] < 0) {
+            // Partitions wait on each other, so a missing one would stall the rest
+            printf("Failed to fork partition %d!\n", p);
+            for (int c = 0; c < p; c++) {
+                kill(children[c], SIGKILL);
+                waitpid(children[c], NULL, 0);
+            }
+            partition_domain_destroy(domain);
+            return 1;
+        }
+    }
+
+    bool failed = false;
+    for (int p = 0; p < PARTITION_COUNT; p++) {
+        int status = 0;
+        waitpid(children[p], &status, 0);
+        failed |= !WIFEXITED(status) || WEXITSTATUS(status) != 0;
+    }
+
+    printf("Stepped %d partitions for %d steps\n", PARTITION_COUNT, STEP_COUNT);
+    int total = 0;
+    for (int p = 0; p < PARTITION_COUNT; p++) {
+        PartitionStats stats = partition_domain_get_stats(domain, p);
+        printf("Partition %d: %3d owned, %4d migrated in, %4d out, %5d ghosts sent, %5d received\n",
+               p, stats.owned_bodies, stats.migrated_in, stats.migrated_out,
+               stats.ghosts_sent, stats.ghosts_received);
+        total += stats.owned_bodies;
+    }
+    printf("Total bodies: %d of %d\n", total, PARTITION_COUNT * BODIES_PER_PARTITION);
+
+    partition_domain_destroy(domain);
+
+    if (failed || total != PARTITION_COUNT * BODIES_PER_PARTITION) {
+        printf("Partition demo failed!\n");
+        return 1;
+    }
+    printf("Partition demo completed successfully!\n");
+    return 0;
+}
@@ -0,0 +1,61 @@
+#ifndef AABB_TREE_H
+#define AABB_TREE_H
+
+#include "vector_math.h"
+#include <stdbool.h>
+
+#define AABB_TREE_NULL_NODE -1
+
+// Leaves are enlarged by this margin so small motions don't require reinsertion
+#define AABB_TREE_FAT_MARGIN 0.1f
+
+// Leaves are also stretched along the predicted displacement, scaled by this factor
+#define AABB_TREE_DISPLACEMENT_MULTIPLIER 2.0f
+
+// Node of a dynamic bounding volume tree
+typedef struct {
+    Vector3 min;           // Fat bounds (leaves) or union of children (internal nodes)
+    Vector3 max;
+    int parent;            // Parent node, or next free node while on the free list
+    int child_a;
+    int child_b;
+    int height;            // 0 for leaves, -1 for free nodes
+    int body_index;        // User data for leaves
+} AABBTreeNode;
+
+// Dynamic AABB tree with incremental insert, remove and refit
+typedef struct {
+    AABBTreeNode* nodes;
+    int node_count;
+    int node_capacity;
+    int root;
+    int free_list;
+
+    // Scratch stack for queries
+    int* stack;
+    int stack_capacity;
+} AABBTree;
+
+// Called for every leaf overlapping a query box; return false to stop the query
+typedef bool (*AABBTreeQueryCallback)(void* context, int proxy, int body_index);
+
+// Tree lifetime
+void aabb_tree_init(AABBTree* tree);
+void aabb_tree_destroy(AABBTree* tree);
+void aabb_tree_clear(AABBTree* tree);
+
+// Proxy management
+int aabb_tree_create_proxy(AABBTree* tree, Vector3 min, Vector3 max, int body_index);
+void aabb_tree_destroy_proxy(AABBTree* tree, int proxy);
+bool aabb_tree_move_proxy(AABBTree* tree, int proxy, Vector3 min, Vector3 max, Vector3 displacement);
+
+// Proxy accessors
+int aabb_tree_get_body_index(const AABBTree* tree, int proxy);
+void aabb_tree_set_body_index(AABBTree* tree, int proxy, int body_index);
+void aabb_tree_get_fat_bounds(const AABBTree* tree, int proxy, Vector3* min, Vector3* max);
+
+// Queries
+void aabb_tree_query(AABBTree* tree, Vector3 min, Vector3 max, AABBTreeQueryCallback callback, void* context);
+int aabb_tree_get_height(const AABBTree* tree);
+
+#endif // AABB_TREE_H
@@ -0,0 +1,37 @@
+#ifndef ALLOCATOR_H
+#define ALLOCATOR_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Memory callbacks used for every allocation the engine makes. The free
+// callback receives the size the block was allocated with, so a host can
+// account for physics memory without adding headers.
+typedef struct {
+    void* (*alloc)(size_t size, void* user_data);
+    void (*free)(void* ptr, size_t size, void* user_data);
+    void* user_data;
+} PhysicsAllocator;
+
+// Install allocator callbacks, or pass NULL to go back to malloc/free.
+// Only switch allocators while no engine memory is live. Worlds with
+// threads allocate from worker threads, so callbacks must be thread-safe.
+void physics_set_allocator(const PhysicsAllocator* allocator);
+PhysicsAllocator physics_get_allocator(void);
+
+// Engine-wide allocation entry points
+void* physics_alloc(size_t size);
+void* physics_realloc(void* ptr, size_t old_size, size_t new_size);
+void physics_free(void* ptr, size_t size);
+
+// Blocks aligned to `alignment` (a power of two), e.g. to cache lines. Free
+// and grow them with the size and alignment they were allocated with.
+void* physics_alloc_aligned(size_t size, size_t alignment);
+void physics_free_aligned(void* ptr, size_t size, size_t alignment);
+
+// Grow a heap array so it can hold at least `needed` elements
+bool physics_ensure_capacity(void** array, int* capacity, int needed, size_t element_size);
+bool physics_ensure_capacity_aligned(void** array, int* capacity, int needed, size_t element_size,
+                                     size_t alignment);
+
+#endif // ALLOCATOR_H
@@ -0,0 +1,91 @@
+#ifndef BODY_POOL_H
+#define BODY_POOL_H
+
+#include "rigid_body.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Per-body state flags
+#define BODY_FLAG_STATIC   0x01
+#define BODY_FLAG_SLEEPING 0x02
+
+// Structure-of-arrays storage for the bodies of a world. Each field lives
+// in its own contiguous array so a phase streams only the data it touches;
+// index i in every array refers to the same body.
+typedef struct {
+    int count;
+    int capacity;
+
+    // Linear state (hot)
+    Vector3* position;
+    Vector3* velocity;
+    Vector3* acceleration;
+    Vector3* force;
+    float* inverse_mass;
+    uint8_t* flags;
+
+    // Angular state
+    Vector3* rotation;
+    Vector3* angular_velocity;
+    Vector3* angular_acceleration;
+    Vector3* torque;
+
+    // Shape and material (cold)
+    uint8_t* shape_type;
+    CollisionShape* shape;
+    float* mass;
+    float* restitution;
+    float* friction;
+
+    // Sleeping (simulation only, never copied to or from RigidBody)
+    float* sleep_time;             // Seconds the body has been at rest
+    uint32_t* island;              // Id of the island it fell asleep with, 0 if none
+} BodyPool;
+
+// Pool lifetime
+bool body_pool_init(BodyPool* pool, int capacity);
+bool body_pool_reserve(BodyPool* pool, int capacity);
+void body_pool_destroy(BodyPool* pool);
+void body_pool_clear(BodyPool* pool);
+
+// Slot management; adding grows the pool as needed and removal moves the
+// last body into the freed slot
+int body_pool_add(BodyPool* pool, const RigidBody* body);
+void body_pool_remove(BodyPool* pool, int index);
+
+// Reorder slots so new slot i holds old slot order[i]. Scratch must hold
+// body_pool_permute_scratch_size bytes.
+size_t body_pool_permute_scratch_size(const BodyPool* pool);
+void body_pool_permute(BodyPool* pool, const int* order, void* scratch);
+
+// Copy state between RigidBody structs and pool slots
+void body_pool_load(BodyPool* pool, int index, const RigidBody* body);
+void body_pool_store(const BodyPool* pool, int index, RigidBody* body);
+
+// Bounds of a slot's shape at its current position
+void body_pool_get_aabb(const BodyPool* pool, int index, Vector3* min, Vector3* max);
+
+// Bounds swept along the slot's velocity over time; the plain bounds when
+// time is 0. Used by speculative contacts.
+void body_pool_get_swept_aabb(const BodyPool* pool, int index, float time, Vector3* min, Vector3* max);
+bool body_pool_swept_aabb_overlap(const BodyPool* pool, int index_a, int index_b, float time);
+
+// Flag helpers
+static inline bool body_pool_is_static(const BodyPool* pool, int index) {
+    return (pool->flags[index] & BODY_FLAG_STATIC) != 0;
+}
+
+static inline bool body_pool_is_sleeping(const BodyPool* pool, int index) {
+    return (pool->flags[index] & BODY_FLAG_SLEEPING) != 0;
+}
+
+static inline void body_pool_set_sleeping(BodyPool* pool, int index, bool sleeping) {
+    if (sleeping) {
+        pool->flags[index] |= BODY_FLAG_SLEEPING;
+    } else {
+        pool->flags[index] &= (uint8_t)~BODY_FLAG_SLEEPING;
+    }
+}
+
+#endif // BODY_POOL_H
@@ -0,0 +1,42 @@
+#ifndef BODY_SLAB_H
+#define BODY_SLAB_H
+
+#include "rigid_body.h"
+#include <stdbool.h>
+
+// Chunk sizes, in bodies; each new chunk doubles up to the maximum
+#define BODY_SLAB_MIN_CHUNK 64
+#define BODY_SLAB_MAX_CHUNK 4096
+
+// One contiguous block of bodies
+typedef struct BodySlabChunk {
+    struct BodySlabChunk* next;
+    RigidBody* bodies;
+    int capacity;
+} BodySlabChunk;
+
+// Slab allocator for RigidBody structs. Bodies are carved from large
+// chunks and recycled through a free list threaded through unused bodies,
+// so spawning many bodies costs a handful of allocations and keeps them
+// close together in memory.
+typedef struct {
+    BodySlabChunk* chunks;
+    RigidBody* free_list;
+    int chunk_count;
+    int capacity;              // Bodies across all chunks
+    int live_count;
+    int next_chunk_capacity;
+} BodySlab;
+
+// Slab lifetime; destroy releases every chunk, live bodies included.
+// Reserve makes room for `count` bodies in total.
+void body_slab_init(BodySlab* slab);
+void body_slab_destroy(BodySlab* slab);
+bool body_slab_reserve(BodySlab* slab, int count);
+
+// Body allocation; allocated bodies are uninitialized
+RigidBody* body_slab_alloc(BodySlab* slab);
+void body_slab_free(BodySlab* slab, RigidBody* body);
+bool body_slab_owns(const BodySlab* slab, const RigidBody* body);
+
+#endif // BODY_SLAB_H
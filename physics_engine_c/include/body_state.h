@@ -0,0 +1,58 @@
+#ifndef BODY_STATE_H
+#define BODY_STATE_H
+
+#include "body_pool.h"
+#include "handle_table.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// Copy of the bodies' visible state at the end of one step. Arrays are in
+// body index order as of that step; look bodies up by handle, since indices
+// change between steps.
+typedef struct {
+    int count;
+    int capacity;
+    BodyHandle* handles;
+    int* body_ids;
+    Vector3* positions;
+    Vector3* velocities;
+    Vector3* rotations;
+
+    int* slot_index;           // Handle slot -> index in this snapshot, or -1
+    int slot_count;
+    int slot_capacity;
+
+    uint64_t step;             // Number of steps the world had taken
+    int readers;               // Acquisitions not yet released
+} BodyStateSnapshot;
+
+// Front/back pair of snapshots. Readers acquire the front snapshot, which is
+// never written while acquired; the stepping thread captures into the back
+// snapshot and publishes it by swapping the two.
+typedef struct BodyStateBuffers BodyStateBuffers;
+
+// Buffers lifetime; returns NULL if allocation fails
+BodyStateBuffers* body_state_buffers_create(void);
+void body_state_buffers_destroy(BodyStateBuffers* buffers);
+
+// Readers: the snapshot stays valid and unchanged until released
+const BodyStateSnapshot* body_state_buffers_acquire(BodyStateBuffers* buffers);
+void body_state_buffers_release(BodyStateBuffers* buffers, const BodyStateSnapshot* snapshot);
+
+// Writer: capture the pool into the back snapshot, waiting for readers still
+// holding it from before the last swap, then make it the front snapshot.
+// Returns false and keeps the old front snapshot if the copy cannot grow.
+bool body_state_buffers_publish(BodyStateBuffers* buffers, const BodyPool* pool, const HandleTable* handles,
+                                RigidBody* const* bodies, uint64_t step);
+
+// Index of a body in a snapshot, or -1 if the handle is stale or the body
+// was added after the snapshot was taken
+static inline int body_state_snapshot_find(const BodyStateSnapshot* snapshot, BodyHandle handle) {
+    if (!snapshot || handle.slot >= (uint32_t)snapshot->slot_count) return -1;
+
+    int index = snapshot->slot_index[handle.slot];
+    if (index < 0 || snapshot->handles[index].generation != handle.generation) return -1;
+    return index;
+}
+
+#endif // BODY_STATE_H
@@ -0,0 +1,137 @@
+#ifndef BROAD_PHASE_H
+#define BROAD_PHASE_H
+
+#include "body_pool.h"
+#include "aabb_tree.h"
+#include "spatial_hash.h"
+#include <stdbool.h>
+
+// Broad phase algorithms available to a physics world
+typedef enum {
+    BROAD_PHASE_BRUTE_FORCE,      // Test every pair of bodies (O(n^2))
+    BROAD_PHASE_SWEEP_AND_PRUNE,  // Incremental sort and sweep over AABB endpoints
+    BROAD_PHASE_AABB_TREE,        // Dynamic bounding volume tree with fat leaves
+    BROAD_PHASE_SPATIAL_HASH      // Uniform hashed grid, best for crowds of similar bodies
+} BroadPhaseType;
+
+// Candidate pair of body indices (index_a < index_b) passed to the narrow phase
+typedef struct {
+    int index_a;
+    int index_b;
+} BroadPhasePair;
+
+// One end of a body's AABB projected onto an axis
+typedef struct {
+    float value;
+    int data;  // (label << 1) | is_max; labels equal body indices after each update
+} SweepEndpoint;
+
+// A different sweep axis is only taken once its spread of body centres
+// beats the current axis by this factor, so near-ties don't re-sort each step
+#define SWEEP_AND_PRUNE_AXIS_SWITCH 1.25f
+
+// Sweep-and-prune state. Endpoints are kept sorted along the sweep axis
+// only; they stay sorted between steps, so refreshing them with insertion
+// sort is close to O(n) for coherent motion. Changing axis re-sorts them.
+typedef struct {
+    SweepEndpoint* endpoints;
+    int endpoint_count;
+    int endpoint_capacity;
+    int sweep_axis;
+
+    // Per-body bounds cached for the current update
+    Vector3* mins;
+    Vector3* maxs;
+    int proxy_count;
+    int proxy_capacity;
+
+    // Sets of bodies open while sweeping, split into moving bodies and
+    // resting ones (static or sleeping) so resting pairs are never tested.
+    // active_slot is a body's position in whichever set holds it.
+    int* active;
+    int* resting;
+    int* active_slot;
+
+    // Endpoint label <-> body index maps. Removal only edits these; the
+    // endpoints themselves are relabelled in one pass on the next update.
+    int* body_label;
+    int* label_body;       // -1 for labels of removed bodies
+    int label_count;
+    int label_capacity;
+    bool has_stale_labels;
+} SweepAndPrune;
+
+// Dynamic AABB tree state
+typedef struct {
+    AABBTree tree;
+    int* proxies;          // Tree proxy per body index, AABB_TREE_NULL_NODE for planes
+    int body_count;
+    int body_capacity;
+} TreeBroadPhase;
+
+// Broad phase front end owned by a physics world
+typedef struct {
+    BroadPhaseType type;
+    SweepAndPrune sap;
+    TreeBroadPhase tree;
+    
+    // Hashed grid over body positions. Maintained for every broad phase type
+    // because the world's wake pass queries it as well.
+    SpatialHash grid;
+    
+    // Time used to predict body displacement when fattening tree leaves
+    float prediction_time;
+
+    // When positive, every broad phase sweeps body bounds along velocity
+    // over this time, so pairs that may close their gap by then are reported
+    // for speculative contacts
+    float speculative_time;
+
+    // Candidate pairs from the last update
+    BroadPhasePair* pairs;
+    int pair_count;
+    int pair_capacity;
+} BroadPhase;
+
+// Broad phase lifetime
+void broad_phase_init(BroadPhase* broad_phase, BroadPhaseType type);
+void broad_phase_destroy(BroadPhase* broad_phase);
+
+// Proxy management (indices refer to the world's body array). Planes get
+// an index but no proxy; the world tests them in a separate pass. Removal
+// moves the last body into the freed index, as the world's body pool does.
+bool broad_phase_add_body(BroadPhase* broad_phase, const BodyPool* pool, int body_index);
+void broad_phase_remove_body(BroadPhase* broad_phase, int body_index);
+void broad_phase_clear(BroadPhase* broad_phase);
+
+// Follow a reordering of the world's bodies: new index i is old index
+// order[i]. Scratch must hold one int per body.
+void broad_phase_permute(BroadPhase* broad_phase, const int* order, int* scratch);
+
+// Refresh bounds and rebuild the candidate pair list
+void broad_phase_update(BroadPhase* broad_phase, const BodyPool* pool);
+
+// Sort candidate pairs by (index_a, index_b), so pair order depends only on
+// which pairs overlap and not on the broad phase's internal history
+void broad_phase_sort_pairs(BroadPhase* broad_phase);
+
+// Sweep-and-prune internals
+void sweep_and_prune_init(SweepAndPrune* sap);
+void sweep_and_prune_destroy(SweepAndPrune* sap);
+bool sweep_and_prune_add_proxy(SweepAndPrune* sap, int body_index, bool has_bounds);
+void sweep_and_prune_remove_proxy(SweepAndPrune* sap, int body_index);
+void sweep_and_prune_permute(SweepAndPrune* sap, const int* order, int* scratch);
+void sweep_and_prune_update(SweepAndPrune* sap, const BodyPool* pool, BroadPhase* out);
+
+// Dynamic AABB tree internals
+void tree_broad_phase_init(TreeBroadPhase* tree);
+void tree_broad_phase_destroy(TreeBroadPhase* tree);
+bool tree_broad_phase_add_proxy(TreeBroadPhase* tree, const BodyPool* pool, int body_index);
+void tree_broad_phase_remove_proxy(TreeBroadPhase* tree, int body_index);
+void tree_broad_phase_permute(TreeBroadPhase* tree, const int* order, int* scratch);
+void tree_broad_phase_update(TreeBroadPhase* tree, const BodyPool* pool, float prediction_time, BroadPhase* out);
+
+// Spatial hash internals
+void spatial_hash_broad_phase_update(SpatialHash* grid, const BodyPool* pool, BroadPhase* out);
+
+#endif // BROAD_PHASE_H
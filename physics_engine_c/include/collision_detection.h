@@ -3,6 +3,7 @@
 
 #include "rigid_body.h"
 #include <stdbool.h>
+#include <stdint.h>
 
 // Collision information structure
 typedef struct {
@@ -14,9 +15,38 @@ typedef struct {
     RigidBody* body_b;
 } CollisionInfo;
 
+// Compact contact produced by a world's narrow phase. Bodies are body pool
+// indices, normal and depth pack into one 16-byte vector, and no contact
+// point is stored, so a record is 32 bytes and two share a cache line.
+typedef struct {
+    uint32_t index_a;
+    uint32_t index_b;
+    Vector3 normal;           // Normal pointing from body A to body B
+    float penetration_depth;  // Negative for a speculative contact: the gap still to close
+    float normal_impulse;     // Impulses applied by the last resolve
+    float tangent_impulse;
+} Contact;
+
+#define CONTACT_ALIGNMENT 64
+
 // Main collision detection function
 bool detect_collision(RigidBody* body_a, RigidBody* body_b, CollisionInfo* info);
 
+// Shape-level collision detection, shared by the RigidBody API and the world's
+// body pool. Fills the contact's normal and depth; the contact point is only
+// computed when contact_point is non-NULL.
+bool collide_shapes(ShapeType type_a, const CollisionShape* shape_a, Vector3 position_a,
+                    ShapeType type_b, const CollisionShape* shape_b, Vector3 position_b,
+                    Contact* contact, Vector3* contact_point);
+
+// Speculative variant for the world's narrow phase: shapes up to margin
+// apart are reported as well, with the gap as a negative penetration depth,
+// so the solver can stop them closing more than the gap in the next step.
+// The normal of a separated pair is the direction that gap is measured in.
+bool collide_shapes_speculative(ShapeType type_a, const CollisionShape* shape_a, Vector3 position_a,
+                                ShapeType type_b, const CollisionShape* shape_b, Vector3 position_b,
+                                float margin, Contact* contact);
+
 // Specific collision detection functions
 bool sphere_sphere_collision(RigidBody* sphere_a, RigidBody* sphere_b, CollisionInfo* info);
 bool sphere_aabb_collision(RigidBody* sphere, RigidBody* aabb, CollisionInfo* info);
@@ -24,6 +54,22 @@ bool aabb_aabb_collision(RigidBody* aabb_a, RigidBody* aabb_b, CollisionInfo* in
 bool sphere_plane_collision(RigidBody* sphere, RigidBody* plane, CollisionInfo* info);
 bool aabb_plane_collision(RigidBody* aabb, RigidBody* plane, CollisionInfo* info);
 
+// Continuous collision. Shape A moves from position_a by displacement while
+// shape B stays at position_b, and *toi receives the fraction of the move
+// at which they first touch. False if they don't touch during the move or
+// already touch at its start, which the discrete tests above handle.
+bool sweep_shapes(ShapeType type_a, const CollisionShape* shape_a, Vector3 position_a, Vector3 displacement,
+                  ShapeType type_b, const CollisionShape* shape_b, Vector3 position_b, float* toi);
+
+// Swept sphere tests used by sweep_shapes. A moving box sweeps like a sphere
+// of its support radius against a plane and, against boxes and spheres, like
+// a point or sphere against the box grown by its half extents.
+bool swept_sphere_plane(Vector3 center, float radius, Vector3 displacement, const PlaneShape* plane, float* toi);
+bool swept_sphere_sphere(Vector3 center, float radius, Vector3 displacement,
+                         Vector3 other_center, float other_radius, float* toi);
+bool swept_sphere_aabb(Vector3 center, float radius, Vector3 displacement,
+                       Vector3 aabb_center, Vector3 half_extents, float* toi);
+
 // Utility functions
 Vector3 closest_point_on_aabb(Vector3 point, RigidBody* aabb);
 float distance_to_plane(Vector3 point, RigidBody* plane);
@@ -33,5 +79,6 @@ bool point_in_aabb(Vector3 point, RigidBody* aabb);
 bool aabb_overlap_test(RigidBody* body_a, RigidBody* body_b);
 Vector3 get_aabb_min(RigidBody* body);
 Vector3 get_aabb_max(RigidBody* body);
+void shape_get_aabb(ShapeType type, const CollisionShape* shape, Vector3 position, Vector3* min, Vector3* max);
 
 #endif // COLLISION_DETECTION_H
\ No newline at end of file
@@ -3,6 +3,62 @@
 
 #include "collision_detection.h"
 
+// View of one side of a contact. Position and velocity point at wherever the
+// body's state lives (a RigidBody or a world's body pool), so the same
+// response code serves both.
+typedef struct {
+    Vector3* position;
+    Vector3* velocity;
+    float inverse_mass;
+    float restitution;
+    float friction;
+    bool is_static;
+} ContactBody;
+
+// Full single-pass response (separation, impulse, friction, correction)
+// between two views. Reads the contact's normal and depth and records the
+// impulses applied. Worlds use the iterative solver below instead.
+void resolve_contact(ContactBody* body_a, ContactBody* body_b, Contact* contact);
+ContactBody contact_body_from_rigid_body(RigidBody* body);
+
+// Below this approach speed contacts don't bounce, so resting bodies settle
+#define CONTACT_BOUNCE_THRESHOLD 0.5f
+
+// Positional correction applied once per contact after the velocity solve
+#define CONTACT_CORRECTION_PERCENTAGE 0.8f
+#define CONTACT_CORRECTION_SLOP 0.01f
+
+// Per-contact state of the iterative sequential-impulse solver. Impulses
+// are accumulated over the iterations and clamped as totals: the normal
+// impulse never pulls, and friction stays within the Coulomb cone.
+typedef struct {
+    float normal_mass;             // Effective mass along the normal, 1 / (inverse_mass_a + inverse_mass_b)
+    float target_velocity;         // Separating speed to reach: restitution's bounce, or minus gap / dt
+    float friction;                // Combined coefficient
+    float normal_impulse;          // Accumulated; starts from the warm-start guess
+    Vector3 tangent_impulse;       // Accumulated friction impulse on body B
+} ContactConstraint;
+
+// Set up a constraint from the bodies' velocities before any impulse of
+// this solve; leaves the accumulated impulses alone. dt is the time the
+// solved velocities will be integrated over: a speculative contact (negative
+// depth) lets the bodies approach by up to its gap in that time and only
+// removes the rest, so they meet without overshooting. A zero dt treats it
+// as touching.
+void contact_constraint_prepare(const ContactBody* body_a, const ContactBody* body_b, const Contact* contact,
+                                float dt, ContactConstraint* constraint);
+
+// Apply the accumulated impulses, e.g. last step's, in one go
+void contact_constraint_warm_start(ContactBody* body_a, ContactBody* body_b, const Contact* contact,
+                                   const ContactConstraint* constraint);
+
+// One solver iteration: update and clamp the normal, then the friction impulse
+void contact_constraint_solve(ContactBody* body_a, ContactBody* body_b, const Contact* contact,
+                              ContactConstraint* constraint);
+
+// Push the bodies apart along the normal to remove most of the penetration
+void contact_correct_position(ContactBody* body_a, ContactBody* body_b, const Contact* contact);
+
 // Collision response functions
 void resolve_collision(CollisionInfo* collision);
 void separate_bodies(CollisionInfo* collision);
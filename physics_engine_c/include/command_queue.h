@@ -0,0 +1,59 @@
+#ifndef COMMAND_QUEUE_H
+#define COMMAND_QUEUE_H
+
+#include "rigid_body.h"
+#include "handle_table.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+// Deferred body mutations, applied by the world at the start of a step
+typedef enum {
+    BODY_COMMAND_DESPAWN,
+    BODY_COMMAND_SPAWN,
+    BODY_COMMAND_TELEPORT,
+    BODY_COMMAND_IMPULSE,
+    BODY_COMMAND_FORCE,
+    BODY_COMMAND_TYPE_COUNT
+} BodyCommandType;
+
+typedef struct {
+    BodyCommandType type;
+    BodyHandle handle;         // Target of every command but spawn
+    RigidBody* body;           // Body to add, for spawn
+    Vector3 value;             // Force, impulse or new position
+} BodyCommand;
+
+// Queue slot; the sequence number says whether a producer or the consumer
+// owns it for the current lap around the ring
+typedef struct {
+    size_t sequence;
+    BodyCommand command;
+} CommandCell;
+
+#define COMMAND_QUEUE_CACHE_LINE 64
+
+// Bounded lock-free multi-producer, single-consumer ring. Producers claim a
+// cell by advancing the enqueue position with compare-and-swap and publish
+// it by bumping the cell's sequence; no producer ever waits on another's lock.
+typedef struct {
+    CommandCell* cells;        // Allocated by the first push
+    size_t mask;               // Capacity - 1; capacity is a power of two
+    char pad_cells[COMMAND_QUEUE_CACHE_LINE];
+    size_t enqueue_pos;        // Shared by producers
+    char pad_enqueue[COMMAND_QUEUE_CACHE_LINE];
+    size_t dequeue_pos;        // Consumer only
+} CommandQueue;
+
+// Queue lifetime; capacity is rounded up to a power of two
+bool command_queue_init(CommandQueue* queue, int capacity);
+void command_queue_destroy(CommandQueue* queue);
+int command_queue_get_capacity(const CommandQueue* queue);
+
+// Any thread; returns false if the queue is full or its cells could not be
+// allocated
+bool command_queue_push(CommandQueue* queue, const BodyCommand* command);
+
+// Consumer thread only; returns false if no published command is waiting
+bool command_queue_pop(CommandQueue* queue, BodyCommand* command);
+
+#endif // COMMAND_QUEUE_H
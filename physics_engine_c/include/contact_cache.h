@@ -0,0 +1,72 @@
+#ifndef CONTACT_CACHE_H
+#define CONTACT_CACHE_H
+
+#include "vector_math.h"
+#include "handle_table.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#define CONTACT_CACHE_EMPTY UINT64_MAX
+
+// Body pair identity: both handle slots, plus their generations so a pair
+// involving a removed body never matches a body that reuses its slot
+typedef struct {
+    uint64_t slots;                // CONTACT_CACHE_EMPTY for unused entries
+    uint64_t generations;
+} ContactCacheKey;
+
+// Impulses a body pair ended a solve with, for warm starting the next one
+typedef struct {
+    ContactCacheKey key;           // See contact_cache_key
+    float normal_impulse;
+    Vector3 tangent_impulse;       // Friction impulse on the higher-slot body
+} ContactCacheEntry;
+
+// Open-addressing table with linear probing; capacity is a power of two
+typedef struct {
+    ContactCacheEntry* entries;
+    int capacity;
+    int count;
+} ContactCacheTable;
+
+// Persistent contacts across steps. A solve reads the previous table and
+// writes a fresh one, then the two swap, so a pair that stops touching is
+// forgotten after one step and the cache never needs pruning.
+typedef struct {
+    ContactCacheTable tables[2];
+    int previous;                  // Table read by contact_cache_find
+} ContactCache;
+
+// Order-independent key of two bodies, from their world handles. Returns
+// whether the pair is stored the other way round, in which case tangent
+// impulses flip sign on the way in and out.
+static inline ContactCacheKey contact_cache_key(BodyHandle a, BodyHandle b, bool* swapped) {
+    *swapped = a.slot > b.slot;
+    if (*swapped) {
+        BodyHandle t = a;
+        a = b;
+        b = t;
+    }
+    ContactCacheKey key = { ((uint64_t)a.slot << 32) | b.slot, ((uint64_t)a.generation << 32) | b.generation };
+    return key;
+}
+
+// Cache lifetime
+void contact_cache_init(ContactCache* cache);
+void contact_cache_destroy(ContactCache* cache);
+void contact_cache_clear(ContactCache* cache);
+
+// Start writing a table for up to contact_count pairs; false if it could
+// not grow, in which case stores are dropped and the next solve starts cold
+bool contact_cache_begin(ContactCache* cache, int contact_count);
+
+// Previous solve's entry for a key, or NULL
+const ContactCacheEntry* contact_cache_find(const ContactCache* cache, ContactCacheKey key);
+
+// Record a pair's impulses in the table being written
+void contact_cache_store(ContactCache* cache, ContactCacheKey key, float normal_impulse, Vector3 tangent_impulse);
+
+// Make the written table the one read by the next solve
+void contact_cache_end(ContactCache* cache);
+
+#endif // CONTACT_CACHE_H
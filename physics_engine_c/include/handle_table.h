@@ -0,0 +1,79 @@
+#ifndef HANDLE_TABLE_H
+#define HANDLE_TABLE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define BODY_HANDLE_NULL_SLOT 0xFFFFFFFFu
+
+// Stable reference to a body in a world. The slot locates the body through
+// the world's handle table; the generation catches handles to removed bodies.
+typedef struct {
+    uint32_t slot;
+    uint32_t generation;
+} BodyHandle;
+
+// Sparse-to-dense map between handle slots and body indices. Freed slots
+// are reused through a free list, and each reuse bumps the slot's generation.
+typedef struct {
+    int* dense;                // Slot -> body index, or next free slot while unused
+    uint32_t* generations;     // Slot -> current generation
+    int slot_count;
+    int slot_capacity;
+    int free_head;
+
+    int* slots;                // Body index -> slot, parallel to the body pool
+    int body_count;
+    int body_capacity;
+} HandleTable;
+
+// Map from RigidBody ids to handle slots, open addressing with linear probing
+typedef struct {
+    int* keys;
+    int* values;
+    int capacity;              // Power of two
+    int count;
+    int used;                  // Live keys plus tombstones
+} BodyIdMap;
+
+static inline BodyHandle body_handle_null(void) {
+    BodyHandle handle = { BODY_HANDLE_NULL_SLOT, 0 };
+    return handle;
+}
+
+static inline bool body_handle_is_null(BodyHandle handle) {
+    return handle.slot == BODY_HANDLE_NULL_SLOT;
+}
+
+// Handle table lifetime
+void handle_table_init(HandleTable* table);
+void handle_table_destroy(HandleTable* table);
+void handle_table_clear(HandleTable* table);
+bool handle_table_reserve(HandleTable* table, int body_capacity);
+
+// Append a body at the next body index and return its handle; reserve first
+BodyHandle handle_table_insert(HandleTable* table);
+
+// Remove the body at body_index; the last body moves into its index
+void handle_table_remove(HandleTable* table, int body_index);
+
+// Reorder body indices so new index i is old index order[i]. Handles keep
+// resolving to the same bodies. Scratch must hold body_count ints.
+void handle_table_permute(HandleTable* table, const int* order, int* scratch);
+
+// Lookups in O(1); a stale or null handle yields -1
+int handle_table_lookup(const HandleTable* table, BodyHandle handle);
+BodyHandle handle_table_get_handle(const HandleTable* table, int body_index);
+
+// Id map lifetime
+void body_id_map_init(BodyIdMap* map);
+void body_id_map_destroy(BodyIdMap* map);
+void body_id_map_clear(BodyIdMap* map);
+bool body_id_map_reserve(BodyIdMap* map, int count);
+
+// Insert or overwrite an id; returns false only if the map could not grow
+bool body_id_map_insert(BodyIdMap* map, int id, int slot);
+int body_id_map_find(const BodyIdMap* map, int id);
+void body_id_map_remove(BodyIdMap* map, int id);
+
+#endif // HANDLE_TABLE_H
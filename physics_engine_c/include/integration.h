@@ -2,6 +2,7 @@
 #define INTEGRATION_H
 
 #include "rigid_body.h"
+#include "body_pool.h"
 
 // Integration methods
 typedef enum {
@@ -22,4 +23,10 @@ void integrate_body(RigidBody* body, float dt, IntegrationMethod method);
 void update_acceleration(RigidBody* body);
 void apply_damping(RigidBody* body, float linear_damping, float angular_damping);
 
+// Body pool variants over a list of slots, such as the world's awake bodies;
+// every listed body is processed, whatever its flags
+void integrate_pool_list(BodyPool* pool, const int* indices, int count, float dt, IntegrationMethod method);
+void apply_damping_pool_list(BodyPool* pool, const int* indices, int count, float linear_damping,
+                             float angular_damping);
+
 #endif // INTEGRATION_H
\ No newline at end of file
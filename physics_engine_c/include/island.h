@@ -0,0 +1,55 @@
+#ifndef ISLAND_H
+#define ISLAND_H
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+// Union-find over body pool slots, rebuilt every step from the contact
+// list. Bodies joined by contacts, directly or through other dynamic
+// bodies, form an island that sleeps and wakes as one.
+typedef struct {
+    int* parent;                   // Slot -> parent slot; roots point at themselves
+    float* rest_time;              // Root -> least time at rest of the island's bodies
+    uint32_t* sleep_id;            // Root -> id given to the island when it falls asleep
+    int capacity;
+} IslandSet;
+
+// Set lifetime
+void island_set_init(IslandSet* islands);
+void island_set_destroy(IslandSet* islands);
+
+// Make room for slots [0, capacity); false if the set could not grow
+bool island_set_reserve(IslandSet* islands, int capacity);
+
+// Start a slot off as an island of its own. Slots not added since the set
+// was last used hold stale links and must not be passed to find or union.
+static inline void island_set_add(IslandSet* islands, int index) {
+    islands->parent[index] = index;
+    islands->rest_time[index] = INFINITY;
+    islands->sleep_id[index] = 0;
+}
+
+// Root of a slot's island, halving the path on the way
+static inline int island_set_find(IslandSet* islands, int index) {
+    int* parent = islands->parent;
+    while (parent[index] != index) {
+        parent[index] = parent[parent[index]];
+        index = parent[index];
+    }
+    return index;
+}
+
+// Join two islands. The lower root wins, so the result depends only on
+// the order of the unions, not on memory layout.
+static inline void island_set_union(IslandSet* islands, int index_a, int index_b) {
+    int root_a = island_set_find(islands, index_a);
+    int root_b = island_set_find(islands, index_b);
+    if (root_a < root_b) {
+        islands->parent[root_b] = root_a;
+    } else if (root_b < root_a) {
+        islands->parent[root_a] = root_b;
+    }
+}
+
+#endif // ISLAND_H
@@ -0,0 +1,53 @@
+#ifndef JOB_SYSTEM_H
+#define JOB_SYSTEM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Work on items [begin, end) of a parallel-for. Ranges never overlap, so a
+// function may write to its own items without synchronisation.
+typedef void (*JobRangeFunc)(void* context, int begin, int end);
+
+// Hook for running the engine's parallel-fors on a host's own task system.
+// parallel_for must call func over every item of [0, count) exactly once,
+// in ranges of about `grain` items, and return only when all have finished.
+typedef struct {
+    void (*parallel_for)(void* user_data, int count, int grain, JobRangeFunc func, void* context);
+    void* user_data;
+} JobScheduler;
+
+// Pool of worker threads with work-stealing parallel-for. Each participant
+// starts with an equal share of the items and takes `grain` items at a time
+// from the front of its share; idle participants steal the back half of
+// another's remaining share.
+typedef struct JobSystem JobSystem;
+
+// thread_count includes the calling thread, which always takes part.
+// Returns NULL if threads could not be started.
+JobSystem* job_system_create(int thread_count);
+void job_system_destroy(JobSystem* jobs);
+int job_system_get_thread_count(const JobSystem* jobs);
+
+// Run func over [0, count). A NULL job system, a single thread or a count
+// within one grain runs func inline on the calling thread.
+void job_system_parallel_for(JobSystem* jobs, int count, int grain, JobRangeFunc func, void* context);
+
+// Dedicated thread that runs one submitted function at a time, for work that
+// should overlap the caller, such as a whole world step. Every submission
+// gets a ticket; tickets complete in submission order.
+typedef struct JobTask JobTask;
+
+JobTask* job_task_create(void);
+
+// Waits for a running function before stopping the thread
+void job_task_destroy(JobTask* task);
+
+// Run func(context) on the task thread, waiting first for the previous
+// submission. Returns the submission's ticket, or 0 if task is NULL.
+uint64_t job_task_submit(JobTask* task, void (*func)(void* context), void* context);
+
+// Ticket 0 and NULL tasks count as complete
+bool job_task_is_complete(JobTask* task, uint64_t ticket);
+void job_task_wait(JobTask* task, uint64_t ticket);
+
+#endif // JOB_SYSTEM_H
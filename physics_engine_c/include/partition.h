@@ -0,0 +1,114 @@
+#ifndef PARTITION_H
+#define PARTITION_H
+
+#include "physics_world.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// Spatial domain decomposition. Space is cut along x into slabs, one per
+// partition; each partition is an ordinary PhysicsWorld holding the bodies
+// it owns, run by its own process or thread (group). Before every step,
+// neighbouring partitions exchange border records through a shared-memory
+// ring per direction:
+//  - bodies that left a partition's slab migrate to the neighbour, which
+//    takes ownership and keeps their id;
+//  - bodies within ghost_width of a border are sent as ghosts, static
+//    read-only copies that the neighbour's bodies collide against. A ghost
+//    is updated in place every step it is sent and removed once it stops
+//    arriving. A contact across a border therefore only pushes the body on
+//    the side doing the resolving.
+// Static bodies (ground planes, walls) are local to each partition and
+// never exchanged.
+
+#define PARTITION_CACHE_LINE 64
+
+typedef enum {
+    BORDER_RECORD_MIGRATE,
+    BORDER_RECORD_GHOST,
+    BORDER_RECORD_END_OF_STEP      // Sender has written all records for a step
+} BorderRecordType;
+
+typedef struct {
+    BorderRecordType type;
+    uint32_t step;
+    RigidBody body;                // Full body state; the id is the global id
+} BorderRecord;
+
+// Per-partition counters in shared memory, written only by the owning
+// partition and readable by every process once the steps are done
+typedef struct {
+    int owned_bodies;
+    int ghosts_sent;
+    int ghosts_received;
+    int migrated_out;
+    int migrated_in;
+    uint32_t steps;
+} PartitionStats;
+
+// Shared state of one decomposition: the slab layout, the rings and the
+// stats. Create it before forking or starting threads; every participant
+// sees the same mapping.
+typedef struct PartitionDomain PartitionDomain;
+
+// Slabs split [min_x, max_x) evenly; the outer slabs extend to infinity.
+// Each ring holds ring_capacity records. Returns NULL on failure.
+PartitionDomain* partition_domain_create(int partition_count, float min_x, float max_x, float ghost_width,
+                                         int ring_capacity);
+
+// Unmap the domain in the calling process; each process that used it
+// calls this once when done
+void partition_domain_destroy(PartitionDomain* domain);
+
+int partition_domain_get_count(const PartitionDomain* domain);
+int partition_domain_find(const PartitionDomain* domain, float x);
+PartitionStats partition_domain_get_stats(const PartitionDomain* domain, int index);
+
+// A ghost in a partition's world, found by the id of the body it copies
+typedef struct {
+    int id;
+    BodyHandle handle;
+    uint32_t step;                 // Last step a record refreshed it
+} PartitionGhost;
+
+// One participant of a domain
+typedef struct {
+    PartitionDomain* domain;
+    int index;
+    PhysicsWorld* world;           // Owned bodies plus the current ghosts
+    float min_x;                   // Owned slab [min_x, max_x)
+    float max_x;
+    float ghost_width;
+
+    // Ghost bodies, sorted by id. They stay in the world across steps so
+    // bodies resting against them can sleep.
+    PartitionGhost* ghosts;
+    int ghost_count;
+    int ghost_capacity;
+
+    // Records received before being applied
+    BorderRecord* inbox;
+    int inbox_count;
+    int inbox_capacity;
+
+    int next_local_id;             // Source of globally unique ids
+    uint32_t step;
+} Partition;
+
+// Partition lifetime; the partition creates and owns its world
+bool partition_init(Partition* partition, PartitionDomain* domain, int index);
+void partition_release(Partition* partition);
+
+// Add a dynamic body owned by this partition and give it an id unique
+// across the domain (negative, so it can't clash with rigid_body_init ids).
+// Returns the id, or 0 on failure. Bodies outside the slab migrate on the
+// next step. Static bodies should be added to partition->world directly.
+int partition_add_body(Partition* partition, RigidBody* body);
+
+// Exchange borders with the neighbours, then step the world. Every
+// partition of the domain must call this once per step; it waits for the
+// neighbours' records for the same step.
+void partition_step(Partition* partition);
+
+int partition_get_owned_count(const Partition* partition);
+
+#endif // PARTITION_H
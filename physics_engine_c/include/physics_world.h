@@ -5,20 +5,161 @@
 #include "collision_detection.h"
 #include "collision_response.h"
 #include "integration.h"
+#include "broad_phase.h"
+#include "body_pool.h"
+#include "handle_table.h"
+#include "body_slab.h"
+#include "allocator.h"
+#include "job_system.h"
+#include "body_state.h"
+#include "command_queue.h"
+#include "contact_cache.h"
+#include "island.h"
 
-// Maximum number of bodies and collisions
-#define MAX_BODIES 1000
-#define MAX_COLLISIONS 2000
+// Bodies per parallel-for range in the per-body phases
+#define PHYSICS_WORLD_BODY_GRAIN 256
+
+// Narrow-phase work per contact block: candidate pairs, or rows of the
+// brute-force pair triangle
+#define PHYSICS_WORLD_PAIR_BLOCK 256
+#define PHYSICS_WORLD_ROW_BLOCK  16
+
+// Parallel contact resolution: colour batches per step (one bit each in a
+// body's mask) and contacts per parallel-for range within a batch
+#define PHYSICS_WORLD_CONTACT_BATCHES 64
+#define PHYSICS_WORLD_CONTACT_GRAIN   64
+
+// Velocity iterations of the contact solver per substep
+#define PHYSICS_WORLD_SOLVER_ITERATIONS 8
+
+// Island sleeping: a body is at rest below this speed (linear and angular),
+// and an island sleeps once all its bodies have rested this many seconds
+#define PHYSICS_WORLD_SLEEP_SPEED 0.1f
+#define PHYSICS_WORLD_SLEEP_TIME  0.5f
+
+// Sleeping bodies whose bounds come within this distance of a removed body
+// wake, so nothing is left resting on thin air
+#define PHYSICS_WORLD_REMOVAL_WAKE_MARGIN 0.05f
+
+// Adaptive substepping: a body may travel this fraction of its smallest
+// half extent per substep, and contacts should penetrate no deeper than this
+#define PHYSICS_WORLD_SUBSTEP_TRAVEL      0.5f
+#define PHYSICS_WORLD_SUBSTEP_PENETRATION 0.05f
+#define PHYSICS_WORLD_MAX_SUBSTEPS        8
+
+// Bodies stopped by continuous collision are left this far into what they
+// hit, within the solver's slop, so the next detection reports the contact
+#define PHYSICS_WORLD_SWEEP_DEPTH (CONTACT_CORRECTION_SLOP * 0.5f)
+
+// Commands the world's command queue holds before producers see it full
+#define PHYSICS_WORLD_COMMAND_CAPACITY 4096
+
+// Commands of one type drained from the queue, in push order
+typedef struct {
+    BodyCommand* commands;
+    int count;
+    int capacity;
+} CommandBatch;
+
+// What the last step did
+typedef struct {
+    int substeps;                  // Substeps run; 0 when every body was asleep
+    float max_speed_ratio;         // Largest body speed over its smallest half extent at the start (1/s)
+    float max_penetration;         // Deepest contact found in any substep
+    int swept_impacts;             // Fast bodies stopped at a time of impact
+    int speculative_contacts;      // Contacts found before their bodies touched, over all substeps
+} PhysicsStepStats;
+
+// Shape and place of a body removed since the last load
+typedef struct {
+    ShapeType shape_type;
+    CollisionShape shape;
+    Vector3 position;
+} RemovedBody;
+
+// Start of a substep's move for a body that continuous collision sweeps
+typedef struct {
+    int index;
+    Vector3 start;
+    bool stopped;              // Moved back to a time of impact this substep
+} SweptBody;
+
+// Completion marker for an asynchronous step; 0 is always complete
+typedef uint64_t PhysicsFence;
+
+// Static half-spaces kept outside the broad phase. Plane data is stored
+// as separate arrays so the per-body test loop vectorizes.
+typedef struct {
+    int* indices;                  // Body pool slots of the planes
+    float* normal_x;
+    float* normal_y;
+    float* normal_z;
+    float* distance;
+    int count;
+    int capacity;
+} PlaneList;
+
+// Contacts found by one fixed block of narrow-phase work. Blocks are
+// filled in parallel and concatenated in block order.
+typedef struct {
+    Contact* contacts;
+    int count;
+    int capacity;
+    int checks;                    // Pair tests performed
+    float* plane_separation;       // Per-body scratch for the plane pass
+    int plane_capacity;
+} ContactBlock;
+
+// Contacts grouped by greedy graph colouring so no two contacts in a batch
+// touch the same dynamic body. Batch k holds order[batch_start[k]] up to
+// order[batch_start[k + 1]]; the last batch collects contacts that found
+// no free colour and is resolved serially.
+typedef struct {
+    int* order;                    // Contact indices by batch, then per-contact scratch
+    int order_capacity;
+    uint64_t* body_colors;         // Per-body mask of batches already used
+    int body_capacity;
+    int batch_start[PHYSICS_WORLD_CONTACT_BATCHES + 2];
+} ContactBatches;
 
 // Physics world structure
 typedef struct {
-    // Bodies management
-    RigidBody* bodies[MAX_BODIES];
+    // Bodies management. The simulation runs on the pool; bodies[i] is the
+    // user-facing RigidBody for pool slot i, synchronised at step boundaries.
+    BodyPool pool;
+    RigidBody** bodies;
     int body_count;
+    int body_capacity;
+    
+    // Handle slot <-> body index and id -> handle slot lookups
+    HandleTable handles;
+    BodyIdMap body_ids;
+    
+    // Storage for bodies created through the world
+    BodySlab body_slab;
+    
+    // Contacts from this frame in cache-line-aligned storage; grows as needed
+    // so no contact is dropped
+    Contact* contacts;
+    int contact_count;
+    int contact_capacity;
+    ContactBlock* contact_blocks;
+    int contact_block_capacity;
+    ContactBatches contact_batches;
     
-    // Collision pairs from this frame
-    CollisionInfo collisions[MAX_COLLISIONS];
-    int collision_count;
+    // Iterative solver state, parallel to contacts, and the impulses of the
+    // previous solve keyed by body pair for warm starting
+    ContactConstraint* constraints;
+    int constraint_capacity;
+    ContactCache contact_cache;
+    int solver_iterations;
+    bool warm_starting;
+    
+    // Broad phase pair generation
+    BroadPhase broad_phase;
+    
+    // Infinite planes, tested against every body without the broad phase
+    PlaneList planes;
     
     // World properties
     Vector3 gravity;
@@ -29,11 +170,109 @@ typedef struct {
     float linear_damping;
     float angular_damping;
     
+    // Islands of bodies joined by contacts sleep together once all of them
+    // have rested for sleep_time seconds (<= 0 never sleeps). A sleeping
+    // island wakes when a contact or the user touches one of its bodies;
+    // the ids of islands to wake wait in waking_islands for the next wake pass.
+    IslandSet islands;
+    float sleep_time;
+    uint32_t next_island_id;
+    uint32_t* waking_islands;
+    int waking_count;
+    int waking_capacity;
+    
+    // Bodies removed since the last load. The load wakes sleeping bodies
+    // that touched them, static ones included, which have no island.
+    RemovedBody* removed_bodies;
+    int removed_count;
+    int removed_capacity;
+    
+    // Pool indices of the awake dynamic bodies in ascending order; the
+    // per-body phases visit only these. Falling asleep removes bodies and
+    // adding one appends it; waking, removal, reordering and RigidBody flag
+    // edits set active_dirty, and the list is rebuilt from the flags before
+    // it is next used.
+    int* active_bodies;
+    int active_count;
+    int active_capacity;
+    bool active_dirty;
+    
+    // By default every load reads every RigidBody, so direct edits to static
+    // and sleeping bodies are always seen. With tracked_edits the caller
+    // promises to mark such edits, and loads visit only the active bodies
+    // and dirty_bodies, the static and sleeping ones marked since the last load.
+    bool tracked_edits;
+    BodyHandle* dirty_bodies;
+    int dirty_count;
+    int dirty_capacity;
+    
+    // Radius of physics_world_wake_sleeping_bodies
+    float wake_distance;
+    
     // Simulation control
     bool is_paused;
     float time_scale;
     int simulation_iterations;
     
+    // With adaptive substeps each step picks its substep count between
+    // min_substeps and max_substeps from body speeds and the last step's
+    // penetration, instead of using simulation_iterations
+    bool adaptive_substeps;
+    int min_substeps;
+    int max_substeps;
+    PhysicsStepStats step_stats;
+    PhysicsStepStats last_simulated;   // Stats of the last step that ran any substeps
+    
+    // Continuous collision: bodies that may cross more than
+    // PHYSICS_WORLD_SUBSTEP_TRAVEL of their smallest half extent in one
+    // substep are swept along their move and stopped at the first impact.
+    // Off by default.
+    bool continuous_collision;
+    SweptBody* swept_bodies;
+    int swept_count;
+    int swept_capacity;
+    
+    // Speculative contacts: pairs whose gap may close within a substep,
+    // given their velocities, are reported with the gap as a negative depth
+    // and the solver lets them approach by no more than the gap. speculative_time
+    // is the substep the last detection looked ahead over, 0 when disabled.
+    bool speculative_contacts;
+    float speculative_time;
+    
+    // Per-body phases run as parallel-fors on the external scheduler when
+    // one is set, otherwise on the world's own job system (NULL = serial)
+    JobSystem* job_system;
+    JobScheduler scheduler;
+    
+    // Bit-identical results for any thread count, at the cost of sorting
+    // broad phase pairs and always resolving contacts in coloured batches
+    bool deterministic;
+    
+    // Per-block partial sums for the fixed-order reductions
+    float* reduction_partials;
+    int reduction_capacity;
+    
+    // Deferred mutations pushed from any thread, drained and applied by type
+    // at the start of each step
+    CommandQueue commands;
+    CommandBatch command_batches[BODY_COMMAND_TYPE_COUNT];
+    
+    // Asynchronous stepping. Steps submitted with physics_world_step_async run
+    // on step_task; each finished step publishes a snapshot to body_states.
+    JobTask* step_task;
+    BodyStateBuffers* body_states;
+    PhysicsFence step_fence;       // Latest submitted step
+    float async_dt;
+    uint64_t step_count;
+    
+    // Next id given to added bodies when the world has its own id space;
+    // 0 keeps the process-wide ids from rigid_body_init
+    int next_local_id;
+    
+    // Body storage is re-sorted along a Morton curve every this many steps (0 = never)
+    int reorder_interval;
+    int steps_since_reorder;
+    
     // Performance tracking
     float last_frame_time;
     int collision_checks_performed;
@@ -44,17 +283,76 @@ PhysicsWorld* physics_world_create(void);
 void physics_world_destroy(PhysicsWorld* world);
 void physics_world_init(PhysicsWorld* world);
 
-// Body management
+// Free everything a world set up with physics_world_init owns, including
+// its bodies, but not the PhysicsWorld itself
+void physics_world_release(PhysicsWorld* world);
+
+bool physics_world_reserve(PhysicsWorld* world, int body_capacity, int contact_capacity);
+
+// Pooled body allocation. Created bodies are initialised to defaults and are
+// freed by physics_world_destroy_body, physics_world_clear_bodies or when the
+// world is destroyed. physics_world_destroy_body also accepts bodies from
+// rigid_body_create.
+RigidBody* physics_world_create_body(PhysicsWorld* world);
+void physics_world_destroy_body(PhysicsWorld* world, RigidBody* body);
+
+// Body management by handle. Lookup and removal are O(1); removal moves
+// the world's last body into the freed index, so body order is not kept.
+BodyHandle physics_world_add_body_handle(PhysicsWorld* world, RigidBody* body);
+bool physics_world_remove_body_by_handle(PhysicsWorld* world, BodyHandle handle);
+RigidBody* physics_world_get_body_by_handle(PhysicsWorld* world, BodyHandle handle);
+bool physics_world_is_handle_valid(PhysicsWorld* world, BodyHandle handle);
+BodyHandle physics_world_get_body_handle(PhysicsWorld* world, int body_id);
+
+// Body management by id (wrappers over the handle functions)
 int physics_world_add_body(PhysicsWorld* world, RigidBody* body);
 bool physics_world_remove_body(PhysicsWorld* world, int body_id);
 RigidBody* physics_world_get_body(PhysicsWorld* world, int body_id);
 void physics_world_clear_bodies(PhysicsWorld* world);
 
+// RigidBody <-> pool synchronisation. physics_world_step does this itself;
+// call these around the individual phase functions when driving them by hand.
+// Loads pick up edits made through any RigidBody struct. With tracked
+// edits enabled they read only awake bodies' structs, so a static or
+// sleeping body edited directly (moved, woken, made dynamic) must be marked
+// dirty for its next load to see it; commands mark their bodies themselves.
+// This makes a step's cost independent of how many bodies rest.
+void physics_world_load_bodies(PhysicsWorld* world);
+void physics_world_store_bodies(PhysicsWorld* world);
+void physics_world_set_tracked_edits(PhysicsWorld* world, bool enabled);
+bool physics_world_mark_body_dirty(PhysicsWorld* world, BodyHandle handle);
+
 // World properties
 void physics_world_set_gravity(PhysicsWorld* world, Vector3 gravity);
 void physics_world_set_timestep(PhysicsWorld* world, float timestep);
+void physics_world_set_simulation_iterations(PhysicsWorld* world, int iterations);
+void physics_world_set_continuous_collision(PhysicsWorld* world, bool enabled);
+void physics_world_set_speculative_contacts(PhysicsWorld* world, bool enabled);
+bool physics_world_set_adaptive_substeps(PhysicsWorld* world, bool enabled, int min_substeps, int max_substeps);
 void physics_world_set_integration_method(PhysicsWorld* world, IntegrationMethod method);
+void physics_world_set_solver_iterations(PhysicsWorld* world, int iterations);
+void physics_world_set_warm_starting(PhysicsWorld* world, bool enabled);
 void physics_world_set_damping(PhysicsWorld* world, float linear_damping, float angular_damping);
+bool physics_world_set_broad_phase(PhysicsWorld* world, BroadPhaseType type);
+void physics_world_set_spatial_hash_cell_size(PhysicsWorld* world, float cell_size);
+void physics_world_set_sleep_time(PhysicsWorld* world, float seconds);
+void physics_world_set_wake_distance(PhysicsWorld* world, float wake_distance);
+void physics_world_set_reorder_interval(PhysicsWorld* world, int steps);
+
+// Give the world its own id space: every body added from now on is
+// renumbered 1, 2, 3, ... in the order added. Only allowed while empty.
+bool physics_world_set_local_ids(PhysicsWorld* world, bool enabled);
+
+// Threading. thread_count counts the stepping thread; 1 steps serially.
+// An external scheduler, if set, takes precedence over the world's threads.
+bool physics_world_set_thread_count(PhysicsWorld* world, int thread_count);
+int physics_world_get_thread_count(PhysicsWorld* world);
+void physics_world_set_scheduler(PhysicsWorld* world, const JobScheduler* scheduler);
+
+// Deterministic mode: state after every step is bit-identical from run to
+// run and independent of thread count or scheduler
+void physics_world_set_deterministic(PhysicsWorld* world, bool deterministic);
+bool physics_world_is_deterministic(PhysicsWorld* world);
 
 // Simulation control
 void physics_world_step(PhysicsWorld* world);
@@ -62,18 +360,67 @@ void physics_world_step_with_dt(PhysicsWorld* world, float dt);
 void physics_world_pause(PhysicsWorld* world, bool paused);
 void physics_world_set_time_scale(PhysicsWorld* world, float scale);
 
+// Command queue. These may be called from any thread, including while an
+// async step runs, and never block; they return false if the queue is full.
+// Commands take effect at the start of the next step, or when
+// physics_world_apply_commands is called, grouped by type: despawns, then
+// spawns, teleports, impulses and forces, each in push order.
+// Spawn hands a body from rigid_body_create to the world; look it up by id
+// afterwards. Despawn removes and frees the body as physics_world_destroy_body
+// does. Teleport, impulse and force wake the body and are ignored for stale
+// handles.
+bool physics_world_queue_spawn(PhysicsWorld* world, RigidBody* body);
+bool physics_world_queue_despawn(PhysicsWorld* world, BodyHandle handle);
+bool physics_world_queue_teleport(PhysicsWorld* world, BodyHandle handle, Vector3 position);
+bool physics_world_queue_impulse(PhysicsWorld* world, BodyHandle handle, Vector3 impulse);
+bool physics_world_queue_force(PhysicsWorld* world, BodyHandle handle, Vector3 force);
+void physics_world_apply_commands(PhysicsWorld* world);
+
+// Replace the command queue; pending commands are applied first. Only call
+// while no other thread is pushing.
+bool physics_world_set_command_capacity(PhysicsWorld* world, int capacity);
+
+// Asynchronous stepping. The step runs on a background thread and the fence
+// completes when it has finished. Until then the caller must not touch the
+// world or its bodies, other than through the functions below; a synchronous
+// step or another async step first waits for the running one.
+PhysicsFence physics_world_step_async(PhysicsWorld* world);
+PhysicsFence physics_world_step_async_with_dt(PhysicsWorld* world, float dt);
+bool physics_world_is_step_complete(PhysicsWorld* world, PhysicsFence fence);
+void physics_world_wait(PhysicsWorld* world, PhysicsFence fence);
+
+// Body state as of the last completed step, safe to read while the next
+// step runs. Once async stepping has started, every step publishes a new
+// snapshot. A snapshot may stay acquired while one more step publishes, but
+// the publish after that waits for its release, so release snapshots before
+// waiting for or submitting further steps. Returns NULL before the first
+// async step.
+const BodyStateSnapshot* physics_world_acquire_state(PhysicsWorld* world);
+void physics_world_release_state(PhysicsWorld* world, const BodyStateSnapshot* snapshot);
+
 // Collision detection and response
 void physics_world_detect_collisions(PhysicsWorld* world);
+void physics_world_detect_plane_collisions(PhysicsWorld* world);
 void physics_world_resolve_collisions(PhysicsWorld* world);
 
 // Utility functions
 void physics_world_apply_forces(PhysicsWorld* world);
 void physics_world_integrate_bodies(PhysicsWorld* world, float dt);
+
+// Wake sleeping bodies within wake_distance of a moving body. Steps don't
+// call this; islands wake through contacts. Call it to wake by proximity.
 void physics_world_wake_sleeping_bodies(PhysicsWorld* world);
 
+// Sort body storage by the Morton code of each body's position so bodies
+// close in space are close in memory. Handles and ids stay valid; body
+// indices and the order of world->bodies change.
+bool physics_world_reorder_bodies(PhysicsWorld* world);
+
 // Debug and statistics
 int physics_world_get_body_count(PhysicsWorld* world);
 int physics_world_get_collision_count(PhysicsWorld* world);
+const Contact* physics_world_get_contact(PhysicsWorld* world, int index);
 float physics_world_get_total_kinetic_energy(PhysicsWorld* world);
+PhysicsStepStats physics_world_get_step_stats(PhysicsWorld* world);
 
 #endif // PHYSICS_WORLD_H
\ No newline at end of file
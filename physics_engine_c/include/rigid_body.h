@@ -72,6 +72,9 @@ typedef struct {
 RigidBody* rigid_body_create(void);
 void rigid_body_destroy(RigidBody* body);
 
+// Reset a body to defaults and give it a fresh id (for caller-owned storage)
+void rigid_body_init(RigidBody* body);
+
 // Initialization functions
 void rigid_body_init_sphere(RigidBody* body, Vector3 position, float radius, float mass);
 void rigid_body_init_aabb(RigidBody* body, Vector3 position, Vector3 half_extents, float mass);
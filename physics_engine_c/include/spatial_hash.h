@@ -0,0 +1,76 @@
+#ifndef SPATIAL_HASH_H
+#define SPATIAL_HASH_H
+
+#include "body_pool.h"
+#include <stdbool.h>
+
+// Hashed entry of a body binned by the cell containing its position
+typedef struct {
+    int body_index;
+    int cell_x;
+    int cell_y;
+    int cell_z;
+} SpatialHashEntry;
+
+// Uniform grid over body positions, stored as a hash table so memory
+// scales with the number of bodies rather than the extent of the world.
+// Bodies larger than a cell are kept in a separate oversized list; planes
+// are left out entirely.
+typedef struct {
+    float cell_size;           // Requested cell size, 0 to derive it from body sizes
+    float active_cell_size;    // Cell size used by the last build
+    float inverse_cell_size;
+
+    // Entries grouped by bucket; bucket b spans [bucket_starts[b], bucket_starts[b + 1])
+    SpatialHashEntry* entries;
+    int entry_count;
+    int entry_capacity;
+
+    int* bucket_starts;
+    int bucket_count;          // Power of two
+    int bucket_capacity;
+
+    int* oversized;
+    int oversized_count;
+    int oversized_capacity;
+
+    // Scratch storage used during a build
+    SpatialHashEntry* staging;
+    int* entry_buckets;
+    int entry_bucket_capacity;
+
+    bool is_valid;             // Cleared when body indices change
+} SpatialHash;
+
+// Called for each body found by a radius query; return false to stop the query
+typedef bool (*SpatialHashQueryCallback)(void* context, int body_index);
+
+// Grid lifetime
+void spatial_hash_init(SpatialHash* hash, float cell_size);
+void spatial_hash_destroy(SpatialHash* hash);
+void spatial_hash_invalidate(SpatialHash* hash);
+
+// Rebuild the grid from current body positions in O(n)
+bool spatial_hash_build(SpatialHash* hash, const BodyPool* pool);
+
+// Cell helpers. Cell coordinates are clamped to
+// [-SPATIAL_HASH_CELL_LIMIT, SPATIAL_HASH_CELL_LIMIT], which keeps far away
+// and NaN positions from overflowing the int conversion and keeps cell
+// ranges countable in an int. Clamping keeps the cell order, so ranges of
+// cells still cover every position between their ends.
+#define SPATIAL_HASH_CELL_LIMIT (1 << 29)
+
+void spatial_hash_get_cell(const SpatialHash* hash, Vector3 position, int* cell_x, int* cell_y, int* cell_z);
+void spatial_hash_get_bucket(const SpatialHash* hash, int cell_x, int cell_y, int cell_z, int* begin, int* end);
+
+// Visit bodies whose positions lie within radius of center (oversized bodies included)
+void spatial_hash_query_radius(const SpatialHash* hash, const BodyPool* pool, Vector3 center, float radius,
+                               SpatialHashQueryCallback callback, void* context);
+
+// Visit bodies whose bounds may overlap [min, max]: grid bodies positioned
+// within half a cell of the box, and every oversized body. Callers test
+// the bounds exactly.
+void spatial_hash_query_aabb(const SpatialHash* hash, const BodyPool* pool, Vector3 min, Vector3 max,
+                             SpatialHashQueryCallback callback, void* context);
+
+#endif // SPATIAL_HASH_H
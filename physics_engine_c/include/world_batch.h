@@ -0,0 +1,45 @@
+#ifndef WORLD_BATCH_H
+#define WORLD_BATCH_H
+
+#include "physics_world.h"
+#include <stdint.h>
+
+// Worlds per parallel-for range when stepping a batch
+#define WORLD_BATCH_GRAIN 4
+
+// Many independent worlds stepped together, e.g. for Monte-Carlo or
+// training rollouts. The worlds sit in one contiguous array, each with its
+// own body id space, and a batch step spreads whole worlds across threads.
+typedef struct {
+    PhysicsWorld* worlds;
+    int world_count;
+
+    // Threads for the batch step; each world itself steps serially
+    JobSystem* job_system;
+
+    // Throughput: world steps taken and wall-clock seconds spent on them
+    uint64_t world_steps;
+    double step_seconds;
+    double last_step_seconds;
+} PhysicsWorldBatch;
+
+// Batch lifetime; returns NULL if the worlds could not be allocated
+PhysicsWorldBatch* physics_world_batch_create(int world_count);
+void physics_world_batch_destroy(PhysicsWorldBatch* batch);
+
+PhysicsWorld* physics_world_batch_get_world(PhysicsWorldBatch* batch, int index);
+int physics_world_batch_get_world_count(PhysicsWorldBatch* batch);
+
+// thread_count counts the calling thread; 1 steps the worlds one by one
+bool physics_world_batch_set_thread_count(PhysicsWorldBatch* batch, int thread_count);
+
+// Step every world once, with its own timestep or with dt
+void physics_world_batch_step(PhysicsWorldBatch* batch);
+void physics_world_batch_step_with_dt(PhysicsWorldBatch* batch, float dt);
+
+// World steps per second over every batch step so far, and for the last one
+double physics_world_batch_get_world_steps_per_second(PhysicsWorldBatch* batch);
+double physics_world_batch_get_last_world_steps_per_second(PhysicsWorldBatch* batch);
+void physics_world_batch_reset_stats(PhysicsWorldBatch* batch);
+
+#endif // WORLD_BATCH_H
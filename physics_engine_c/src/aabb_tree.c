@@ -0,0 +1,415 @@
+#include "../include/aabb_tree.h"
+#include "../include/allocator.h"
+#include <string.h>
+
+// Bounding box helpers
+static inline Vector3 vector3_min(Vector3 a, Vector3 b) {
+    return vector3_create(fminf(a.x, b.x), fminf(a.y, b.y), fminf(a.z, b.z));
+}
+
+static inline Vector3 vector3_max(Vector3 a, Vector3 b) {
+    return vector3_create(fmaxf(a.x, b.x), fmaxf(a.y, b.y), fmaxf(a.z, b.z));
+}
+
+static inline float surface_area(Vector3 min, Vector3 max) {
+    Vector3 d = vector3_subtract(max, min);
+    return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+}
+
+static inline bool box_contains(Vector3 outer_min, Vector3 outer_max, Vector3 min, Vector3 max) {
+    return outer_min.x <= min.x && outer_min.y <= min.y && outer_min.z <= min.z &&
+           max.x <= outer_max.x && max.y <= outer_max.y && max.z <= outer_max.z;
+}
+
+static inline bool box_overlap(Vector3 min_a, Vector3 max_a, Vector3 min_b, Vector3 max_b) {
+    return (min_a.x <= max_b.x && max_a.x >= min_b.x) &&
+           (min_a.y <= max_b.y && max_a.y >= min_b.y) &&
+           (min_a.z <= max_b.z && max_a.z >= min_b.z);
+}
+
+static int allocate_node(AABBTree* tree) {
+    if (tree->free_list == AABB_TREE_NULL_NODE) {
+        int new_capacity = tree->node_capacity > 0 ? tree->node_capacity * 2 : 16;
+        AABBTreeNode* grown = (AABBTreeNode*)physics_realloc(tree->nodes,
+                                                             (size_t)tree->node_capacity * sizeof(AABBTreeNode),
+                                                             (size_t)new_capacity * sizeof(AABBTreeNode));
+        if (!grown) return AABB_TREE_NULL_NODE;
+
+        tree->nodes = grown;
+
+        // Thread the new nodes onto the free list
+        for (int i = tree->node_capacity; i < new_capacity - 1; i++) {
+            tree->nodes[i].parent = i + 1;
+            tree->nodes[i].height = -1;
+        }
+        tree->nodes[new_capacity - 1].parent = AABB_TREE_NULL_NODE;
+        tree->nodes[new_capacity - 1].height = -1;
+
+        tree->free_list = tree->node_capacity;
+        tree->node_capacity = new_capacity;
+    }
+
+    int node_id = tree->free_list;
+    AABBTreeNode* node = &tree->nodes[node_id];
+    tree->free_list = node->parent;
+
+    node->parent = AABB_TREE_NULL_NODE;
+    node->child_a = AABB_TREE_NULL_NODE;
+    node->child_b = AABB_TREE_NULL_NODE;
+    node->height = 0;
+    node->body_index = -1;
+    tree->node_count++;
+
+    return node_id;
+}
+
+static void free_node(AABBTree* tree, int node_id) {
+    tree->nodes[node_id].parent = tree->free_list;
+    tree->nodes[node_id].height = -1;
+    tree->free_list = node_id;
+    tree->node_count--;
+}
+
+static void refit_node(AABBTree* tree, int node_id) {
+    AABBTreeNode* node = &tree->nodes[node_id];
+    AABBTreeNode* a = &tree->nodes[node->child_a];
+    AABBTreeNode* b = &tree->nodes[node->child_b];
+
+    node->min = vector3_min(a->min, b->min);
+    node->max = vector3_max(a->max, b->max);
+    node->height = 1 + (a->height > b->height ? a->height : b->height);
+}
+
+// Perform a left or right rotation if node A is imbalanced; returns the new subtree root
+static int balance(AABBTree* tree, int ia) {
+    AABBTreeNode* a = &tree->nodes[ia];
+    if (a->height < 2) return ia;
+
+    int ib = a->child_a;
+    int ic = a->child_b;
+    AABBTreeNode* b = &tree->nodes[ib];
+    AABBTreeNode* c = &tree->nodes[ic];
+
+    int balance_factor = c->height - b->height;
+
+    // Rotate C up
+    if (balance_factor > 1) {
+        int i_f = c->child_a;
+        int i_g = c->child_b;
+        AABBTreeNode* f = &tree->nodes[i_f];
+        AABBTreeNode* g = &tree->nodes[i_g];
+
+        c->child_a = ia;
+        c->parent = a->parent;
+        a->parent = ic;
+
+        if (c->parent != AABB_TREE_NULL_NODE) {
+            if (tree->nodes[c->parent].child_a == ia) {
+                tree->nodes[c->parent].child_a = ic;
+            } else {
+                tree->nodes[c->parent].child_b = ic;
+            }
+        } else {
+            tree->root = ic;
+        }
+
+        if (f->height > g->height) {
+            c->child_b = i_f;
+            a->child_b = i_g;
+            g->parent = ia;
+        } else {
+            c->child_b = i_g;
+            a->child_b = i_f;
+            f->parent = ia;
+        }
+
+        refit_node(tree, ia);
+        refit_node(tree, ic);
+        return ic;
+    }
+
+    // Rotate B up
+    if (balance_factor < -1) {
+        int i_d = b->child_a;
+        int i_e = b->child_b;
+        AABBTreeNode* d = &tree->nodes[i_d];
+        AABBTreeNode* e = &tree->nodes[i_e];
+
+        b->child_a = ia;
+        b->parent = a->parent;
+        a->parent = ib;
+
+        if (b->parent != AABB_TREE_NULL_NODE) {
+            if (tree->nodes[b->parent].child_a == ia) {
+                tree->nodes[b->parent].child_a = ib;
+            } else {
+                tree->nodes[b->parent].child_b = ib;
+            }
+        } else {
+            tree->root = ib;
+        }
+
+        if (d->height > e->height) {
+            b->child_b = i_d;
+            a->child_a = i_e;
+            e->parent = ia;
+        } else {
+            b->child_b = i_e;
+            a->child_a = i_d;
+            d->parent = ia;
+        }
+
+        refit_node(tree, ia);
+        refit_node(tree, ib);
+        return ib;
+    }
+
+    return ia;
+}
+
+// Refit and rebalance every ancestor of a node
+static void refit_ancestors(AABBTree* tree, int node_id) {
+    while (node_id != AABB_TREE_NULL_NODE) {
+        node_id = balance(tree, node_id);
+        refit_node(tree, node_id);
+        node_id = tree->nodes[node_id].parent;
+    }
+}
+
+static void insert_leaf(AABBTree* tree, int leaf) {
+    if (tree->root == AABB_TREE_NULL_NODE) {
+        tree->root = leaf;
+        tree->nodes[leaf].parent = AABB_TREE_NULL_NODE;
+        return;
+    }
+
+    // Descend by the surface area heuristic to find the best sibling
+    Vector3 leaf_min = tree->nodes[leaf].min;
+    Vector3 leaf_max = tree->nodes[leaf].max;
+    int index = tree->root;
+
+    while (tree->nodes[index].height > 0) {
+        AABBTreeNode* node = &tree->nodes[index];
+        int child_a = node->child_a;
+        int child_b = node->child_b;
+
+        float area = surface_area(node->min, node->max);
+        float combined_area = surface_area(vector3_min(node->min, leaf_min), vector3_max(node->max, leaf_max));
+
+        // Cost of creating a new parent for this node and the new leaf
+        float cost = 2.0f * combined_area;
+
+        // Minimum cost of pushing the leaf further down the tree
+        float inheritance_cost = 2.0f * (combined_area - area);
+
+        float costs[2];
+        int children[2] = { child_a, child_b };
+        for (int k = 0; k < 2; k++) {
+            AABBTreeNode* child = &tree->nodes[children[k]];
+            float enlarged = surface_area(vector3_min(child->min, leaf_min), vector3_max(child->max, leaf_max));
+            if (child->height == 0) {
+                costs[k] = enlarged + inheritance_cost;
+            } else {
+                costs[k] = (enlarged - surface_area(child->min, child->max)) + inheritance_cost;
+            }
+        }
+
+        if (cost < costs[0] && cost < costs[1]) break;
+
+        index = costs[0] < costs[1] ? child_a : child_b;
+    }
+
+    int sibling = index;
+
+    // Create a new parent joining the sibling and the leaf
+    int old_parent = tree->nodes[sibling].parent;
+    int new_parent = allocate_node(tree);
+    AABBTreeNode* parent = &tree->nodes[new_parent];
+    parent->parent = old_parent;
+    parent->min = vector3_min(leaf_min, tree->nodes[sibling].min);
+    parent->max = vector3_max(leaf_max, tree->nodes[sibling].max);
+    parent->height = tree->nodes[sibling].height + 1;
+
+    if (old_parent != AABB_TREE_NULL_NODE) {
+        if (tree->nodes[old_parent].child_a == sibling) {
+            tree->nodes[old_parent].child_a = new_parent;
+        } else {
+            tree->nodes[old_parent].child_b = new_parent;
+        }
+    } else {
+        tree->root = new_parent;
+    }
+
+    parent->child_a = sibling;
+    parent->child_b = leaf;
+    tree->nodes[sibling].parent = new_parent;
+    tree->nodes[leaf].parent = new_parent;
+
+    refit_ancestors(tree, tree->nodes[leaf].parent);
+}
+
+static void remove_leaf(AABBTree* tree, int leaf) {
+    if (leaf == tree->root) {
+        tree->root = AABB_TREE_NULL_NODE;
+        return;
+    }
+
+    int parent = tree->nodes[leaf].parent;
+    int grand_parent = tree->nodes[parent].parent;
+    int sibling = tree->nodes[parent].child_a == leaf ? tree->nodes[parent].child_b : tree->nodes[parent].child_a;
+
+    if (grand_parent != AABB_TREE_NULL_NODE) {
+        // Replace the parent with the sibling
+        if (tree->nodes[grand_parent].child_a == parent) {
+            tree->nodes[grand_parent].child_a = sibling;
+        } else {
+            tree->nodes[grand_parent].child_b = sibling;
+        }
+        tree->nodes[sibling].parent = grand_parent;
+        free_node(tree, parent);
+
+        refit_ancestors(tree, grand_parent);
+    } else {
+        tree->root = sibling;
+        tree->nodes[sibling].parent = AABB_TREE_NULL_NODE;
+        free_node(tree, parent);
+    }
+}
+
+// Enlarge a tight box by the fat margin and the predicted displacement
+static void fatten_bounds(Vector3 min, Vector3 max, Vector3 displacement, Vector3* fat_min, Vector3* fat_max) {
+    Vector3 margin = vector3_create(AABB_TREE_FAT_MARGIN, AABB_TREE_FAT_MARGIN, AABB_TREE_FAT_MARGIN);
+    *fat_min = vector3_subtract(min, margin);
+    *fat_max = vector3_add(max, margin);
+
+    Vector3 d = vector3_scale(displacement, AABB_TREE_DISPLACEMENT_MULTIPLIER);
+    if (d.x < 0.0f) fat_min->x += d.x; else fat_max->x += d.x;
+    if (d.y < 0.0f) fat_min->y += d.y; else fat_max->y += d.y;
+    if (d.z < 0.0f) fat_min->z += d.z; else fat_max->z += d.z;
+}
+
+void aabb_tree_init(AABBTree* tree) {
+    if (!tree) return;
+
+    memset(tree, 0, sizeof(AABBTree));
+    tree->root = AABB_TREE_NULL_NODE;
+    tree->free_list = AABB_TREE_NULL_NODE;
+}
+
+void aabb_tree_destroy(AABBTree* tree) {
+    if (!tree) return;
+
+    physics_free(tree->nodes, (size_t)tree->node_capacity * sizeof(AABBTreeNode));
+    physics_free(tree->stack, (size_t)tree->stack_capacity * sizeof(int));
+    aabb_tree_init(tree);
+}
+
+void aabb_tree_clear(AABBTree* tree) {
+    if (!tree) return;
+
+    // Return every node to the free list, keeping the allocation
+    for (int i = 0; i < tree->node_capacity - 1; i++) {
+        tree->nodes[i].parent = i + 1;
+        tree->nodes[i].height = -1;
+    }
+    if (tree->node_capacity > 0) {
+        tree->nodes[tree->node_capacity - 1].parent = AABB_TREE_NULL_NODE;
+        tree->nodes[tree->node_capacity - 1].height = -1;
+    }
+
+    tree->free_list = tree->node_capacity > 0 ? 0 : AABB_TREE_NULL_NODE;
+    tree->node_count = 0;
+    tree->root = AABB_TREE_NULL_NODE;
+}
+
+int aabb_tree_create_proxy(AABBTree* tree, Vector3 min, Vector3 max, int body_index) {
+    if (!tree) return AABB_TREE_NULL_NODE;
+
+    int proxy = allocate_node(tree);
+    if (proxy == AABB_TREE_NULL_NODE) return AABB_TREE_NULL_NODE;
+
+    // Make sure an insert can always get its internal parent node
+    int spare = allocate_node(tree);
+    if (spare == AABB_TREE_NULL_NODE) {
+        free_node(tree, proxy);
+        return AABB_TREE_NULL_NODE;
+    }
+    free_node(tree, spare);
+
+    fatten_bounds(min, max, vector3_zero(), &tree->nodes[proxy].min, &tree->nodes[proxy].max);
+    tree->nodes[proxy].body_index = body_index;
+    tree->nodes[proxy].height = 0;
+
+    insert_leaf(tree, proxy);
+    return proxy;
+}
+
+void aabb_tree_destroy_proxy(AABBTree* tree, int proxy) {
+    if (!tree || proxy < 0 || proxy >= tree->node_capacity) return;
+
+    remove_leaf(tree, proxy);
+    free_node(tree, proxy);
+}
+
+bool aabb_tree_move_proxy(AABBTree* tree, int proxy, Vector3 min, Vector3 max, Vector3 displacement) {
+    if (!tree || proxy < 0 || proxy >= tree->node_capacity) return false;
+
+    // Still inside the fat box: nothing to do
+    AABBTreeNode* node = &tree->nodes[proxy];
+    if (box_contains(node->min, node->max, min, max)) {
+        return false;
+    }
+
+    remove_leaf(tree, proxy);
+    fatten_bounds(min, max, displacement, &tree->nodes[proxy].min, &tree->nodes[proxy].max);
+    insert_leaf(tree, proxy);
+    return true;
+}
+
+int aabb_tree_get_body_index(const AABBTree* tree, int proxy) {
+    return tree->nodes[proxy].body_index;
+}
+
+void aabb_tree_set_body_index(AABBTree* tree, int proxy, int body_index) {
+    tree->nodes[proxy].body_index = body_index;
+}
+
+void aabb_tree_get_fat_bounds(const AABBTree* tree, int proxy, Vector3* min, Vector3* max) {
+    *min = tree->nodes[proxy].min;
+    *max = tree->nodes[proxy].max;
+}
+
+void aabb_tree_query(AABBTree* tree, Vector3 min, Vector3 max, AABBTreeQueryCallback callback, void* context) {
+    if (!tree || !callback || tree->root == AABB_TREE_NULL_NODE) return;
+
+    // The stack never holds more than one entry per node
+    if (tree->stack_capacity < tree->node_capacity) {
+        int* grown = (int*)physics_realloc(tree->stack, (size_t)tree->stack_capacity * sizeof(int),
+                                           (size_t)tree->node_capacity * sizeof(int));
+        if (!grown) return;
+        tree->stack = grown;
+        tree->stack_capacity = tree->node_capacity;
+    }
+
+    int count = 0;
+    tree->stack[count++] = tree->root;
+
+    while (count > 0) {
+        int node_id = tree->stack[--count];
+        AABBTreeNode* node = &tree->nodes[node_id];
+
+        if (!box_overlap(node->min, node->max, min, max)) continue;
+
+        if (node->height == 0) {
+            if (!callback(context, node_id, node->body_index)) return;
+        } else {
+            tree->stack[count++] = node->child_a;
+            tree->stack[count++] = node->child_b;
+        }
+    }
+}
+
+int aabb_tree_get_height(const AABBTree* tree) {
+    if (!tree || tree->root == AABB_TREE_NULL_NODE) return 0;
+    return tree->nodes[tree->root].height;
+}
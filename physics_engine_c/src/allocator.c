@@ -0,0 +1,114 @@
+#include "../include/allocator.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Null callbacks mean the C runtime allocator
+static PhysicsAllocator active_allocator = { NULL, NULL, NULL };
+
+void physics_set_allocator(const PhysicsAllocator* allocator) {
+    if (allocator && allocator->alloc && allocator->free) {
+        active_allocator = *allocator;
+    } else {
+        memset(&active_allocator, 0, sizeof(PhysicsAllocator));
+    }
+}
+
+PhysicsAllocator physics_get_allocator(void) {
+    return active_allocator;
+}
+
+void* physics_alloc(size_t size) {
+    if (active_allocator.alloc) {
+        return active_allocator.alloc(size, active_allocator.user_data);
+    }
+    return malloc(size);
+}
+
+void* physics_realloc(void* ptr, size_t old_size, size_t new_size) {
+    if (!active_allocator.alloc) {
+        return realloc(ptr, new_size);
+    }
+
+    // Hooks have no realloc; move the block by hand
+    void* grown = active_allocator.alloc(new_size, active_allocator.user_data);
+    if (!grown) return NULL;
+
+    if (ptr) {
+        memcpy(grown, ptr, old_size < new_size ? old_size : new_size);
+        active_allocator.free(ptr, old_size, active_allocator.user_data);
+    }
+    return grown;
+}
+
+void physics_free(void* ptr, size_t size) {
+    if (!ptr) return;
+
+    if (active_allocator.free) {
+        active_allocator.free(ptr, size, active_allocator.user_data);
+    } else {
+        free(ptr);
+    }
+}
+
+// Aligned blocks over-allocate and keep the raw pointer just below the block
+static size_t aligned_block_size(size_t size, size_t alignment) {
+    return size + alignment + sizeof(void*);
+}
+
+void* physics_alloc_aligned(size_t size, size_t alignment) {
+    char* raw = (char*)physics_alloc(aligned_block_size(size, alignment));
+    if (!raw) return NULL;
+
+    uintptr_t start = (uintptr_t)(raw + sizeof(void*));
+    uintptr_t aligned = (start + alignment - 1) & ~(uintptr_t)(alignment - 1);
+    char* block = raw + (aligned - (uintptr_t)raw);
+    memcpy(block - sizeof(void*), &raw, sizeof(void*));
+    return block;
+}
+
+void physics_free_aligned(void* ptr, size_t size, size_t alignment) {
+    if (!ptr) return;
+
+    void* raw;
+    memcpy(&raw, (char*)ptr - sizeof(void*), sizeof(void*));
+    physics_free(raw, aligned_block_size(size, alignment));
+}
+
+bool physics_ensure_capacity(void** array, int* capacity, int needed, size_t element_size) {
+    if (needed <= *capacity) return true;
+
+    int new_capacity = *capacity > 0 ? *capacity : 16;
+    while (new_capacity < needed) {
+        new_capacity *= 2;
+    }
+
+    void* grown = physics_realloc(*array, (size_t)*capacity * element_size, (size_t)new_capacity * element_size);
+    if (!grown) return false;
+
+    *array = grown;
+    *capacity = new_capacity;
+    return true;
+}
+
+bool physics_ensure_capacity_aligned(void** array, int* capacity, int needed, size_t element_size,
+                                     size_t alignment) {
+    if (needed <= *capacity) return true;
+
+    int new_capacity = *capacity > 0 ? *capacity : 16;
+    while (new_capacity < needed) {
+        new_capacity *= 2;
+    }
+
+    void* grown = physics_alloc_aligned((size_t)new_capacity * element_size, alignment);
+    if (!grown) return false;
+
+    if (*array) {
+        memcpy(grown, *array, (size_t)*capacity * element_size);
+        physics_free_aligned(*array, (size_t)*capacity * element_size, alignment);
+    }
+
+    *array = grown;
+    *capacity = new_capacity;
+    return true;
+}
@@ -0,0 +1,202 @@
+#include "../include/body_pool.h"
+#include "../include/collision_detection.h"
+#include "../include/allocator.h"
+#include <string.h>
+
+#define BODY_POOL_ARRAY_COUNT 17
+
+// Collect every per-body array with its element size
+static int body_pool_arrays(BodyPool* pool, void*** arrays, size_t* sizes) {
+    int n = 0;
+
+    arrays[n] = (void**)&pool->position;             sizes[n++] = sizeof(Vector3);
+    arrays[n] = (void**)&pool->velocity;             sizes[n++] = sizeof(Vector3);
+    arrays[n] = (void**)&pool->acceleration;         sizes[n++] = sizeof(Vector3);
+    arrays[n] = (void**)&pool->force;                sizes[n++] = sizeof(Vector3);
+    arrays[n] = (void**)&pool->inverse_mass;         sizes[n++] = sizeof(float);
+    arrays[n] = (void**)&pool->flags;                sizes[n++] = sizeof(uint8_t);
+    arrays[n] = (void**)&pool->rotation;             sizes[n++] = sizeof(Vector3);
+    arrays[n] = (void**)&pool->angular_velocity;     sizes[n++] = sizeof(Vector3);
+    arrays[n] = (void**)&pool->angular_acceleration; sizes[n++] = sizeof(Vector3);
+    arrays[n] = (void**)&pool->torque;               sizes[n++] = sizeof(Vector3);
+    arrays[n] = (void**)&pool->shape_type;           sizes[n++] = sizeof(uint8_t);
+    arrays[n] = (void**)&pool->shape;                sizes[n++] = sizeof(CollisionShape);
+    arrays[n] = (void**)&pool->mass;                 sizes[n++] = sizeof(float);
+    arrays[n] = (void**)&pool->restitution;          sizes[n++] = sizeof(float);
+    arrays[n] = (void**)&pool->friction;             sizes[n++] = sizeof(float);
+    arrays[n] = (void**)&pool->sleep_time;           sizes[n++] = sizeof(float);
+    arrays[n] = (void**)&pool->island;               sizes[n++] = sizeof(uint32_t);
+
+    return n;
+}
+
+bool body_pool_init(BodyPool* pool, int capacity) {
+    if (!pool || capacity < 0) return false;
+
+    memset(pool, 0, sizeof(BodyPool));
+    return body_pool_reserve(pool, capacity);
+}
+
+bool body_pool_reserve(BodyPool* pool, int capacity) {
+    if (!pool) return false;
+    if (capacity <= pool->capacity) return true;
+
+    void** arrays[BODY_POOL_ARRAY_COUNT];
+    size_t sizes[BODY_POOL_ARRAY_COUNT];
+    int array_count = body_pool_arrays(pool, arrays, sizes);
+
+    // Arrays that grew before a failure keep their larger block; capacity
+    // only advances once every array has been resized
+    for (int k = 0; k < array_count; k++) {
+        void* grown = physics_realloc(*arrays[k], (size_t)pool->capacity * sizes[k], (size_t)capacity * sizes[k]);
+        if (!grown) return false;
+        *arrays[k] = grown;
+    }
+
+    pool->capacity = capacity;
+    return true;
+}
+
+void body_pool_destroy(BodyPool* pool) {
+    if (!pool) return;
+
+    void** arrays[BODY_POOL_ARRAY_COUNT];
+    size_t sizes[BODY_POOL_ARRAY_COUNT];
+    int array_count = body_pool_arrays(pool, arrays, sizes);
+
+    for (int k = 0; k < array_count; k++) {
+        physics_free(*arrays[k], (size_t)pool->capacity * sizes[k]);
+        *arrays[k] = NULL;
+    }
+
+    pool->count = 0;
+    pool->capacity = 0;
+}
+
+void body_pool_clear(BodyPool* pool) {
+    if (pool) {
+        pool->count = 0;
+    }
+}
+
+int body_pool_add(BodyPool* pool, const RigidBody* body) {
+    if (!pool || !body) return -1;
+
+    // Amortized growth: double the capacity whenever the pool fills up
+    if (pool->count >= pool->capacity) {
+        int capacity = pool->capacity > 0 ? pool->capacity * 2 : 16;
+        if (!body_pool_reserve(pool, capacity)) return -1;
+    }
+
+    int index = pool->count++;
+    body_pool_load(pool, index, body);
+    pool->sleep_time[index] = 0.0f;
+    pool->island[index] = 0;
+    return index;
+}
+
+void body_pool_remove(BodyPool* pool, int index) {
+    if (!pool || index < 0 || index >= pool->count) return;
+
+    void** arrays[BODY_POOL_ARRAY_COUNT];
+    size_t sizes[BODY_POOL_ARRAY_COUNT];
+    int array_count = body_pool_arrays(pool, arrays, sizes);
+    int last = pool->count - 1;
+
+    // Move the last slot into the hole so removal is O(1)
+    if (index != last) {
+        for (int k = 0; k < array_count; k++) {
+            char* base = (char*)*arrays[k];
+            memcpy(base + (size_t)index * sizes[k], base + (size_t)last * sizes[k], sizes[k]);
+        }
+    }
+
+    pool->count--;
+}
+
+size_t body_pool_permute_scratch_size(const BodyPool* pool) {
+    // CollisionShape is the widest per-body field
+    return pool ? (size_t)pool->count * sizeof(CollisionShape) : 0;
+}
+
+void body_pool_permute(BodyPool* pool, const int* order, void* scratch) {
+    if (!pool || !order || !scratch) return;
+
+    void** arrays[BODY_POOL_ARRAY_COUNT];
+    size_t sizes[BODY_POOL_ARRAY_COUNT];
+    int array_count = body_pool_arrays(pool, arrays, sizes);
+    char* gathered = (char*)scratch;
+
+    // Gather each array in the new order, then copy it back in one block
+    for (int k = 0; k < array_count; k++) {
+        const char* base = (const char*)*arrays[k];
+        size_t size = sizes[k];
+
+        for (int i = 0; i < pool->count; i++) {
+            memcpy(gathered + (size_t)i * size, base + (size_t)order[i] * size, size);
+        }
+        memcpy(*arrays[k], gathered, (size_t)pool->count * size);
+    }
+}
+
+void body_pool_load(BodyPool* pool, int index, const RigidBody* body) {
+    pool->position[index] = body->position;
+    pool->velocity[index] = body->velocity;
+    pool->acceleration[index] = body->acceleration;
+    pool->force[index] = body->force_accumulator;
+    pool->inverse_mass[index] = body->inverse_mass;
+    pool->flags[index] = (uint8_t)((body->is_static ? BODY_FLAG_STATIC : 0) |
+                                   (body->is_sleeping ? BODY_FLAG_SLEEPING : 0));
+
+    pool->rotation[index] = body->rotation;
+    pool->angular_velocity[index] = body->angular_velocity;
+    pool->angular_acceleration[index] = body->angular_acceleration;
+    pool->torque[index] = body->torque_accumulator;
+
+    pool->shape_type[index] = (uint8_t)body->shape_type;
+    pool->shape[index] = body->shape;
+    pool->mass[index] = body->mass;
+    pool->restitution[index] = body->restitution;
+    pool->friction[index] = body->friction;
+}
+
+void body_pool_store(const BodyPool* pool, int index, RigidBody* body) {
+    // Only state the simulation changes is written back
+    body->position = pool->position[index];
+    body->velocity = pool->velocity[index];
+    body->acceleration = pool->acceleration[index];
+    body->force_accumulator = pool->force[index];
+    body->is_sleeping = (pool->flags[index] & BODY_FLAG_SLEEPING) != 0;
+
+    body->rotation = pool->rotation[index];
+    body->angular_velocity = pool->angular_velocity[index];
+    body->angular_acceleration = pool->angular_acceleration[index];
+    body->torque_accumulator = pool->torque[index];
+}
+
+void body_pool_get_aabb(const BodyPool* pool, int index, Vector3* min, Vector3* max) {
+    shape_get_aabb((ShapeType)pool->shape_type[index], &pool->shape[index], pool->position[index], min, max);
+}
+
+void body_pool_get_swept_aabb(const BodyPool* pool, int index, float time, Vector3* min, Vector3* max) {
+    body_pool_get_aabb(pool, index, min, max);
+    if (time <= 0.0f) return;
+
+    Vector3 displacement = vector3_scale(pool->velocity[index], time);
+    min->x += fminf(displacement.x, 0.0f);
+    min->y += fminf(displacement.y, 0.0f);
+    min->z += fminf(displacement.z, 0.0f);
+    max->x += fmaxf(displacement.x, 0.0f);
+    max->y += fmaxf(displacement.y, 0.0f);
+    max->z += fmaxf(displacement.z, 0.0f);
+}
+
+bool body_pool_swept_aabb_overlap(const BodyPool* pool, int index_a, int index_b, float time) {
+    Vector3 min_a, max_a, min_b, max_b;
+    body_pool_get_swept_aabb(pool, index_a, time, &min_a, &max_a);
+    body_pool_get_swept_aabb(pool, index_b, time, &min_b, &max_b);
+
+    return (min_a.x <= max_b.x && max_a.x >= min_b.x) &&
+           (min_a.y <= max_b.y && max_a.y >= min_b.y) &&
+           (min_a.z <= max_b.z && max_a.z >= min_b.z);
+}
@@ -0,0 +1,100 @@
+#include "../include/body_slab.h"
+#include "../include/allocator.h"
+#include <string.h>
+
+// Free bodies store the next free body in their first bytes
+static inline RigidBody* free_list_next(const RigidBody* body) {
+    RigidBody* next;
+    memcpy(&next, body, sizeof(next));
+    return next;
+}
+
+static inline void free_list_push(BodySlab* slab, RigidBody* body) {
+    memcpy(body, &slab->free_list, sizeof(slab->free_list));
+    slab->free_list = body;
+}
+
+static size_t chunk_bytes(int capacity) {
+    return sizeof(BodySlabChunk) + (size_t)capacity * sizeof(RigidBody);
+}
+
+static bool body_slab_add_chunk(BodySlab* slab, int capacity) {
+    // Header and bodies share one allocation
+    BodySlabChunk* chunk = (BodySlabChunk*)physics_alloc(chunk_bytes(capacity));
+    if (!chunk) return false;
+
+    chunk->bodies = (RigidBody*)(chunk + 1);
+    chunk->capacity = capacity;
+    chunk->next = slab->chunks;
+    slab->chunks = chunk;
+    slab->chunk_count++;
+    slab->capacity += capacity;
+
+    // Push in reverse so bodies are handed out in address order
+    for (int i = capacity - 1; i >= 0; i--) {
+        free_list_push(slab, &chunk->bodies[i]);
+    }
+    return true;
+}
+
+void body_slab_init(BodySlab* slab) {
+    if (!slab) return;
+
+    memset(slab, 0, sizeof(BodySlab));
+    slab->next_chunk_capacity = BODY_SLAB_MIN_CHUNK;
+}
+
+void body_slab_destroy(BodySlab* slab) {
+    if (!slab) return;
+
+    BodySlabChunk* chunk = slab->chunks;
+    while (chunk) {
+        BodySlabChunk* next = chunk->next;
+        physics_free(chunk, chunk_bytes(chunk->capacity));
+        chunk = next;
+    }
+
+    body_slab_init(slab);
+}
+
+bool body_slab_reserve(BodySlab* slab, int count) {
+    if (!slab) return false;
+
+    // One chunk covers the whole shortfall
+    if (count <= slab->capacity) return true;
+
+    return body_slab_add_chunk(slab, count - slab->capacity);
+}
+
+RigidBody* body_slab_alloc(BodySlab* slab) {
+    if (!slab) return NULL;
+
+    if (!slab->free_list) {
+        if (!body_slab_add_chunk(slab, slab->next_chunk_capacity)) return NULL;
+
+        if (slab->next_chunk_capacity < BODY_SLAB_MAX_CHUNK) {
+            slab->next_chunk_capacity *= 2;
+        }
+    }
+
+    RigidBody* body = slab->free_list;
+    slab->free_list = free_list_next(body);
+    slab->live_count++;
+    return body;
+}
+
+void body_slab_free(BodySlab* slab, RigidBody* body) {
+    if (!slab || !body) return;
+
+    free_list_push(slab, body);
+    slab->live_count--;
+}
+
+bool body_slab_owns(const BodySlab* slab, const RigidBody* body) {
+    if (!slab || !body) return false;
+
+    for (const BodySlabChunk* chunk = slab->chunks; chunk; chunk = chunk->next) {
+        if (body >= chunk->bodies && body < chunk->bodies + chunk->capacity) return true;
+    }
+    return false;
+}
@@ -0,0 +1,146 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "../include/body_state.h"
+#include "../include/allocator.h"
+#include <pthread.h>
+#include <string.h>
+
+struct BodyStateBuffers {
+    BodyStateSnapshot snapshots[2];
+    int front;
+
+    pthread_mutex_t mutex;
+    pthread_cond_t released;       // Signalled when a snapshot's last reader leaves
+};
+
+static bool snapshot_reserve(BodyStateSnapshot* snapshot, int needed) {
+    if (needed <= snapshot->capacity) return true;
+
+    int capacity = snapshot->capacity > 0 ? snapshot->capacity : 16;
+    while (capacity < needed) {
+        capacity *= 2;
+    }
+
+    // Every entry is rewritten by the next capture, so nothing is copied over
+    BodyHandle* handles = (BodyHandle*)physics_alloc((size_t)capacity * sizeof(BodyHandle));
+    int* body_ids = (int*)physics_alloc((size_t)capacity * sizeof(int));
+    Vector3* vectors = (Vector3*)physics_alloc((size_t)capacity * 3 * sizeof(Vector3));
+    if (!handles || !body_ids || !vectors) {
+        physics_free(handles, (size_t)capacity * sizeof(BodyHandle));
+        physics_free(body_ids, (size_t)capacity * sizeof(int));
+        physics_free(vectors, (size_t)capacity * 3 * sizeof(Vector3));
+        return false;
+    }
+
+    physics_free(snapshot->handles, (size_t)snapshot->capacity * sizeof(BodyHandle));
+    physics_free(snapshot->body_ids, (size_t)snapshot->capacity * sizeof(int));
+    physics_free(snapshot->positions, (size_t)snapshot->capacity * 3 * sizeof(Vector3));
+
+    // Positions, velocities and rotations share one block
+    snapshot->handles = handles;
+    snapshot->body_ids = body_ids;
+    snapshot->positions = vectors;
+    snapshot->velocities = vectors + capacity;
+    snapshot->rotations = vectors + 2 * capacity;
+    snapshot->capacity = capacity;
+    return true;
+}
+
+static void snapshot_destroy(BodyStateSnapshot* snapshot) {
+    physics_free(snapshot->handles, (size_t)snapshot->capacity * sizeof(BodyHandle));
+    physics_free(snapshot->body_ids, (size_t)snapshot->capacity * sizeof(int));
+    physics_free(snapshot->positions, (size_t)snapshot->capacity * 3 * sizeof(Vector3));
+    physics_free(snapshot->slot_index, (size_t)snapshot->slot_capacity * sizeof(int));
+    memset(snapshot, 0, sizeof(BodyStateSnapshot));
+}
+
+static bool snapshot_capture(BodyStateSnapshot* snapshot, const BodyPool* pool, const HandleTable* handles,
+                             RigidBody* const* bodies, uint64_t step) {
+    if (!snapshot_reserve(snapshot, pool->count) ||
+        !physics_ensure_capacity((void**)&snapshot->slot_index, &snapshot->slot_capacity, handles->slot_count,
+                                 sizeof(int))) {
+        return false;
+    }
+
+    int count = pool->count;
+    memcpy(snapshot->positions, pool->position, (size_t)count * sizeof(Vector3));
+    memcpy(snapshot->velocities, pool->velocity, (size_t)count * sizeof(Vector3));
+    memcpy(snapshot->rotations, pool->rotation, (size_t)count * sizeof(Vector3));
+
+    for (int s = 0; s < handles->slot_count; s++) {
+        snapshot->slot_index[s] = -1;
+    }
+    for (int i = 0; i < count; i++) {
+        BodyHandle handle = handle_table_get_handle(handles, i);
+        snapshot->handles[i] = handle;
+        snapshot->body_ids[i] = bodies[i]->id;
+        snapshot->slot_index[handle.slot] = i;
+    }
+
+    snapshot->count = count;
+    snapshot->slot_count = handles->slot_count;
+    snapshot->step = step;
+    return true;
+}
+
+BodyStateBuffers* body_state_buffers_create(void) {
+    BodyStateBuffers* buffers = (BodyStateBuffers*)physics_alloc(sizeof(BodyStateBuffers));
+    if (!buffers) return NULL;
+
+    memset(buffers, 0, sizeof(BodyStateBuffers));
+    pthread_mutex_init(&buffers->mutex, NULL);
+    pthread_cond_init(&buffers->released, NULL);
+    return buffers;
+}
+
+void body_state_buffers_destroy(BodyStateBuffers* buffers) {
+    if (!buffers) return;
+
+    snapshot_destroy(&buffers->snapshots[0]);
+    snapshot_destroy(&buffers->snapshots[1]);
+    pthread_mutex_destroy(&buffers->mutex);
+    pthread_cond_destroy(&buffers->released);
+    physics_free(buffers, sizeof(BodyStateBuffers));
+}
+
+const BodyStateSnapshot* body_state_buffers_acquire(BodyStateBuffers* buffers) {
+    if (!buffers) return NULL;
+
+    pthread_mutex_lock(&buffers->mutex);
+    BodyStateSnapshot* snapshot = &buffers->snapshots[buffers->front];
+    snapshot->readers++;
+    pthread_mutex_unlock(&buffers->mutex);
+    return snapshot;
+}
+
+void body_state_buffers_release(BodyStateBuffers* buffers, const BodyStateSnapshot* snapshot) {
+    if (!buffers || !snapshot) return;
+
+    pthread_mutex_lock(&buffers->mutex);
+    BodyStateSnapshot* held = &buffers->snapshots[snapshot == &buffers->snapshots[0] ? 0 : 1];
+    if (--held->readers == 0) {
+        pthread_cond_broadcast(&buffers->released);
+    }
+    pthread_mutex_unlock(&buffers->mutex);
+}
+
+bool body_state_buffers_publish(BodyStateBuffers* buffers, const BodyPool* pool, const HandleTable* handles,
+                                RigidBody* const* bodies, uint64_t step) {
+    if (!buffers || !pool || !handles) return false;
+
+    // Publishes never overlap, so the back snapshot stays the back snapshot
+    // once its readers have gone; new readers always take the front
+    pthread_mutex_lock(&buffers->mutex);
+    BodyStateSnapshot* back = &buffers->snapshots[1 - buffers->front];
+    while (back->readers > 0) {
+        pthread_cond_wait(&buffers->released, &buffers->mutex);
+    }
+    pthread_mutex_unlock(&buffers->mutex);
+
+    if (!snapshot_capture(back, pool, handles, bodies, step)) return false;
+
+    pthread_mutex_lock(&buffers->mutex);
+    buffers->front = 1 - buffers->front;
+    pthread_mutex_unlock(&buffers->mutex);
+    return true;
+}
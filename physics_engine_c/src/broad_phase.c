@@ -0,0 +1,619 @@
+#include "../include/broad_phase.h"
+#include "../include/allocator.h"
+#include <stdlib.h>
+#include <string.h>
+
+static bool push_pair(BroadPhase* broad_phase, int index_a, int index_b) {
+    if (!physics_ensure_capacity((void**)&broad_phase->pairs, &broad_phase->pair_capacity,
+                         broad_phase->pair_count + 1, sizeof(BroadPhasePair))) {
+        return false;
+    }
+
+    BroadPhasePair* pair = &broad_phase->pairs[broad_phase->pair_count++];
+    pair->index_a = index_a < index_b ? index_a : index_b;
+    pair->index_b = index_a < index_b ? index_b : index_a;
+    return true;
+}
+
+void broad_phase_init(BroadPhase* broad_phase, BroadPhaseType type) {
+    if (!broad_phase) return;
+
+    broad_phase->type = type;
+    sweep_and_prune_init(&broad_phase->sap);
+    tree_broad_phase_init(&broad_phase->tree);
+    spatial_hash_init(&broad_phase->grid, 0.0f);
+    broad_phase->prediction_time = 1.0f / 60.0f;
+    broad_phase->speculative_time = 0.0f;
+
+    broad_phase->pairs = NULL;
+    broad_phase->pair_count = 0;
+    broad_phase->pair_capacity = 0;
+}
+
+void broad_phase_destroy(BroadPhase* broad_phase) {
+    if (!broad_phase) return;
+
+    sweep_and_prune_destroy(&broad_phase->sap);
+    tree_broad_phase_destroy(&broad_phase->tree);
+    spatial_hash_destroy(&broad_phase->grid);
+    physics_free(broad_phase->pairs, (size_t)broad_phase->pair_capacity * sizeof(BroadPhasePair));
+    broad_phase->pairs = NULL;
+    broad_phase->pair_count = 0;
+    broad_phase->pair_capacity = 0;
+}
+
+bool broad_phase_add_body(BroadPhase* broad_phase, const BodyPool* pool, int body_index) {
+    if (!broad_phase || !pool || body_index < 0 || body_index >= pool->count) return false;
+
+    spatial_hash_invalidate(&broad_phase->grid);
+
+    switch (broad_phase->type) {
+        case BROAD_PHASE_SWEEP_AND_PRUNE:
+            return sweep_and_prune_add_proxy(&broad_phase->sap, body_index,
+                                             pool->shape_type[body_index] != SHAPE_PLANE);
+        case BROAD_PHASE_AABB_TREE:
+            return tree_broad_phase_add_proxy(&broad_phase->tree, pool, body_index);
+        default:
+            return true;
+    }
+}
+
+void broad_phase_remove_body(BroadPhase* broad_phase, int body_index) {
+    if (!broad_phase) return;
+
+    spatial_hash_invalidate(&broad_phase->grid);
+
+    switch (broad_phase->type) {
+        case BROAD_PHASE_SWEEP_AND_PRUNE:
+            sweep_and_prune_remove_proxy(&broad_phase->sap, body_index);
+            break;
+        case BROAD_PHASE_AABB_TREE:
+            tree_broad_phase_remove_proxy(&broad_phase->tree, body_index);
+            break;
+        default:
+            break;
+    }
+}
+
+void broad_phase_clear(BroadPhase* broad_phase) {
+    if (!broad_phase) return;
+
+    broad_phase->sap.endpoint_count = 0;
+    broad_phase->sap.proxy_count = 0;
+    broad_phase->sap.label_count = 0;
+    broad_phase->sap.has_stale_labels = false;
+    aabb_tree_clear(&broad_phase->tree.tree);
+    broad_phase->tree.body_count = 0;
+    spatial_hash_invalidate(&broad_phase->grid);
+    broad_phase->pair_count = 0;
+}
+
+void broad_phase_permute(BroadPhase* broad_phase, const int* order, int* scratch) {
+    if (!broad_phase || !order || !scratch) return;
+
+    spatial_hash_invalidate(&broad_phase->grid);
+    broad_phase->pair_count = 0;
+
+    switch (broad_phase->type) {
+        case BROAD_PHASE_SWEEP_AND_PRUNE:
+            sweep_and_prune_permute(&broad_phase->sap, order, scratch);
+            break;
+        case BROAD_PHASE_AABB_TREE:
+            tree_broad_phase_permute(&broad_phase->tree, order, scratch);
+            break;
+        default:
+            break;
+    }
+}
+
+void broad_phase_update(BroadPhase* broad_phase, const BodyPool* pool) {
+    if (!broad_phase || !pool) return;
+
+    broad_phase->pair_count = 0;
+
+    switch (broad_phase->type) {
+        case BROAD_PHASE_SWEEP_AND_PRUNE:
+            sweep_and_prune_update(&broad_phase->sap, pool, broad_phase);
+            break;
+        case BROAD_PHASE_AABB_TREE:
+            tree_broad_phase_update(&broad_phase->tree, pool, broad_phase->prediction_time, broad_phase);
+            break;
+        case BROAD_PHASE_SPATIAL_HASH:
+            spatial_hash_broad_phase_update(&broad_phase->grid, pool, broad_phase);
+            break;
+        default:
+            // Brute force pairs are enumerated directly by the world
+            break;
+    }
+}
+
+static int pair_compare(const void* a, const void* b) {
+    const BroadPhasePair* pa = (const BroadPhasePair*)a;
+    const BroadPhasePair* pb = (const BroadPhasePair*)b;
+    if (pa->index_a != pb->index_a) return pa->index_a < pb->index_a ? -1 : 1;
+    if (pa->index_b != pb->index_b) return pa->index_b < pb->index_b ? -1 : 1;
+    return 0;
+}
+
+void broad_phase_sort_pairs(BroadPhase* broad_phase) {
+    if (!broad_phase || broad_phase->pair_count < 2) return;
+
+    qsort(broad_phase->pairs, (size_t)broad_phase->pair_count, sizeof(BroadPhasePair), pair_compare);
+}
+
+void sweep_and_prune_init(SweepAndPrune* sap) {
+    if (!sap) return;
+    memset(sap, 0, sizeof(SweepAndPrune));
+}
+
+void sweep_and_prune_destroy(SweepAndPrune* sap) {
+    if (!sap) return;
+
+    size_t proxy_count = (size_t)sap->proxy_capacity;
+    physics_free(sap->endpoints, (size_t)sap->endpoint_capacity * sizeof(SweepEndpoint));
+    physics_free(sap->mins, proxy_count * sizeof(Vector3));
+    physics_free(sap->maxs, proxy_count * sizeof(Vector3));
+    physics_free(sap->active, proxy_count * sizeof(int));
+    physics_free(sap->resting, proxy_count * sizeof(int));
+    physics_free(sap->active_slot, proxy_count * sizeof(int));
+    physics_free(sap->body_label, proxy_count * sizeof(int));
+    physics_free(sap->label_body, (size_t)sap->label_capacity * sizeof(int));
+    memset(sap, 0, sizeof(SweepAndPrune));
+}
+
+bool sweep_and_prune_add_proxy(SweepAndPrune* sap, int body_index, bool has_bounds) {
+    if (!sap || body_index != sap->proxy_count) return false;
+
+    if (!physics_ensure_capacity((void**)&sap->endpoints, &sap->endpoint_capacity, sap->endpoint_count + 2,
+                                 sizeof(SweepEndpoint))) {
+        return false;
+    }
+
+    // Per-body arrays likewise share one capacity
+    int needed_proxies = sap->proxy_count + 1;
+    void** proxy_arrays[6] = { (void**)&sap->mins, (void**)&sap->maxs, (void**)&sap->active,
+                               (void**)&sap->resting, (void**)&sap->active_slot, (void**)&sap->body_label };
+    size_t proxy_sizes[6] = { sizeof(Vector3), sizeof(Vector3), sizeof(int), sizeof(int), sizeof(int), sizeof(int) };
+    int proxy_capacity = sap->proxy_capacity;
+    for (int k = 0; k < 6; k++) {
+        proxy_capacity = sap->proxy_capacity;
+        if (!physics_ensure_capacity(proxy_arrays[k], &proxy_capacity, needed_proxies, proxy_sizes[k])) {
+            return false;
+        }
+    }
+    sap->proxy_capacity = proxy_capacity;
+
+    // Fresh label; it equals the body index unless removals are still pending
+    int label = sap->label_count;
+    if (!physics_ensure_capacity((void**)&sap->label_body, &sap->label_capacity, label + 1, sizeof(int))) {
+        return false;
+    }
+    sap->label_body[label] = body_index;
+    sap->body_label[body_index] = label;
+    sap->label_count++;
+
+    sap->proxy_count++;
+    if (!has_bounds) return true;
+
+    // New endpoints go to the end; the next update's insertion sort moves them into place
+    SweepEndpoint* endpoints = sap->endpoints;
+    endpoints[sap->endpoint_count].value = 0.0f;
+    endpoints[sap->endpoint_count].data = label << 1;
+    endpoints[sap->endpoint_count + 1].value = 0.0f;
+    endpoints[sap->endpoint_count + 1].data = (label << 1) | 1;
+
+    sap->endpoint_count += 2;
+    return true;
+}
+
+void sweep_and_prune_remove_proxy(SweepAndPrune* sap, int body_index) {
+    if (!sap || body_index < 0 || body_index >= sap->proxy_count) return;
+
+    // The last body moves into the freed index, matching the world's
+    // swap-remove. Endpoints are relabelled lazily on the next update, so
+    // here only the label maps change.
+    int last = sap->proxy_count - 1;
+    sap->label_body[sap->body_label[body_index]] = -1;
+
+    if (body_index != last) {
+        int label = sap->body_label[last];
+        sap->label_body[label] = body_index;
+        sap->body_label[body_index] = label;
+    }
+
+    sap->proxy_count--;
+    sap->has_stale_labels = true;
+}
+
+void sweep_and_prune_permute(SweepAndPrune* sap, const int* order, int* scratch) {
+    if (!sap || !order || !scratch) return;
+
+    // Labels travel with their bodies; endpoints pick up the new indices on
+    // the next update's compaction, and their sorted order is unaffected
+    for (int i = 0; i < sap->proxy_count; i++) {
+        scratch[i] = sap->body_label[order[i]];
+    }
+
+    for (int i = 0; i < sap->proxy_count; i++) {
+        sap->body_label[i] = scratch[i];
+        sap->label_body[scratch[i]] = i;
+    }
+    sap->has_stale_labels = true;
+}
+
+// Drop endpoints of removed bodies and rewrite labels as body indices.
+// Sorted order is preserved because endpoint values do not change.
+static void sweep_and_prune_compact(SweepAndPrune* sap) {
+    SweepEndpoint* endpoints = sap->endpoints;
+    int write = 0;
+
+    for (int read = 0; read < sap->endpoint_count; read++) {
+        SweepEndpoint endpoint = endpoints[read];
+        int body_index = sap->label_body[endpoint.data >> 1];
+        if (body_index < 0) continue;
+
+        endpoint.data = (body_index << 1) | (endpoint.data & 1);
+        endpoints[write++] = endpoint;
+    }
+    sap->endpoint_count = write;
+
+    for (int i = 0; i < sap->proxy_count; i++) {
+        sap->label_body[i] = i;
+        sap->body_label[i] = i;
+    }
+    sap->label_count = sap->proxy_count;
+    sap->has_stale_labels = false;
+}
+
+// Min endpoints sort before max endpoints at equal values so touching boxes overlap
+static inline bool endpoint_less(SweepEndpoint a, SweepEndpoint b) {
+    if (a.value != b.value) return a.value < b.value;
+    return (a.data & 1) < (b.data & 1);
+}
+
+static int endpoint_compare(const void* a, const void* b) {
+    const SweepEndpoint* endpoint_a = (const SweepEndpoint*)a;
+    const SweepEndpoint* endpoint_b = (const SweepEndpoint*)b;
+    if (endpoint_less(*endpoint_a, *endpoint_b)) return -1;
+    if (endpoint_less(*endpoint_b, *endpoint_a)) return 1;
+    return endpoint_a->data - endpoint_b->data;
+}
+
+static void insertion_sort_endpoints(SweepEndpoint* endpoints, int count) {
+    for (int i = 1; i < count; i++) {
+        SweepEndpoint key = endpoints[i];
+        int j = i - 1;
+
+        while (j >= 0 && endpoint_less(key, endpoints[j])) {
+            endpoints[j + 1] = endpoints[j];
+            j--;
+        }
+        endpoints[j + 1] = key;
+    }
+}
+
+static inline float vector3_component(Vector3 v, int axis) {
+    return axis == 0 ? v.x : (axis == 1 ? v.y : v.z);
+}
+
+void sweep_and_prune_update(SweepAndPrune* sap, const BodyPool* pool, BroadPhase* out) {
+    if (!sap || !pool || !out) return;
+
+    if (sap->has_stale_labels) {
+        sweep_and_prune_compact(sap);
+    }
+
+    int proxy_count = sap->proxy_count;
+
+    // Cache bounds and accumulate centre statistics to pick the sweep axis
+    Vector3 sum = vector3_zero();
+    Vector3 sum_sq = vector3_zero();
+    int finite_count = 0;
+
+    for (int i = 0; i < proxy_count; i++) {
+        if (pool->shape_type[i] == SHAPE_PLANE) continue;
+
+        body_pool_get_swept_aabb(pool, i, out->speculative_time, &sap->mins[i], &sap->maxs[i]);
+
+        Vector3 center = vector3_scale(vector3_add(sap->mins[i], sap->maxs[i]), 0.5f);
+        sum = vector3_add(sum, center);
+        sum_sq = vector3_add(sum_sq, vector3_create(center.x * center.x,
+                                                    center.y * center.y,
+                                                    center.z * center.z));
+        finite_count++;
+    }
+
+    // Sweep along the axis where body centres are most spread out, unless
+    // the current axis is close enough that re-sorting wouldn't pay off
+    int sweep_axis = sap->sweep_axis;
+    if (finite_count > 0) {
+        float inv_count = 1.0f / (float)finite_count;
+        float variances[3];
+        int best_axis = 0;
+
+        for (int axis = 0; axis < 3; axis++) {
+            float mean = vector3_component(sum, axis) * inv_count;
+            variances[axis] = vector3_component(sum_sq, axis) * inv_count - mean * mean;
+            if (variances[axis] > variances[best_axis]) {
+                best_axis = axis;
+            }
+        }
+        if (variances[best_axis] > variances[sweep_axis] * SWEEP_AND_PRUNE_AXIS_SWITCH) {
+            sweep_axis = best_axis;
+        }
+    }
+
+    // Refresh endpoint values on the sweep axis and restore sorted order
+    SweepEndpoint* endpoints = sap->endpoints;
+    for (int e = 0; e < sap->endpoint_count; e++) {
+        int index = endpoints[e].data >> 1;
+        Vector3 bound = (endpoints[e].data & 1) ? sap->maxs[index] : sap->mins[index];
+        endpoints[e].value = vector3_component(bound, sweep_axis);
+    }
+
+    if (sweep_axis != sap->sweep_axis) {
+        qsort(endpoints, (size_t)sap->endpoint_count, sizeof(SweepEndpoint), endpoint_compare);
+        sap->sweep_axis = sweep_axis;
+    } else {
+        insertion_sort_endpoints(endpoints, sap->endpoint_count);
+    }
+
+    int axis_1 = (sweep_axis + 1) % 3;
+    int axis_2 = (sweep_axis + 2) % 3;
+    int counts[2] = { 0, 0 };
+    int* sets[2] = { sap->active, sap->resting };
+
+    for (int e = 0; e < sap->endpoint_count; e++) {
+        int index = endpoints[e].data >> 1;
+        int resting = (pool->flags[index] & (BODY_FLAG_STATIC | BODY_FLAG_SLEEPING)) != 0;
+        int* set = sets[resting];
+
+        if (endpoints[e].data & 1) {
+            // Max endpoint: swap-remove the body from its set
+            int slot = sap->active_slot[index];
+            int last = set[--counts[resting]];
+            set[slot] = last;
+            sap->active_slot[last] = slot;
+            continue;
+        }
+
+        // Min endpoint: every open body overlaps on the sweep axis. Moving
+        // bodies are tested against both sets, resting ones only against
+        // moving bodies.
+        Vector3 min_a = sap->mins[index];
+        Vector3 max_a = sap->maxs[index];
+
+        for (int s = 0; s <= !resting; s++) {
+            for (int k = 0; k < counts[s]; k++) {
+                int other = sets[s][k];
+                Vector3 min_b = sap->mins[other];
+                Vector3 max_b = sap->maxs[other];
+
+                if (vector3_component(min_a, axis_1) <= vector3_component(max_b, axis_1) &&
+                    vector3_component(max_a, axis_1) >= vector3_component(min_b, axis_1) &&
+                    vector3_component(min_a, axis_2) <= vector3_component(max_b, axis_2) &&
+                    vector3_component(max_a, axis_2) >= vector3_component(min_b, axis_2)) {
+                    push_pair(out, index, other);
+                }
+            }
+        }
+
+        set[counts[resting]] = index;
+        sap->active_slot[index] = counts[resting];
+        counts[resting]++;
+    }
+}
+
+void tree_broad_phase_init(TreeBroadPhase* tree) {
+    if (!tree) return;
+
+    memset(tree, 0, sizeof(TreeBroadPhase));
+    aabb_tree_init(&tree->tree);
+}
+
+void tree_broad_phase_destroy(TreeBroadPhase* tree) {
+    if (!tree) return;
+
+    aabb_tree_destroy(&tree->tree);
+    physics_free(tree->proxies, (size_t)tree->body_capacity * sizeof(int));
+    tree_broad_phase_init(tree);
+}
+
+bool tree_broad_phase_add_proxy(TreeBroadPhase* tree, const BodyPool* pool, int body_index) {
+    if (!tree || !pool || body_index != tree->body_count) return false;
+
+    if (!physics_ensure_capacity((void**)&tree->proxies, &tree->body_capacity, tree->body_count + 1, sizeof(int))) {
+        return false;
+    }
+
+    int proxy = AABB_TREE_NULL_NODE;
+
+    if (pool->shape_type[body_index] != SHAPE_PLANE) {
+        Vector3 min, max;
+        body_pool_get_aabb(pool, body_index, &min, &max);
+        proxy = aabb_tree_create_proxy(&tree->tree, min, max, body_index);
+        if (proxy == AABB_TREE_NULL_NODE) return false;
+    }
+
+    tree->proxies[tree->body_count++] = proxy;
+    return true;
+}
+
+void tree_broad_phase_remove_proxy(TreeBroadPhase* tree, int body_index) {
+    if (!tree || body_index < 0 || body_index >= tree->body_count) return;
+
+    int proxy = tree->proxies[body_index];
+    if (proxy != AABB_TREE_NULL_NODE) {
+        aabb_tree_destroy_proxy(&tree->tree, proxy);
+    }
+
+    // The last body moves into the freed index, matching the world's swap-remove
+    int last = tree->body_count - 1;
+    if (body_index != last) {
+        tree->proxies[body_index] = tree->proxies[last];
+        if (tree->proxies[body_index] != AABB_TREE_NULL_NODE) {
+            aabb_tree_set_body_index(&tree->tree, tree->proxies[body_index], body_index);
+        }
+    }
+    tree->body_count--;
+}
+
+void tree_broad_phase_permute(TreeBroadPhase* tree, const int* order, int* scratch) {
+    if (!tree || !order || !scratch) return;
+
+    for (int i = 0; i < tree->body_count; i++) {
+        scratch[i] = tree->proxies[order[i]];
+    }
+
+    // The tree's shape is unchanged; leaves just point at their new indices
+    for (int i = 0; i < tree->body_count; i++) {
+        tree->proxies[i] = scratch[i];
+        if (scratch[i] != AABB_TREE_NULL_NODE) {
+            aabb_tree_set_body_index(&tree->tree, scratch[i], i);
+        }
+    }
+}
+
+// Query context used while collecting tree pairs
+typedef struct {
+    BroadPhase* out;
+    const BodyPool* pool;
+    int body_index;
+} TreePairQuery;
+
+static bool tree_pair_callback(void* context, int proxy, int body_index) {
+    (void)proxy;
+    TreePairQuery* query = (TreePairQuery*)context;
+
+    // Pairs of moving bodies are seen from both sides; keep one. Resting
+    // bodies don't query, so their pairs are seen once.
+    if (body_index > query->body_index ||
+        (query->pool->flags[body_index] & (BODY_FLAG_STATIC | BODY_FLAG_SLEEPING))) {
+        push_pair(query->out, query->body_index, body_index);
+    }
+    return true;
+}
+
+void tree_broad_phase_update(TreeBroadPhase* tree, const BodyPool* pool, float prediction_time, BroadPhase* out) {
+    if (!tree || !pool || !out) return;
+
+    // Refit: only bodies that left their fat box are reinserted
+    for (int i = 0; i < tree->body_count; i++) {
+        int proxy = tree->proxies[i];
+        if (proxy == AABB_TREE_NULL_NODE) continue;
+
+        Vector3 min, max;
+        body_pool_get_swept_aabb(pool, i, out->speculative_time, &min, &max);
+        Vector3 displacement = vector3_scale(pool->velocity[i], prediction_time);
+        aabb_tree_move_proxy(&tree->tree, proxy, min, max, displacement);
+    }
+
+    // Report leaves whose fat boxes overlap, querying from moving bodies only
+    TreePairQuery query;
+    query.out = out;
+    query.pool = pool;
+
+    for (int i = 0; i < tree->body_count; i++) {
+        int proxy = tree->proxies[i];
+        if (proxy == AABB_TREE_NULL_NODE) continue;
+        if (pool->flags[i] & (BODY_FLAG_STATIC | BODY_FLAG_SLEEPING)) continue;
+
+        Vector3 fat_min, fat_max;
+        aabb_tree_get_fat_bounds(&tree->tree, proxy, &fat_min, &fat_max);
+
+        query.body_index = i;
+        aabb_tree_query(&tree->tree, fat_min, fat_max, tree_pair_callback, &query);
+    }
+}
+
+// Candidate from a moving body's search of the grid
+static inline void spatial_hash_test_pair(BroadPhase* out, const BodyPool* pool, int index, int other) {
+    if (other == index) return;
+    if (other < index && !(pool->flags[other] & (BODY_FLAG_STATIC | BODY_FLAG_SLEEPING))) return;
+
+    if (body_pool_swept_aabb_overlap(pool, index, other, out->speculative_time)) {
+        push_pair(out, index, other);
+    }
+}
+
+void spatial_hash_broad_phase_update(SpatialHash* grid, const BodyPool* pool, BroadPhase* out) {
+    if (!grid || !pool || !out) return;
+
+    if (!spatial_hash_build(grid, pool)) return;
+
+    const uint8_t resting = BODY_FLAG_STATIC | BODY_FLAG_SLEEPING;
+
+    // Furthest a binned body's swept bounds reach past its own box
+    float max_reach = 0.0f;
+    if (out->speculative_time > 0.0f) {
+        for (int e = 0; e < grid->entry_count; e++) {
+            int index = grid->entries[e].body_index;
+            if (pool->flags[index] & resting) continue;
+            max_reach = fmaxf(max_reach, vector3_length(pool->velocity[index]) * out->speculative_time);
+        }
+    }
+
+    // Binned bodies are no wider than a cell, so an overlapping partner's
+    // position lies within the body's bounds grown by half a cell plus that
+    // reach; without speculation, within the 27 cells around the body's own
+    // cell. Only moving bodies search; a pair of moving bodies is kept from
+    // the lower index.
+    float grow_by = 0.5f * grid->active_cell_size + max_reach;
+    Vector3 grow = vector3_create(grow_by, grow_by, grow_by);
+
+    for (int e = 0; e < grid->entry_count; e++) {
+        int index = grid->entries[e].body_index;
+        if (pool->flags[index] & resting) continue;
+
+        Vector3 min, max;
+        body_pool_get_swept_aabb(pool, index, out->speculative_time, &min, &max);
+
+        int min_x, min_y, min_z, max_x, max_y, max_z;
+        spatial_hash_get_cell(grid, vector3_subtract(min, grow), &min_x, &min_y, &min_z);
+        spatial_hash_get_cell(grid, vector3_add(max, grow), &max_x, &max_y, &max_z);
+
+        float cell_volume = (float)(max_x - min_x + 1) * (float)(max_y - min_y + 1) * (float)(max_z - min_z + 1);
+        if (cell_volume > (float)grid->entry_count) {
+            // A fast body sweeps more cells than there are entries to scan
+            for (int k = 0; k < grid->entry_count; k++) {
+                spatial_hash_test_pair(out, pool, index, grid->entries[k].body_index);
+            }
+            continue;
+        }
+
+        for (int cell_x = min_x; cell_x <= max_x; cell_x++) {
+            for (int cell_y = min_y; cell_y <= max_y; cell_y++) {
+                for (int cell_z = min_z; cell_z <= max_z; cell_z++) {
+                    int begin, end;
+                    spatial_hash_get_bucket(grid, cell_x, cell_y, cell_z, &begin, &end);
+
+                    for (int k = begin; k < end; k++) {
+                        const SpatialHashEntry* other = &grid->entries[k];
+                        if (other->cell_x != cell_x || other->cell_y != cell_y || other->cell_z != cell_z) continue;
+                        spatial_hash_test_pair(out, pool, index, other->body_index);
+                    }
+                }
+            }
+        }
+    }
+
+    // Oversized bodies are tested against everything
+    for (int k = 0; k < grid->oversized_count; k++) {
+        int index = grid->oversized[k];
+
+        for (int e = 0; e < grid->entry_count; e++) {
+            int other = grid->entries[e].body_index;
+            if ((pool->flags[index] & resting) && (pool->flags[other] & resting)) continue;
+            if (body_pool_swept_aabb_overlap(pool, index, other, out->speculative_time)) {
+                push_pair(out, index, other);
+            }
+        }
+
+        for (int j = k + 1; j < grid->oversized_count; j++) {
+            int other = grid->oversized[j];
+            if (body_pool_swept_aabb_overlap(pool, index, other, out->speculative_time)) {
+                push_pair(out, index, other);
+            }
+        }
+    }
+}
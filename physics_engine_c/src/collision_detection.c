@@ -1,5 +1,50 @@
 #include "../include/collision_detection.h"
 #include <float.h>
+#include <stddef.h>
+
+// Shape-level tests. These work on plain shape data so the RigidBody API
+// and the world's body pool share one implementation. Sphere-AABB normals
+// point from the sphere to the box, plane normals from the plane to the shape.
+// Shapes closer than margin are reported too, with the gap as a negative depth.
+static bool collide_shapes_within(ShapeType type_a, const CollisionShape* shape_a, Vector3 position_a,
+                                  ShapeType type_b, const CollisionShape* shape_b, Vector3 position_b,
+                                  float margin, Contact* contact, Vector3* contact_point);
+static bool sphere_sphere_test(Vector3 position_a, float radius_a, Vector3 position_b, float radius_b,
+                               float margin, Contact* contact, Vector3* contact_point);
+static bool sphere_aabb_test(Vector3 sphere_position, float radius, Vector3 aabb_position, Vector3 half_extents,
+                             float margin, Contact* contact, Vector3* contact_point);
+static bool aabb_aabb_test(Vector3 position_a, Vector3 half_extents_a, Vector3 position_b, Vector3 half_extents_b,
+                           float margin, Contact* contact, Vector3* contact_point);
+static bool sphere_plane_test(Vector3 position, float radius, const PlaneShape* plane,
+                              float margin, Contact* contact, Vector3* contact_point);
+static bool aabb_plane_test(Vector3 position, Vector3 half_extents, const PlaneShape* plane,
+                            float margin, Contact* contact, Vector3* contact_point);
+
+// Run a shape-level test for two RigidBodies and expand the compact result
+static bool rigid_body_test(ShapeType type_a, RigidBody* body_a, ShapeType type_b, RigidBody* body_b,
+                            CollisionInfo* info) {
+    Contact contact;
+    Vector3 contact_point;
+    
+    if (!collide_shapes(type_a, &body_a->shape, body_a->position, type_b, &body_b->shape, body_b->position,
+                        &contact, &contact_point)) {
+        return false;
+    }
+    
+    info->has_collision = true;
+    info->contact_point = contact_point;
+    info->normal = contact.normal;
+    info->penetration_depth = contact.penetration_depth;
+    return true;
+}
+
+// Turn a result computed with the shapes swapped around so it points from A to B
+static inline bool contact_flip(bool hit, Contact* contact) {
+    if (hit) {
+        contact->normal = vector3_negate(contact->normal);
+    }
+    return hit;
+}
 
 bool detect_collision(RigidBody* body_a, RigidBody* body_b, CollisionInfo* info) {
     if (!body_a || !body_b || !info) return false;
@@ -9,62 +54,98 @@ bool detect_collision(RigidBody* body_a, RigidBody* body_b, CollisionInfo* info)
     info->body_a = body_a;
     info->body_b = body_b;
     
+    return rigid_body_test(body_a->shape_type, body_a, body_b->shape_type, body_b, info);
+}
+
+bool collide_shapes(ShapeType type_a, const CollisionShape* shape_a, Vector3 position_a,
+                    ShapeType type_b, const CollisionShape* shape_b, Vector3 position_b,
+                    Contact* contact, Vector3* contact_point) {
+    return collide_shapes_within(type_a, shape_a, position_a, type_b, shape_b, position_b, 0.0f,
+                                 contact, contact_point);
+}
+
+bool collide_shapes_speculative(ShapeType type_a, const CollisionShape* shape_a, Vector3 position_a,
+                                ShapeType type_b, const CollisionShape* shape_b, Vector3 position_b,
+                                float margin, Contact* contact) {
+    return collide_shapes_within(type_a, shape_a, position_a, type_b, shape_b, position_b, fmaxf(margin, 0.0f),
+                                 contact, NULL);
+}
+
+static bool collide_shapes_within(ShapeType type_a, const CollisionShape* shape_a, Vector3 position_a,
+                                  ShapeType type_b, const CollisionShape* shape_b, Vector3 position_b,
+                                  float margin, Contact* contact, Vector3* contact_point) {
+    if (!shape_a || !shape_b || !contact) return false;
+    
     // Quick broad-phase check
-    if (!aabb_overlap_test(body_a, body_b)) {
+    Vector3 min_a, max_a, min_b, max_b;
+    shape_get_aabb(type_a, shape_a, position_a, &min_a, &max_a);
+    shape_get_aabb(type_b, shape_b, position_b, &min_b, &max_b);
+    if (!((min_a.x <= max_b.x + margin && max_a.x + margin >= min_b.x) &&
+          (min_a.y <= max_b.y + margin && max_a.y + margin >= min_b.y) &&
+          (min_a.z <= max_b.z + margin && max_a.z + margin >= min_b.z))) {
         return false;
     }
     
     // Dispatch to specific collision detection based on shape types
-    if (body_a->shape_type == SHAPE_SPHERE && body_b->shape_type == SHAPE_SPHERE) {
-        return sphere_sphere_collision(body_a, body_b, info);
+    if (type_a == SHAPE_SPHERE && type_b == SHAPE_SPHERE) {
+        return sphere_sphere_test(position_a, shape_a->sphere.radius, position_b, shape_b->sphere.radius,
+                                  margin, contact, contact_point);
     }
-    else if (body_a->shape_type == SHAPE_SPHERE && body_b->shape_type == SHAPE_AABB) {
-        return sphere_aabb_collision(body_a, body_b, info);
+    else if (type_a == SHAPE_SPHERE && type_b == SHAPE_AABB) {
+        return sphere_aabb_test(position_a, shape_a->sphere.radius, position_b, shape_b->aabb.half_extents,
+                                margin, contact, contact_point);
     }
-    else if (body_a->shape_type == SHAPE_AABB && body_b->shape_type == SHAPE_SPHERE) {
-        return sphere_aabb_collision(body_b, body_a, info);
+    else if (type_a == SHAPE_AABB && type_b == SHAPE_SPHERE) {
+        return contact_flip(sphere_aabb_test(position_b, shape_b->sphere.radius, position_a,
+                                             shape_a->aabb.half_extents, margin, contact, contact_point), contact);
     }
-    else if (body_a->shape_type == SHAPE_AABB && body_b->shape_type == SHAPE_AABB) {
-        return aabb_aabb_collision(body_a, body_b, info);
+    else if (type_a == SHAPE_AABB && type_b == SHAPE_AABB) {
+        return aabb_aabb_test(position_a, shape_a->aabb.half_extents, position_b, shape_b->aabb.half_extents,
+                              margin, contact, contact_point);
     }
-    else if (body_a->shape_type == SHAPE_SPHERE && body_b->shape_type == SHAPE_PLANE) {
-        return sphere_plane_collision(body_a, body_b, info);
+    else if (type_a == SHAPE_SPHERE && type_b == SHAPE_PLANE) {
+        return contact_flip(sphere_plane_test(position_a, shape_a->sphere.radius, &shape_b->plane,
+                                              margin, contact, contact_point), contact);
     }
-    else if (body_a->shape_type == SHAPE_PLANE && body_b->shape_type == SHAPE_SPHERE) {
-        return sphere_plane_collision(body_b, body_a, info);
+    else if (type_a == SHAPE_PLANE && type_b == SHAPE_SPHERE) {
+        return sphere_plane_test(position_b, shape_b->sphere.radius, &shape_a->plane, margin, contact, contact_point);
     }
-    else if (body_a->shape_type == SHAPE_AABB && body_b->shape_type == SHAPE_PLANE) {
-        return aabb_plane_collision(body_a, body_b, info);
+    else if (type_a == SHAPE_AABB && type_b == SHAPE_PLANE) {
+        return contact_flip(aabb_plane_test(position_a, shape_a->aabb.half_extents, &shape_b->plane,
+                                            margin, contact, contact_point), contact);
     }
-    else if (body_a->shape_type == SHAPE_PLANE && body_b->shape_type == SHAPE_AABB) {
-        return aabb_plane_collision(body_b, body_a, info);
+    else if (type_a == SHAPE_PLANE && type_b == SHAPE_AABB) {
+        return aabb_plane_test(position_b, shape_b->aabb.half_extents, &shape_a->plane, margin, contact, contact_point);
     }
     
     return false;
 }
 
 bool sphere_sphere_collision(RigidBody* sphere_a, RigidBody* sphere_b, CollisionInfo* info) {
-    float radius_a = sphere_a->shape.sphere.radius;
-    float radius_b = sphere_b->shape.sphere.radius;
-    
-    Vector3 center_to_center = vector3_subtract(sphere_b->position, sphere_a->position);
+    return rigid_body_test(SHAPE_SPHERE, sphere_a, SHAPE_SPHERE, sphere_b, info);
+}
+
+static bool sphere_sphere_test(Vector3 position_a, float radius_a, Vector3 position_b, float radius_b,
+                               float margin, Contact* contact, Vector3* contact_point) {
+    Vector3 center_to_center = vector3_subtract(position_b, position_a);
     float distance = vector3_length(center_to_center);
     float combined_radius = radius_a + radius_b;
     
-    if (distance < combined_radius) {
-        info->has_collision = true;
-        info->penetration_depth = combined_radius - distance;
+    if (distance < combined_radius + margin) {
+        contact->penetration_depth = combined_radius - distance;
         
         if (distance > VECTOR_EPSILON) {
-            info->normal = vector3_normalize(center_to_center);
+            contact->normal = vector3_normalize(center_to_center);
         } else {
             // Spheres are at same position, choose arbitrary normal
-            info->normal = vector3_create(1.0f, 0.0f, 0.0f);
+            contact->normal = vector3_create(1.0f, 0.0f, 0.0f);
         }
         
         // Contact point is on the surface of sphere A
-        Vector3 contact_offset = vector3_scale(info->normal, radius_a - info->penetration_depth * 0.5f);
-        info->contact_point = vector3_add(sphere_a->position, contact_offset);
+        if (contact_point) {
+            Vector3 contact_offset = vector3_scale(contact->normal, radius_a - contact->penetration_depth * 0.5f);
+            *contact_point = vector3_add(position_a, contact_offset);
+        }
         
         return true;
     }
@@ -73,49 +154,64 @@ bool sphere_sphere_collision(RigidBody* sphere_a, RigidBody* sphere_b, Collision
 }
 
 bool sphere_aabb_collision(RigidBody* sphere, RigidBody* aabb, CollisionInfo* info) {
-    Vector3 closest_point = closest_point_on_aabb(sphere->position, aabb);
-    Vector3 sphere_to_closest = vector3_subtract(closest_point, sphere->position);
+    return rigid_body_test(SHAPE_SPHERE, sphere, SHAPE_AABB, aabb, info);
+}
+
+static bool sphere_aabb_test(Vector3 sphere_position, float radius, Vector3 aabb_position, Vector3 half_extents,
+                             float margin, Contact* contact, Vector3* contact_point) {
+    Vector3 min = vector3_create(aabb_position.x - half_extents.x,
+                                 aabb_position.y - half_extents.y,
+                                 aabb_position.z - half_extents.z);
+    Vector3 max = vector3_create(aabb_position.x + half_extents.x,
+                                 aabb_position.y + half_extents.y,
+                                 aabb_position.z + half_extents.z);
+    
+    Vector3 closest_point;
+    closest_point.x = fmaxf(min.x, fminf(sphere_position.x, max.x));
+    closest_point.y = fmaxf(min.y, fminf(sphere_position.y, max.y));
+    closest_point.z = fmaxf(min.z, fminf(sphere_position.z, max.z));
+    
+    Vector3 sphere_to_closest = vector3_subtract(closest_point, sphere_position);
     float distance = vector3_length(sphere_to_closest);
     
-    if (distance < sphere->shape.sphere.radius) {
-        info->has_collision = true;
-        info->penetration_depth = sphere->shape.sphere.radius - distance;
-        info->contact_point = closest_point;
+    if (distance < radius + margin) {
+        contact->penetration_depth = radius - distance;
+        if (contact_point) {
+            *contact_point = closest_point;
+        }
         
         if (distance > VECTOR_EPSILON) {
-            info->normal = vector3_normalize(vector3_negate(sphere_to_closest));
+            contact->normal = vector3_normalize(sphere_to_closest);
         } else {
-            // Sphere center is inside AABB, find the closest face
-            Vector3 aabb_center = aabb->position;
-            Vector3 to_sphere = vector3_subtract(sphere->position, aabb_center);
-            Vector3 half_extents = aabb->shape.aabb.half_extents;
+            // Sphere center is inside AABB, push it out through the closest face
+            Vector3 to_sphere = vector3_subtract(sphere_position, aabb_position);
             
             // Find the axis with minimum penetration
             float min_penetration = FLT_MAX;
-            Vector3 min_normal = vector3_create(1.0f, 0.0f, 0.0f);
+            Vector3 min_normal = vector3_create(-1.0f, 0.0f, 0.0f);
             
             // Check X axis
             float x_penetration = half_extents.x - fabsf(to_sphere.x);
             if (x_penetration < min_penetration) {
                 min_penetration = x_penetration;
-                min_normal = vector3_create(to_sphere.x > 0 ? 1.0f : -1.0f, 0.0f, 0.0f);
+                min_normal = vector3_create(to_sphere.x > 0 ? -1.0f : 1.0f, 0.0f, 0.0f);
             }
             
             // Check Y axis
             float y_penetration = half_extents.y - fabsf(to_sphere.y);
             if (y_penetration < min_penetration) {
                 min_penetration = y_penetration;
-                min_normal = vector3_create(0.0f, to_sphere.y > 0 ? 1.0f : -1.0f, 0.0f);
+                min_normal = vector3_create(0.0f, to_sphere.y > 0 ? -1.0f : 1.0f, 0.0f);
             }
             
             // Check Z axis
             float z_penetration = half_extents.z - fabsf(to_sphere.z);
             if (z_penetration < min_penetration) {
                 min_penetration = z_penetration;
-                min_normal = vector3_create(0.0f, 0.0f, to_sphere.z > 0 ? 1.0f : -1.0f);
+                min_normal = vector3_create(0.0f, 0.0f, to_sphere.z > 0 ? -1.0f : 1.0f);
             }
             
-            info->normal = min_normal;
+            contact->normal = min_normal;
         }
         
         return true;
@@ -125,48 +221,57 @@ bool sphere_aabb_collision(RigidBody* sphere, RigidBody* aabb, CollisionInfo* in
 }
 
 bool aabb_aabb_collision(RigidBody* aabb_a, RigidBody* aabb_b, CollisionInfo* info) {
-    Vector3 min_a = get_aabb_min(aabb_a);
-    Vector3 max_a = get_aabb_max(aabb_a);
-    Vector3 min_b = get_aabb_min(aabb_b);
-    Vector3 max_b = get_aabb_max(aabb_b);
+    return rigid_body_test(SHAPE_AABB, aabb_a, SHAPE_AABB, aabb_b, info);
+}
+
+static bool aabb_aabb_test(Vector3 position_a, Vector3 half_extents_a, Vector3 position_b, Vector3 half_extents_b,
+                           float margin, Contact* contact, Vector3* contact_point) {
+    CollisionShape shape_a, shape_b;
+    shape_a.aabb.half_extents = half_extents_a;
+    shape_b.aabb.half_extents = half_extents_b;
+    
+    Vector3 min_a, max_a, min_b, max_b;
+    shape_get_aabb(SHAPE_AABB, &shape_a, position_a, &min_a, &max_a);
+    shape_get_aabb(SHAPE_AABB, &shape_b, position_b, &min_b, &max_b);
     
     // Check for overlap on all axes
-    bool overlap_x = (min_a.x <= max_b.x) && (max_a.x >= min_b.x);
-    bool overlap_y = (min_a.y <= max_b.y) && (max_a.y >= min_b.y);
-    bool overlap_z = (min_a.z <= max_b.z) && (max_a.z >= min_b.z);
+    bool overlap_x = (min_a.x <= max_b.x + margin) && (max_a.x + margin >= min_b.x);
+    bool overlap_y = (min_a.y <= max_b.y + margin) && (max_a.y + margin >= min_b.y);
+    bool overlap_z = (min_a.z <= max_b.z + margin) && (max_a.z + margin >= min_b.z);
     
     if (overlap_x && overlap_y && overlap_z) {
-        info->has_collision = true;
-        
-        // Calculate penetration on each axis
+        // Calculate penetration on each axis; a separating axis has the
+        // most negative one, so it is the axis picked below
         float x_penetration = fminf(max_a.x - min_b.x, max_b.x - min_a.x);
         float y_penetration = fminf(max_a.y - min_b.y, max_b.y - min_a.y);
         float z_penetration = fminf(max_a.z - min_b.z, max_b.z - min_a.z);
         
         // Find the axis with minimum penetration (separation axis)
         if (x_penetration < y_penetration && x_penetration < z_penetration) {
-            info->penetration_depth = x_penetration;
-            info->normal = vector3_create(aabb_a->position.x < aabb_b->position.x ? -1.0f : 1.0f, 0.0f, 0.0f);
+            contact->penetration_depth = x_penetration;
+            contact->normal = vector3_create(position_a.x < position_b.x ? 1.0f : -1.0f, 0.0f, 0.0f);
         } else if (y_penetration < z_penetration) {
-            info->penetration_depth = y_penetration;
-            info->normal = vector3_create(0.0f, aabb_a->position.y < aabb_b->position.y ? -1.0f : 1.0f, 0.0f);
+            contact->penetration_depth = y_penetration;
+            contact->normal = vector3_create(0.0f, position_a.y < position_b.y ? 1.0f : -1.0f, 0.0f);
         } else {
-            info->penetration_depth = z_penetration;
-            info->normal = vector3_create(0.0f, 0.0f, aabb_a->position.z < aabb_b->position.z ? -1.0f : 1.0f);
+            contact->penetration_depth = z_penetration;
+            contact->normal = vector3_create(0.0f, 0.0f, position_a.z < position_b.z ? 1.0f : -1.0f);
         }
         
         // Calculate contact point (center of overlap region)
-        Vector3 overlap_min = vector3_create(
-            fmaxf(min_a.x, min_b.x),
-            fmaxf(min_a.y, min_b.y),
-            fmaxf(min_a.z, min_b.z)
-        );
-        Vector3 overlap_max = vector3_create(
-            fminf(max_a.x, max_b.x),
-            fminf(max_a.y, max_b.y),
-            fminf(max_a.z, max_b.z)
-        );
-        info->contact_point = vector3_scale(vector3_add(overlap_min, overlap_max), 0.5f);
+        if (contact_point) {
+            Vector3 overlap_min = vector3_create(
+                fmaxf(min_a.x, min_b.x),
+                fmaxf(min_a.y, min_b.y),
+                fmaxf(min_a.z, min_b.z)
+            );
+            Vector3 overlap_max = vector3_create(
+                fminf(max_a.x, max_b.x),
+                fminf(max_a.y, max_b.y),
+                fminf(max_a.z, max_b.z)
+            );
+            *contact_point = vector3_scale(vector3_add(overlap_min, overlap_max), 0.5f);
+        }
         
         return true;
     }
@@ -175,17 +280,22 @@ bool aabb_aabb_collision(RigidBody* aabb_a, RigidBody* aabb_b, CollisionInfo* in
 }
 
 bool sphere_plane_collision(RigidBody* sphere, RigidBody* plane, CollisionInfo* info) {
-    float distance = distance_to_plane(sphere->position, plane);
-    float radius = sphere->shape.sphere.radius;
+    return rigid_body_test(SHAPE_SPHERE, sphere, SHAPE_PLANE, plane, info);
+}
+
+static bool sphere_plane_test(Vector3 position, float radius, const PlaneShape* plane,
+                              float margin, Contact* contact, Vector3* contact_point) {
+    float distance = vector3_dot(position, plane->normal) - plane->distance;
     
-    if (distance < radius) {
-        info->has_collision = true;
-        info->penetration_depth = radius - distance;
-        info->normal = plane->shape.plane.normal;
+    if (distance < radius + margin) {
+        contact->penetration_depth = radius - distance;
+        contact->normal = plane->normal;
         
         // Contact point is on the sphere surface closest to the plane
-        Vector3 contact_offset = vector3_scale(info->normal, -radius);
-        info->contact_point = vector3_add(sphere->position, contact_offset);
+        if (contact_point) {
+            Vector3 contact_offset = vector3_scale(plane->normal, -radius);
+            *contact_point = vector3_add(position, contact_offset);
+        }
         
         return true;
     }
@@ -194,24 +304,29 @@ bool sphere_plane_collision(RigidBody* sphere, RigidBody* plane, CollisionInfo*
 }
 
 bool aabb_plane_collision(RigidBody* aabb, RigidBody* plane, CollisionInfo* info) {
-    Vector3 half_extents = aabb->shape.aabb.half_extents;
-    Vector3 plane_normal = plane->shape.plane.normal;
+    return rigid_body_test(SHAPE_AABB, aabb, SHAPE_PLANE, plane, info);
+}
+
+static bool aabb_plane_test(Vector3 position, Vector3 half_extents, const PlaneShape* plane,
+                            float margin, Contact* contact, Vector3* contact_point) {
+    Vector3 plane_normal = plane->normal;
     
     // Calculate the extent of the AABB along the plane normal
     float extent = fabsf(half_extents.x * plane_normal.x) +
                    fabsf(half_extents.y * plane_normal.y) +
                    fabsf(half_extents.z * plane_normal.z);
     
-    float distance = distance_to_plane(aabb->position, plane);
+    float distance = vector3_dot(position, plane_normal) - plane->distance;
     
-    if (distance < extent) {
-        info->has_collision = true;
-        info->penetration_depth = extent - distance;
-        info->normal = plane_normal;
+    if (distance < extent + margin) {
+        contact->penetration_depth = extent - distance;
+        contact->normal = plane_normal;
         
         // Contact point is the closest point on the AABB to the plane
-        Vector3 contact_offset = vector3_scale(plane_normal, -distance);
-        info->contact_point = vector3_add(aabb->position, contact_offset);
+        if (contact_point) {
+            Vector3 contact_offset = vector3_scale(plane_normal, -distance);
+            *contact_point = vector3_add(position, contact_offset);
+        }
         
         return true;
     }
@@ -219,6 +334,146 @@ bool aabb_plane_collision(RigidBody* aabb, RigidBody* plane, CollisionInfo* info
     return false;
 }
 
+bool sweep_shapes(ShapeType type_a, const CollisionShape* shape_a, Vector3 position_a, Vector3 displacement,
+                  ShapeType type_b, const CollisionShape* shape_b, Vector3 position_b, float* toi) {
+    if (!shape_a || !shape_b || !toi) return false;
+    
+    if (type_a == SHAPE_SPHERE && type_b == SHAPE_SPHERE) {
+        return swept_sphere_sphere(position_a, shape_a->sphere.radius, displacement,
+                                   position_b, shape_b->sphere.radius, toi);
+    }
+    else if (type_a == SHAPE_SPHERE && type_b == SHAPE_AABB) {
+        return swept_sphere_aabb(position_a, shape_a->sphere.radius, displacement,
+                                 position_b, shape_b->aabb.half_extents, toi);
+    }
+    else if (type_a == SHAPE_AABB && type_b == SHAPE_SPHERE) {
+        // The sphere moves the opposite way relative to the box
+        return swept_sphere_aabb(position_b, shape_b->sphere.radius, vector3_negate(displacement),
+                                 position_a, shape_a->aabb.half_extents, toi);
+    }
+    else if (type_a == SHAPE_AABB && type_b == SHAPE_AABB) {
+        // A's centre as a point against B grown by A's half extents
+        return swept_sphere_aabb(position_a, 0.0f, displacement, position_b,
+                                 vector3_add(shape_a->aabb.half_extents, shape_b->aabb.half_extents), toi);
+    }
+    else if (type_a == SHAPE_SPHERE && type_b == SHAPE_PLANE) {
+        return swept_sphere_plane(position_a, shape_a->sphere.radius, displacement, &shape_b->plane, toi);
+    }
+    else if (type_a == SHAPE_AABB && type_b == SHAPE_PLANE) {
+        Vector3 half = shape_a->aabb.half_extents;
+        Vector3 normal = shape_b->plane.normal;
+        float extent = fabsf(half.x * normal.x) + fabsf(half.y * normal.y) + fabsf(half.z * normal.z);
+        return swept_sphere_plane(position_a, extent, displacement, &shape_b->plane, toi);
+    }
+    
+    // Planes never move
+    return false;
+}
+
+bool swept_sphere_plane(Vector3 center, float radius, Vector3 displacement, const PlaneShape* plane, float* toi) {
+    float gap = vector3_dot(center, plane->normal) - plane->distance - radius;
+    float approach = -vector3_dot(displacement, plane->normal);
+    
+    // Already touching, moving away, or stopping short of the plane
+    if (gap <= 0.0f || approach <= 0.0f || approach <= gap) return false;
+    
+    *toi = gap / approach;
+    return true;
+}
+
+bool swept_sphere_sphere(Vector3 center, float radius, Vector3 displacement,
+                         Vector3 other_center, float other_radius, float* toi) {
+    // Ray from the centre against a sphere of the combined radius: solve
+    // |m + t d|^2 = r^2 for the first t in [0, 1]
+    Vector3 m = vector3_subtract(center, other_center);
+    float combined = radius + other_radius;
+    float c = vector3_dot(m, m) - combined * combined;
+    float b = vector3_dot(m, displacement);
+    if (c <= 0.0f || b >= 0.0f) return false;
+    
+    float a = vector3_dot(displacement, displacement);
+    float discriminant = b * b - a * c;
+    if (discriminant < 0.0f) return false;
+    
+    float t = (-b - sqrtf(discriminant)) / a;
+    if (t > 1.0f) return false;
+    
+    *toi = t;
+    return true;
+}
+
+bool swept_sphere_aabb(Vector3 center, float radius, Vector3 displacement,
+                       Vector3 aabb_center, Vector3 half_extents, float* toi) {
+    // Clip the path against the box grown by the radius; the sphere can only
+    // touch the box while its centre is inside the grown box
+    float origin[3] = { center.x - aabb_center.x, center.y - aabb_center.y, center.z - aabb_center.z };
+    float direction[3] = { displacement.x, displacement.y, displacement.z };
+    float half[3] = { half_extents.x, half_extents.y, half_extents.z };
+    
+    float t_enter = 0.0f;
+    float t_exit = 1.0f;
+    
+    for (int axis = 0; axis < 3; axis++) {
+        float o = origin[axis];
+        float e = half[axis] + radius;
+        
+        if (fabsf(direction[axis]) < 1e-12f) {
+            if (o < -e || o > e) return false;
+            continue;
+        }
+        
+        float inverse = 1.0f / direction[axis];
+        float t0 = (-e - o) * inverse;
+        float t1 = (e - o) * inverse;
+        if (t0 > t1) {
+            float swap = t0;
+            t0 = t1;
+            t1 = swap;
+        }
+        
+        if (t0 > t_enter) t_enter = t0;
+        if (t1 < t_exit) t_exit = t1;
+        if (t_enter > t_exit) return false;
+    }
+    
+    // A point against a box: the clipped entry is exact
+    if (radius <= 0.0f) {
+        if (t_enter <= 0.0f) return false;
+        *toi = t_enter;
+        return true;
+    }
+    
+    // Near edges and corners the grown box is square where the true shape is
+    // rounded, so advance from the entry by the remaining gap until the
+    // sphere touches. The gap never shrinks faster than the sphere moves, so
+    // no step overshoots.
+    float length = sqrtf(direction[0] * direction[0] + direction[1] * direction[1] + direction[2] * direction[2]);
+    float tolerance = 1e-3f * radius;
+    float t = t_enter;
+    
+    for (int iteration = 0; iteration < 32; iteration++) {
+        float gap_sq = 0.0f;
+        for (int axis = 0; axis < 3; axis++) {
+            float p = origin[axis] + direction[axis] * t;
+            float outside = fabsf(p) - half[axis];
+            if (outside > 0.0f) gap_sq += outside * outside;
+        }
+        
+        float gap = sqrtf(gap_sq) - radius;
+        if (gap <= tolerance) {
+            // Touching from the very start is for the discrete test
+            if (t <= 0.0f) return false;
+            *toi = t;
+            return true;
+        }
+        
+        t += gap / length;
+        if (t > t_exit) return false;
+    }
+    
+    return false;
+}
+
 Vector3 closest_point_on_aabb(Vector3 point, RigidBody* aabb) {
     Vector3 min = get_aabb_min(aabb);
     Vector3 max = get_aabb_max(aabb);
@@ -258,43 +513,29 @@ bool aabb_overlap_test(RigidBody* body_a, RigidBody* body_b) {
 }
 
 Vector3 get_aabb_min(RigidBody* body) {
-    if (body->shape_type == SHAPE_SPHERE) {
-        float radius = body->shape.sphere.radius;
-        return vector3_create(
-            body->position.x - radius,
-            body->position.y - radius,
-            body->position.z - radius
-        );
-    } else if (body->shape_type == SHAPE_AABB) {
-        Vector3 half_extents = body->shape.aabb.half_extents;
-        return vector3_create(
-            body->position.x - half_extents.x,
-            body->position.y - half_extents.y,
-            body->position.z - half_extents.z
-        );
-    } else {
-        // For planes, return a very large negative value
-        return vector3_create(-FLT_MAX, -FLT_MAX, -FLT_MAX);
-    }
+    Vector3 min, max;
+    shape_get_aabb(body->shape_type, &body->shape, body->position, &min, &max);
+    return min;
 }
 
 Vector3 get_aabb_max(RigidBody* body) {
-    if (body->shape_type == SHAPE_SPHERE) {
-        float radius = body->shape.sphere.radius;
-        return vector3_create(
-            body->position.x + radius,
-            body->position.y + radius,
-            body->position.z + radius
-        );
-    } else if (body->shape_type == SHAPE_AABB) {
-        Vector3 half_extents = body->shape.aabb.half_extents;
-        return vector3_create(
-            body->position.x + half_extents.x,
-            body->position.y + half_extents.y,
-            body->position.z + half_extents.z
-        );
+    Vector3 min, max;
+    shape_get_aabb(body->shape_type, &body->shape, body->position, &min, &max);
+    return max;
+}
+
+void shape_get_aabb(ShapeType type, const CollisionShape* shape, Vector3 position, Vector3* min, Vector3* max) {
+    if (type == SHAPE_SPHERE) {
+        float radius = shape->sphere.radius;
+        *min = vector3_create(position.x - radius, position.y - radius, position.z - radius);
+        *max = vector3_create(position.x + radius, position.y + radius, position.z + radius);
+    } else if (type == SHAPE_AABB) {
+        Vector3 half_extents = shape->aabb.half_extents;
+        *min = vector3_create(position.x - half_extents.x, position.y - half_extents.y, position.z - half_extents.z);
+        *max = vector3_create(position.x + half_extents.x, position.y + half_extents.y, position.z + half_extents.z);
     } else {
-        // For planes, return a very large positive value
-        return vector3_create(FLT_MAX, FLT_MAX, FLT_MAX);
+        // For planes, return very large bounds
+        *min = vector3_create(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+        *max = vector3_create(FLT_MAX, FLT_MAX, FLT_MAX);
     }
 }
\ No newline at end of file
@@ -1,27 +1,158 @@
 #include "../include/collision_response.h"
 
-void resolve_collision(CollisionInfo* collision) {
-    if (!collision || !collision->has_collision) return;
+// Contact-level steps shared by the RigidBody API and the world's body pool
+static void contact_separate(ContactBody* body_a, ContactBody* body_b, Vector3 normal, float penetration_depth);
+static float contact_apply_impulse(ContactBody* body_a, ContactBody* body_b, Vector3 normal);
+static float contact_apply_friction(ContactBody* body_a, ContactBody* body_b, Vector3 normal);
+static void contact_position_correction(ContactBody* body_a, ContactBody* body_b, Vector3 normal,
+                                        float penetration_depth, float correction_percentage, float slop);
+
+static inline float contact_relative_velocity(const ContactBody* body_a, const ContactBody* body_b, Vector3 normal) {
+    Vector3 relative_velocity = vector3_subtract(*body_b->velocity, *body_a->velocity);
+    return vector3_dot(relative_velocity, normal);
+}
+
+static inline float contact_impulse_magnitude(const ContactBody* body_a, const ContactBody* body_b, Vector3 normal,
+                                              float restitution) {
+    float relative_velocity = contact_relative_velocity(body_a, body_b, normal);
+    float total_inverse_mass = body_a->inverse_mass + body_b->inverse_mass;
+    
+    if (total_inverse_mass <= 0.0f) return 0.0f;  // Both bodies are static
+    
+    // Impulse magnitude = -(1 + e) * relative_velocity / total_inverse_mass
+    float impulse_magnitude = -(1.0f + restitution) * relative_velocity / total_inverse_mass;
+    
+    return impulse_magnitude;
+}
+
+ContactBody contact_body_from_rigid_body(RigidBody* body) {
+    ContactBody view;
+    view.position = &body->position;
+    view.velocity = &body->velocity;
+    view.inverse_mass = body->inverse_mass;
+    view.restitution = body->restitution;
+    view.friction = body->friction;
+    view.is_static = body->is_static;
+    return view;
+}
+
+void resolve_contact(ContactBody* body_a, ContactBody* body_b, Contact* contact) {
+    if (!body_a || !body_b || !contact) return;
+    
+    Vector3 normal = contact->normal;
+    float penetration_depth = contact->penetration_depth;
     
     // First, separate the bodies to prevent overlap
-    separate_bodies(collision);
+    contact_separate(body_a, body_b, normal, penetration_depth);
     
     // Then apply impulse response to handle velocities
-    apply_impulse_response(collision);
+    contact->normal_impulse = contact_apply_impulse(body_a, body_b, normal);
     
     // Apply friction
-    apply_friction(collision);
+    contact->tangent_impulse = contact_apply_friction(body_a, body_b, normal);
     
     // Apply position correction to prevent floating point drift
-    position_correction(collision, 0.8f, 0.01f);
+    contact_position_correction(body_a, body_b, normal, penetration_depth, 0.8f, 0.01f);
 }
 
-void separate_bodies(CollisionInfo* collision) {
-    RigidBody* body_a = collision->body_a;
-    RigidBody* body_b = collision->body_b;
+// Add impulse to B's velocity and subtract it from A's, scaled by inverse mass
+static inline void contact_apply_impulse_pair(ContactBody* body_a, ContactBody* body_b, Vector3 impulse) {
+    if (!body_a->is_static) {
+        *body_a->velocity = vector3_subtract(*body_a->velocity, vector3_scale(impulse, body_a->inverse_mass));
+    }
+    if (!body_b->is_static) {
+        *body_b->velocity = vector3_add(*body_b->velocity, vector3_scale(impulse, body_b->inverse_mass));
+    }
+}
+
+void contact_constraint_prepare(const ContactBody* body_a, const ContactBody* body_b, const Contact* contact,
+                                float dt, ContactConstraint* constraint) {
+    float total_inverse_mass = body_a->inverse_mass + body_b->inverse_mass;
+    constraint->normal_mass = total_inverse_mass > 0.0f ? 1.0f / total_inverse_mass : 0.0f;
+    constraint->friction = sqrtf(body_a->friction * body_b->friction);
+    
+    // Restitution targets a fraction of the approach speed at first contact
+    float approach = contact_relative_velocity(body_a, body_b, contact->normal);
+    float restitution = fminf(body_a->restitution, body_b->restitution);
+    float bounce = approach < -CONTACT_BOUNCE_THRESHOLD ? -restitution * approach : 0.0f;
+    
+    // Bodies still apart may keep approaching until the gap closes. A bounce
+    // due when the gap closes within dt is applied now, up to a step early.
+    float gap = -contact->penetration_depth;
+    if (gap > 0.0f && dt > 0.0f) {
+        float closing = -gap / dt;
+        constraint->target_velocity = (bounce > 0.0f && approach < closing) ? bounce : closing;
+    } else {
+        constraint->target_velocity = bounce;
+    }
+}
+
+void contact_constraint_warm_start(ContactBody* body_a, ContactBody* body_b, const Contact* contact,
+                                   const ContactConstraint* constraint) {
+    Vector3 impulse = vector3_add(vector3_scale(contact->normal, constraint->normal_impulse),
+                                  constraint->tangent_impulse);
+    contact_apply_impulse_pair(body_a, body_b, impulse);
+}
+
+void contact_constraint_solve(ContactBody* body_a, ContactBody* body_b, const Contact* contact,
+                              ContactConstraint* constraint) {
+    if (constraint->normal_mass <= 0.0f) return;  // Both bodies are static
+    
+    Vector3 normal = contact->normal;
+    
+    // Normal: drive the separating speed to the target, never pulling
+    float normal_velocity = contact_relative_velocity(body_a, body_b, normal);
+    float lambda = constraint->normal_mass * (constraint->target_velocity - normal_velocity);
+    float normal_impulse = fmaxf(constraint->normal_impulse + lambda, 0.0f);
+    lambda = normal_impulse - constraint->normal_impulse;
+    constraint->normal_impulse = normal_impulse;
+    contact_apply_impulse_pair(body_a, body_b, vector3_scale(normal, lambda));
+    
+    // Friction: stop the sliding, within the cone set by the normal impulse
+    Vector3 relative_velocity = vector3_subtract(*body_b->velocity, *body_a->velocity);
+    Vector3 sliding = vector3_subtract(relative_velocity, vector3_scale(normal, vector3_dot(relative_velocity, normal)));
+    Vector3 tangent_impulse = vector3_subtract(constraint->tangent_impulse,
+                                               vector3_scale(sliding, constraint->normal_mass));
+    
+    float max_friction = constraint->friction * normal_impulse;
+    float length_sq = vector3_length_squared(tangent_impulse);
+    if (length_sq > max_friction * max_friction) {
+        tangent_impulse = length_sq > 0.0f ? vector3_scale(tangent_impulse, max_friction / sqrtf(length_sq))
+                                           : vector3_zero();
+    }
+    
+    Vector3 delta = vector3_subtract(tangent_impulse, constraint->tangent_impulse);
+    constraint->tangent_impulse = tangent_impulse;
+    contact_apply_impulse_pair(body_a, body_b, delta);
+}
+
+void contact_correct_position(ContactBody* body_a, ContactBody* body_b, const Contact* contact) {
+    contact_position_correction(body_a, body_b, contact->normal, contact->penetration_depth,
+                                CONTACT_CORRECTION_PERCENTAGE, CONTACT_CORRECTION_SLOP);
+}
+
+void resolve_collision(CollisionInfo* collision) {
+    if (!collision || !collision->has_collision) return;
+    if (!collision->body_a || !collision->body_b) return;
+    
+    Contact contact;
+    contact.normal = collision->normal;
+    contact.penetration_depth = collision->penetration_depth;
     
-    if (!body_a || !body_b) return;
+    ContactBody body_a = contact_body_from_rigid_body(collision->body_a);
+    ContactBody body_b = contact_body_from_rigid_body(collision->body_b);
+    resolve_contact(&body_a, &body_b, &contact);
+}
+
+void separate_bodies(CollisionInfo* collision) {
+    if (!collision->body_a || !collision->body_b) return;
     
+    ContactBody body_a = contact_body_from_rigid_body(collision->body_a);
+    ContactBody body_b = contact_body_from_rigid_body(collision->body_b);
+    contact_separate(&body_a, &body_b, collision->normal, collision->penetration_depth);
+}
+
+static void contact_separate(ContactBody* body_a, ContactBody* body_b, Vector3 normal, float penetration_depth) {
     float total_inverse_mass = body_a->inverse_mass + body_b->inverse_mass;
     if (total_inverse_mass <= 0.0f) return;  // Both bodies are static
     
@@ -29,67 +160,74 @@ void separate_bodies(CollisionInfo* collision) {
     float separation_a = body_a->inverse_mass / total_inverse_mass;
     float separation_b = body_b->inverse_mass / total_inverse_mass;
     
-    Vector3 separation_vector = vector3_scale(collision->normal, collision->penetration_depth);
+    Vector3 separation_vector = vector3_scale(normal, penetration_depth);
     
     // Move bodies apart
     if (!body_a->is_static) {
         Vector3 move_a = vector3_scale(separation_vector, -separation_a);
-        body_a->position = vector3_add(body_a->position, move_a);
+        *body_a->position = vector3_add(*body_a->position, move_a);
     }
     
     if (!body_b->is_static) {
         Vector3 move_b = vector3_scale(separation_vector, separation_b);
-        body_b->position = vector3_add(body_b->position, move_b);
+        *body_b->position = vector3_add(*body_b->position, move_b);
     }
 }
 
 void apply_impulse_response(CollisionInfo* collision) {
-    RigidBody* body_a = collision->body_a;
-    RigidBody* body_b = collision->body_b;
-    
-    if (!body_a || !body_b) return;
+    if (!collision->body_a || !collision->body_b) return;
     
-    float relative_velocity = calculate_relative_velocity(collision);
+    ContactBody body_a = contact_body_from_rigid_body(collision->body_a);
+    ContactBody body_b = contact_body_from_rigid_body(collision->body_b);
+    contact_apply_impulse(&body_a, &body_b, collision->normal);
+}
+
+static float contact_apply_impulse(ContactBody* body_a, ContactBody* body_b, Vector3 normal) {
+    float relative_velocity = contact_relative_velocity(body_a, body_b, normal);
     
     // Don't resolve if velocities are separating
-    if (relative_velocity > 0.0f) return;
+    if (relative_velocity > 0.0f) return 0.0f;
     
     // Calculate restitution (combine restitution of both bodies)
     float restitution = fminf(body_a->restitution, body_b->restitution);
     
     // Calculate impulse magnitude
-    float impulse_magnitude = calculate_impulse_magnitude(collision, restitution);
+    float impulse_magnitude = contact_impulse_magnitude(body_a, body_b, normal, restitution);
     
     // Apply impulse
-    Vector3 impulse = vector3_scale(collision->normal, impulse_magnitude);
+    Vector3 impulse = vector3_scale(normal, impulse_magnitude);
     
     if (!body_a->is_static) {
         Vector3 impulse_a = vector3_scale(impulse, -body_a->inverse_mass);
-        body_a->velocity = vector3_add(body_a->velocity, impulse_a);
+        *body_a->velocity = vector3_add(*body_a->velocity, impulse_a);
     }
     
     if (!body_b->is_static) {
         Vector3 impulse_b = vector3_scale(impulse, body_b->inverse_mass);
-        body_b->velocity = vector3_add(body_b->velocity, impulse_b);
+        *body_b->velocity = vector3_add(*body_b->velocity, impulse_b);
     }
+    
+    return impulse_magnitude;
 }
 
 void apply_friction(CollisionInfo* collision) {
-    RigidBody* body_a = collision->body_a;
-    RigidBody* body_b = collision->body_b;
-    
-    if (!body_a || !body_b) return;
+    if (!collision->body_a || !collision->body_b) return;
     
+    ContactBody body_a = contact_body_from_rigid_body(collision->body_a);
+    ContactBody body_b = contact_body_from_rigid_body(collision->body_b);
+    contact_apply_friction(&body_a, &body_b, collision->normal);
+}
+
+static float contact_apply_friction(ContactBody* body_a, ContactBody* body_b, Vector3 normal) {
     // Calculate relative velocity at contact point
-    Vector3 relative_velocity_vec = vector3_subtract(body_b->velocity, body_a->velocity);
+    Vector3 relative_velocity_vec = vector3_subtract(*body_b->velocity, *body_a->velocity);
     
     // Calculate tangent vector (perpendicular to normal in the plane of contact)
-    Vector3 normal = collision->normal;
     float relative_velocity_normal = vector3_dot(relative_velocity_vec, normal);
     Vector3 tangent = vector3_subtract(relative_velocity_vec, vector3_scale(normal, relative_velocity_normal));
     
     float tangent_length = vector3_length(tangent);
-    if (tangent_length < VECTOR_EPSILON) return;  // No tangential motion
+    if (tangent_length < VECTOR_EPSILON) return 0.0f;  // No tangential motion
     
     tangent = vector3_normalize(tangent);
     
@@ -98,12 +236,12 @@ void apply_friction(CollisionInfo* collision) {
     
     // Calculate friction impulse magnitude
     float total_inverse_mass = body_a->inverse_mass + body_b->inverse_mass;
-    if (total_inverse_mass <= 0.0f) return;
+    if (total_inverse_mass <= 0.0f) return 0.0f;
     
     float friction_impulse_magnitude = -vector3_dot(relative_velocity_vec, tangent) / total_inverse_mass;
     
     // Clamp friction impulse to Coulomb friction model
-    float normal_impulse_magnitude = calculate_impulse_magnitude(collision, 0.0f);  // No restitution for friction calculation
+    float normal_impulse_magnitude = contact_impulse_magnitude(body_a, body_b, normal, 0.0f);  // No restitution for friction calculation
     float max_friction_impulse = friction_coefficient * fabsf(normal_impulse_magnitude);
     
     if (fabsf(friction_impulse_magnitude) > max_friction_impulse) {
@@ -115,13 +253,15 @@ void apply_friction(CollisionInfo* collision) {
     // Apply friction impulse
     if (!body_a->is_static) {
         Vector3 friction_a = vector3_scale(friction_impulse, -body_a->inverse_mass);
-        body_a->velocity = vector3_add(body_a->velocity, friction_a);
+        *body_a->velocity = vector3_add(*body_a->velocity, friction_a);
     }
     
     if (!body_b->is_static) {
         Vector3 friction_b = vector3_scale(friction_impulse, body_b->inverse_mass);
-        body_b->velocity = vector3_add(body_b->velocity, friction_b);
+        *body_b->velocity = vector3_add(*body_b->velocity, friction_b);
     }
+    
+    return fabsf(friction_impulse_magnitude);
 }
 
 float calculate_relative_velocity(CollisionInfo* collision) {
@@ -135,22 +275,12 @@ float calculate_relative_velocity(CollisionInfo* collision) {
 }
 
 float calculate_impulse_magnitude(CollisionInfo* collision, float restitution) {
-    RigidBody* body_a = collision->body_a;
-    RigidBody* body_b = collision->body_b;
-    
-    if (!body_a || !body_b) return 0.0f;
-    
-    float relative_velocity = calculate_relative_velocity(collision);
-    float total_inverse_mass = body_a->inverse_mass + body_b->inverse_mass;
-    
-    if (total_inverse_mass <= 0.0f) return 0.0f;  // Both bodies are static
+    if (!collision->body_a || !collision->body_b) return 0.0f;
     
-    // Impulse magnitude = -(1 + e) * relative_velocity / total_inverse_mass
-    float impulse_magnitude = -(1.0f + restitution) * relative_velocity / total_inverse_mass;
-    
-    return impulse_magnitude;
+    ContactBody body_a = contact_body_from_rigid_body(collision->body_a);
+    ContactBody body_b = contact_body_from_rigid_body(collision->body_b);
+    return contact_impulse_magnitude(&body_a, &body_b, collision->normal, restitution);
 }
-
 Vector3 calculate_friction_impulse(CollisionInfo* collision, float friction_coefficient) {
     RigidBody* body_a = collision->body_a;
     RigidBody* body_b = collision->body_b;
@@ -187,28 +317,33 @@ Vector3 calculate_friction_impulse(CollisionInfo* collision, float friction_coef
 }
 
 void position_correction(CollisionInfo* collision, float correction_percentage, float slop) {
-    RigidBody* body_a = collision->body_a;
-    RigidBody* body_b = collision->body_b;
-    
-    if (!body_a || !body_b) return;
+    if (!collision->body_a || !collision->body_b) return;
     
+    ContactBody body_a = contact_body_from_rigid_body(collision->body_a);
+    ContactBody body_b = contact_body_from_rigid_body(collision->body_b);
+    contact_position_correction(&body_a, &body_b, collision->normal, collision->penetration_depth,
+                                correction_percentage, slop);
+}
+
+static void contact_position_correction(ContactBody* body_a, ContactBody* body_b, Vector3 normal,
+                                        float penetration_depth, float correction_percentage, float slop) {
     float total_inverse_mass = body_a->inverse_mass + body_b->inverse_mass;
     if (total_inverse_mass <= 0.0f) return;
     
     // Only apply correction if penetration is significant
-    float penetration = collision->penetration_depth - slop;
+    float penetration = penetration_depth - slop;
     if (penetration <= 0.0f) return;
     
     float correction_magnitude = penetration * correction_percentage / total_inverse_mass;
-    Vector3 correction = vector3_scale(collision->normal, correction_magnitude);
+    Vector3 correction = vector3_scale(normal, correction_magnitude);
     
     if (!body_a->is_static) {
         Vector3 correction_a = vector3_scale(correction, -body_a->inverse_mass);
-        body_a->position = vector3_add(body_a->position, correction_a);
+        *body_a->position = vector3_add(*body_a->position, correction_a);
     }
     
     if (!body_b->is_static) {
         Vector3 correction_b = vector3_scale(correction, body_b->inverse_mass);
-        body_b->position = vector3_add(body_b->position, correction_b);
+        *body_b->position = vector3_add(*body_b->position, correction_b);
     }
 }
\ No newline at end of file
@@ -0,0 +1,110 @@
+#include "../include/command_queue.h"
+#include "../include/allocator.h"
+#include <stdint.h>
+#include <string.h>
+
+// C99 has no atomics; these are the GCC/Clang builtins with the C11 memory model
+#define queue_load_relaxed(p)   __atomic_load_n((p), __ATOMIC_RELAXED)
+#define queue_load_acquire(p)   __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define queue_store_release(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+
+bool command_queue_init(CommandQueue* queue, int capacity) {
+    if (!queue) return false;
+
+    memset(queue, 0, sizeof(CommandQueue));
+    if (capacity < 2) capacity = 2;
+
+    size_t size = 2;
+    while (size < (size_t)capacity) {
+        size *= 2;
+    }
+
+    // Cells are allocated by the first push, so idle queues cost nothing
+    queue->mask = size - 1;
+    return true;
+}
+
+void command_queue_destroy(CommandQueue* queue) {
+    if (!queue) return;
+
+    if (queue->cells) {
+        physics_free_aligned(queue->cells, (queue->mask + 1) * sizeof(CommandCell), COMMAND_QUEUE_CACHE_LINE);
+    }
+    memset(queue, 0, sizeof(CommandQueue));
+}
+
+int command_queue_get_capacity(const CommandQueue* queue) {
+    return queue ? (int)(queue->mask + 1) : 0;
+}
+
+// Cells for producers, allocating them on first use. Racing producers each
+// build a ring; the first to install its own wins and the rest free theirs.
+static CommandCell* command_queue_cells(CommandQueue* queue) {
+    CommandCell* cells = queue_load_acquire(&queue->cells);
+    if (cells) return cells;
+
+    size_t size = queue->mask + 1;
+    CommandCell* fresh = (CommandCell*)physics_alloc_aligned(size * sizeof(CommandCell), COMMAND_QUEUE_CACHE_LINE);
+    if (!fresh) return NULL;
+
+    // Cell i is free for the producer that claims position i
+    for (size_t i = 0; i < size; i++) {
+        fresh[i].sequence = i;
+    }
+
+    if (__atomic_compare_exchange_n(&queue->cells, &cells, fresh, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+        return fresh;
+    }
+    physics_free_aligned(fresh, size * sizeof(CommandCell), COMMAND_QUEUE_CACHE_LINE);
+    return cells;
+}
+
+bool command_queue_push(CommandQueue* queue, const BodyCommand* command) {
+    if (!queue || !command) return false;
+
+    CommandCell* cells = command_queue_cells(queue);
+    if (!cells) return false;
+
+    size_t pos = queue_load_relaxed(&queue->enqueue_pos);
+    CommandCell* cell;
+    for (;;) {
+        cell = &cells[pos & queue->mask];
+        size_t sequence = queue_load_acquire(&cell->sequence);
+        intptr_t lag = (intptr_t)sequence - (intptr_t)pos;
+
+        if (lag == 0) {
+            // Cell is free for this position; claim it unless another producer got there first
+            if (__atomic_compare_exchange_n(&queue->enqueue_pos, &pos, pos + 1, true,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                break;
+            }
+        } else if (lag < 0) {
+            // The consumer has not yet emptied this cell from the previous lap
+            return false;
+        } else {
+            pos = queue_load_relaxed(&queue->enqueue_pos);
+        }
+    }
+
+    cell->command = *command;
+    queue_store_release(&cell->sequence, pos + 1);
+    return true;
+}
+
+bool command_queue_pop(CommandQueue* queue, BodyCommand* command) {
+    if (!queue || !command) return false;
+
+    CommandCell* cells = queue_load_acquire(&queue->cells);
+    if (!cells) return false;
+
+    size_t pos = queue->dequeue_pos;
+    CommandCell* cell = &cells[pos & queue->mask];
+    if (queue_load_acquire(&cell->sequence) != pos + 1) return false;
+
+    *command = cell->command;
+
+    // Hand the cell to the producer that will claim it on the next lap
+    queue_store_release(&cell->sequence, pos + queue->mask + 1);
+    queue->dequeue_pos = pos + 1;
+    return true;
+}
@@ -0,0 +1,116 @@
+#include "../include/contact_cache.h"
+#include "../include/allocator.h"
+#include <string.h>
+
+static inline uint32_t contact_cache_hash(ContactCacheKey key) {
+    uint64_t h = key.slots ^ (key.generations * 0x9e3779b97f4a7c15ull);
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    return (uint32_t)h;
+}
+
+static inline bool contact_cache_key_equal(ContactCacheKey a, ContactCacheKey b) {
+    return a.slots == b.slots && a.generations == b.generations;
+}
+
+static void contact_cache_table_free(ContactCacheTable* table) {
+    physics_free(table->entries, (size_t)table->capacity * sizeof(ContactCacheEntry));
+    memset(table, 0, sizeof(ContactCacheTable));
+}
+
+void contact_cache_init(ContactCache* cache) {
+    if (cache) {
+        memset(cache, 0, sizeof(ContactCache));
+    }
+}
+
+void contact_cache_destroy(ContactCache* cache) {
+    if (!cache) return;
+
+    contact_cache_table_free(&cache->tables[0]);
+    contact_cache_table_free(&cache->tables[1]);
+    contact_cache_init(cache);
+}
+
+void contact_cache_clear(ContactCache* cache) {
+    if (!cache) return;
+
+    for (int t = 0; t < 2; t++) {
+        ContactCacheTable* table = &cache->tables[t];
+        for (int i = 0; i < table->capacity; i++) {
+            table->entries[i].key.slots = CONTACT_CACHE_EMPTY;
+        }
+        table->count = 0;
+    }
+}
+
+bool contact_cache_begin(ContactCache* cache, int contact_count) {
+    if (!cache) return false;
+
+    // Keep the load factor at or below one half
+    ContactCacheTable* table = &cache->tables[1 - cache->previous];
+    int capacity = table->capacity > 0 ? table->capacity : 16;
+    while (capacity < contact_count * 2) {
+        capacity *= 2;
+    }
+
+    int previous_capacity = table->capacity;
+    if (capacity != table->capacity) {
+        contact_cache_table_free(table);
+        table->entries = (ContactCacheEntry*)physics_alloc((size_t)capacity * sizeof(ContactCacheEntry));
+        if (!table->entries) return false;
+        table->capacity = capacity;
+    }
+
+    // A table that was freshly allocated or already emptied needs no clearing
+    if (table->count > 0 || capacity != previous_capacity) {
+        for (int i = 0; i < capacity; i++) {
+            table->entries[i].key.slots = CONTACT_CACHE_EMPTY;
+        }
+    }
+    table->count = 0;
+    return true;
+}
+
+const ContactCacheEntry* contact_cache_find(const ContactCache* cache, ContactCacheKey key) {
+    const ContactCacheTable* table = &cache->tables[cache->previous];
+    if (table->count == 0) return NULL;
+
+    uint32_t mask = (uint32_t)(table->capacity - 1);
+    uint32_t probe = contact_cache_hash(key) & mask;
+
+    while (table->entries[probe].key.slots != CONTACT_CACHE_EMPTY) {
+        if (contact_cache_key_equal(table->entries[probe].key, key)) return &table->entries[probe];
+        probe = (probe + 1) & mask;
+    }
+    return NULL;
+}
+
+void contact_cache_store(ContactCache* cache, ContactCacheKey key, float normal_impulse, Vector3 tangent_impulse) {
+    ContactCacheTable* table = &cache->tables[1 - cache->previous];
+    if (table->count * 2 >= table->capacity) return;
+
+    uint32_t mask = (uint32_t)(table->capacity - 1);
+    uint32_t probe = contact_cache_hash(key) & mask;
+
+    // A pair only has one contact per solve, but keep the latest if it repeats
+    while (table->entries[probe].key.slots != CONTACT_CACHE_EMPTY &&
+           !contact_cache_key_equal(table->entries[probe].key, key)) {
+        probe = (probe + 1) & mask;
+    }
+
+    ContactCacheEntry* entry = &table->entries[probe];
+    if (entry->key.slots == CONTACT_CACHE_EMPTY) {
+        entry->key = key;
+        table->count++;
+    }
+    entry->normal_impulse = normal_impulse;
+    entry->tangent_impulse = tangent_impulse;
+}
+
+void contact_cache_end(ContactCache* cache) {
+    if (cache) {
+        cache->previous = 1 - cache->previous;
+    }
+}
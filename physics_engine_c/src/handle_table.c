@@ -0,0 +1,260 @@
+#include "../include/handle_table.h"
+#include "../include/allocator.h"
+#include <limits.h>
+#include <string.h>
+
+#define BODY_ID_MAP_EMPTY     INT_MIN
+#define BODY_ID_MAP_TOMBSTONE (INT_MIN + 1)
+
+void handle_table_init(HandleTable* table) {
+    if (!table) return;
+
+    memset(table, 0, sizeof(HandleTable));
+    table->free_head = -1;
+}
+
+void handle_table_destroy(HandleTable* table) {
+    if (!table) return;
+
+    physics_free(table->dense, (size_t)table->slot_capacity * sizeof(int));
+    physics_free(table->generations, (size_t)table->slot_capacity * sizeof(uint32_t));
+    physics_free(table->slots, (size_t)table->body_capacity * sizeof(int));
+    handle_table_init(table);
+}
+
+void handle_table_clear(HandleTable* table) {
+    if (!table) return;
+
+    // Retire every live slot so handles issued before the clear go stale
+    for (int i = 0; i < table->body_count; i++) {
+        int slot = table->slots[i];
+        table->generations[slot]++;
+        table->dense[slot] = table->free_head;
+        table->free_head = slot;
+    }
+
+    table->body_count = 0;
+}
+
+bool handle_table_reserve(HandleTable* table, int body_capacity) {
+    if (!table) return false;
+
+    // Every body owns one slot, so slots never outnumber bodies plus free entries
+    int slot_capacity = table->slot_capacity;
+    if (!physics_ensure_capacity((void**)&table->dense, &slot_capacity, body_capacity, sizeof(int))) return false;
+
+    slot_capacity = table->slot_capacity;
+    if (!physics_ensure_capacity((void**)&table->generations, &slot_capacity, body_capacity, sizeof(uint32_t))) {
+        return false;
+    }
+    table->slot_capacity = slot_capacity;
+
+    return physics_ensure_capacity((void**)&table->slots, &table->body_capacity, body_capacity, sizeof(int));
+}
+
+BodyHandle handle_table_insert(HandleTable* table) {
+    if (!table || !handle_table_reserve(table, table->body_count + 1)) return body_handle_null();
+
+    int slot;
+    if (table->free_head >= 0) {
+        slot = table->free_head;
+        table->free_head = table->dense[slot];
+    } else {
+        slot = table->slot_count++;
+        table->generations[slot] = 1;
+    }
+
+    int body_index = table->body_count++;
+    table->dense[slot] = body_index;
+    table->slots[body_index] = slot;
+
+    BodyHandle handle = { (uint32_t)slot, table->generations[slot] };
+    return handle;
+}
+
+void handle_table_remove(HandleTable* table, int body_index) {
+    if (!table || body_index < 0 || body_index >= table->body_count) return;
+
+    int slot = table->slots[body_index];
+    int last = table->body_count - 1;
+
+    // The last body takes over the freed index
+    if (body_index != last) {
+        int moved_slot = table->slots[last];
+        table->slots[body_index] = moved_slot;
+        table->dense[moved_slot] = body_index;
+    }
+
+    table->generations[slot]++;
+    table->dense[slot] = table->free_head;
+    table->free_head = slot;
+    table->body_count--;
+}
+
+void handle_table_permute(HandleTable* table, const int* order, int* scratch) {
+    if (!table || !order || !scratch) return;
+
+    for (int i = 0; i < table->body_count; i++) {
+        scratch[i] = table->slots[order[i]];
+    }
+
+    // Slots and generations stay put; only the body index behind each slot moves
+    for (int i = 0; i < table->body_count; i++) {
+        table->slots[i] = scratch[i];
+        table->dense[scratch[i]] = i;
+    }
+}
+
+int handle_table_lookup(const HandleTable* table, BodyHandle handle) {
+    if (!table || handle.slot >= (uint32_t)table->slot_count) return -1;
+    if (table->generations[handle.slot] != handle.generation) return -1;
+
+    return table->dense[handle.slot];
+}
+
+BodyHandle handle_table_get_handle(const HandleTable* table, int body_index) {
+    if (!table || body_index < 0 || body_index >= table->body_count) return body_handle_null();
+
+    int slot = table->slots[body_index];
+    BodyHandle handle = { (uint32_t)slot, table->generations[slot] };
+    return handle;
+}
+
+static inline unsigned int hash_id(int id) {
+    return (unsigned int)id * 2654435761u;
+}
+
+void body_id_map_init(BodyIdMap* map) {
+    if (map) {
+        memset(map, 0, sizeof(BodyIdMap));
+    }
+}
+
+void body_id_map_destroy(BodyIdMap* map) {
+    if (!map) return;
+
+    physics_free(map->keys, (size_t)map->capacity * sizeof(int));
+    physics_free(map->values, (size_t)map->capacity * sizeof(int));
+    body_id_map_init(map);
+}
+
+void body_id_map_clear(BodyIdMap* map) {
+    if (!map) return;
+
+    for (int i = 0; i < map->capacity; i++) {
+        map->keys[i] = BODY_ID_MAP_EMPTY;
+    }
+    map->count = 0;
+    map->used = 0;
+}
+
+// Move every live key into fresh tables of the given capacity, dropping tombstones
+static bool body_id_map_rehash(BodyIdMap* map, int capacity) {
+    int* keys = (int*)physics_alloc((size_t)capacity * sizeof(int));
+    int* values = (int*)physics_alloc((size_t)capacity * sizeof(int));
+    if (!keys || !values) {
+        physics_free(keys, (size_t)capacity * sizeof(int));
+        physics_free(values, (size_t)capacity * sizeof(int));
+        return false;
+    }
+
+    for (int i = 0; i < capacity; i++) {
+        keys[i] = BODY_ID_MAP_EMPTY;
+    }
+
+    unsigned int mask = (unsigned int)(capacity - 1);
+    for (int i = 0; i < map->capacity; i++) {
+        int key = map->keys[i];
+        if (key == BODY_ID_MAP_EMPTY || key == BODY_ID_MAP_TOMBSTONE) continue;
+
+        unsigned int probe = hash_id(key) & mask;
+        while (keys[probe] != BODY_ID_MAP_EMPTY) {
+            probe = (probe + 1) & mask;
+        }
+        keys[probe] = key;
+        values[probe] = map->values[i];
+    }
+
+    physics_free(map->keys, (size_t)map->capacity * sizeof(int));
+    physics_free(map->values, (size_t)map->capacity * sizeof(int));
+    map->keys = keys;
+    map->values = values;
+    map->capacity = capacity;
+    map->used = map->count;
+    return true;
+}
+
+bool body_id_map_reserve(BodyIdMap* map, int count) {
+    if (!map) return false;
+
+    // Keep the load factor, tombstones included, at or below one half
+    int extra = count > map->count ? count - map->count : 0;
+    if ((map->used + extra) * 2 <= map->capacity) return true;
+
+    int capacity = 16;
+    while (capacity < count * 2) {
+        capacity *= 2;
+    }
+    return body_id_map_rehash(map, capacity);
+}
+
+bool body_id_map_insert(BodyIdMap* map, int id, int slot) {
+    if (!map || id == BODY_ID_MAP_EMPTY || id == BODY_ID_MAP_TOMBSTONE) return false;
+    if (!body_id_map_reserve(map, map->count + 1)) return false;
+
+    unsigned int mask = (unsigned int)(map->capacity - 1);
+    unsigned int probe = hash_id(id) & mask;
+    int tombstone = -1;
+
+    while (map->keys[probe] != BODY_ID_MAP_EMPTY) {
+        if (map->keys[probe] == id) {
+            map->values[probe] = slot;
+            return true;
+        }
+        if (map->keys[probe] == BODY_ID_MAP_TOMBSTONE && tombstone < 0) {
+            tombstone = (int)probe;
+        }
+        probe = (probe + 1) & mask;
+    }
+
+    if (tombstone >= 0) {
+        probe = (unsigned int)tombstone;
+    } else {
+        map->used++;
+    }
+
+    map->keys[probe] = id;
+    map->values[probe] = slot;
+    map->count++;
+    return true;
+}
+
+int body_id_map_find(const BodyIdMap* map, int id) {
+    if (!map || map->capacity == 0 || id == BODY_ID_MAP_EMPTY || id == BODY_ID_MAP_TOMBSTONE) return -1;
+
+    unsigned int mask = (unsigned int)(map->capacity - 1);
+    unsigned int probe = hash_id(id) & mask;
+
+    while (map->keys[probe] != BODY_ID_MAP_EMPTY) {
+        if (map->keys[probe] == id) return map->values[probe];
+        probe = (probe + 1) & mask;
+    }
+
+    return -1;
+}
+
+void body_id_map_remove(BodyIdMap* map, int id) {
+    if (!map || map->capacity == 0 || id == BODY_ID_MAP_EMPTY || id == BODY_ID_MAP_TOMBSTONE) return;
+
+    unsigned int mask = (unsigned int)(map->capacity - 1);
+    unsigned int probe = hash_id(id) & mask;
+
+    while (map->keys[probe] != BODY_ID_MAP_EMPTY) {
+        if (map->keys[probe] == id) {
+            map->keys[probe] = BODY_ID_MAP_TOMBSTONE;
+            map->count--;
+            return;
+        }
+        probe = (probe + 1) & mask;
+    }
+}
@@ -1,129 +1,156 @@
 #include "../include/integration.h"
 
-void update_acceleration(RigidBody* body) {
-    if (!body || body->is_static) return;
-    
+// Pointers to the motion state of one body, wherever that state is stored
+typedef struct {
+    Vector3* position;
+    Vector3* velocity;
+    Vector3* acceleration;
+    Vector3* rotation;
+    Vector3* angular_velocity;
+    Vector3* angular_acceleration;
+    Vector3* force;
+    Vector3* torque;
+    float inverse_mass;
+} MotionState;
+
+static inline MotionState motion_state_from_body(RigidBody* body) {
+    MotionState state;
+    state.position = &body->position;
+    state.velocity = &body->velocity;
+    state.acceleration = &body->acceleration;
+    state.rotation = &body->rotation;
+    state.angular_velocity = &body->angular_velocity;
+    state.angular_acceleration = &body->angular_acceleration;
+    state.force = &body->force_accumulator;
+    state.torque = &body->torque_accumulator;
+    state.inverse_mass = body->inverse_mass;
+    return state;
+}
+
+static inline MotionState motion_state_from_pool(BodyPool* pool, int index) {
+    MotionState state;
+    state.position = &pool->position[index];
+    state.velocity = &pool->velocity[index];
+    state.acceleration = &pool->acceleration[index];
+    state.rotation = &pool->rotation[index];
+    state.angular_velocity = &pool->angular_velocity[index];
+    state.angular_acceleration = &pool->angular_acceleration[index];
+    state.force = &pool->force[index];
+    state.torque = &pool->torque[index];
+    state.inverse_mass = pool->inverse_mass[index];
+    return state;
+}
+
+static inline void motion_update_acceleration(MotionState* state) {
     // Calculate linear acceleration from forces: a = F/m
-    body->acceleration = vector3_scale(body->force_accumulator, body->inverse_mass);
+    *state->acceleration = vector3_scale(*state->force, state->inverse_mass);
     
     // For angular acceleration, we'd need the inertia tensor
     // For now, use a simplified approach
-    body->angular_acceleration = vector3_scale(body->torque_accumulator, body->inverse_mass);
+    *state->angular_acceleration = vector3_scale(*state->torque, state->inverse_mass);
 }
 
-void integrate_euler(RigidBody* body, float dt) {
-    if (!body || body->is_static || body->is_sleeping) return;
-    
+static void motion_euler(MotionState* state, float dt) {
     // Update acceleration from accumulated forces
-    update_acceleration(body);
+    motion_update_acceleration(state);
     
     // Integrate velocity: v = v + a * dt
-    Vector3 velocity_change = vector3_scale(body->acceleration, dt);
-    body->velocity = vector3_add(body->velocity, velocity_change);
+    Vector3 velocity_change = vector3_scale(*state->acceleration, dt);
+    *state->velocity = vector3_add(*state->velocity, velocity_change);
     
-    Vector3 angular_velocity_change = vector3_scale(body->angular_acceleration, dt);
-    body->angular_velocity = vector3_add(body->angular_velocity, angular_velocity_change);
+    Vector3 angular_velocity_change = vector3_scale(*state->angular_acceleration, dt);
+    *state->angular_velocity = vector3_add(*state->angular_velocity, angular_velocity_change);
     
     // Integrate position: p = p + v * dt
-    Vector3 position_change = vector3_scale(body->velocity, dt);
-    body->position = vector3_add(body->position, position_change);
-    
-    Vector3 rotation_change = vector3_scale(body->angular_velocity, dt);
-    body->rotation = vector3_add(body->rotation, rotation_change);
+    Vector3 position_change = vector3_scale(*state->velocity, dt);
+    *state->position = vector3_add(*state->position, position_change);
     
-    // Clear force accumulators for next frame
-    rigid_body_clear_forces(body);
+    Vector3 rotation_change = vector3_scale(*state->angular_velocity, dt);
+    *state->rotation = vector3_add(*state->rotation, rotation_change);
 }
 
-void integrate_verlet(RigidBody* body, float dt) {
-    if (!body || body->is_static || body->is_sleeping) return;
-    
+static void motion_verlet(MotionState* state, float dt) {
     // Store previous acceleration
-    Vector3 prev_acceleration = body->acceleration;
-    Vector3 prev_angular_acceleration = body->angular_acceleration;
+    Vector3 prev_acceleration = *state->acceleration;
+    Vector3 prev_angular_acceleration = *state->angular_acceleration;
     
     // Update acceleration from current forces
-    update_acceleration(body);
+    motion_update_acceleration(state);
     
     // Verlet integration for position: 
     // x(t+dt) = x(t) + v(t)*dt + 0.5*a(t)*dt^2
-    Vector3 velocity_term = vector3_scale(body->velocity, dt);
-    Vector3 acceleration_term = vector3_scale(body->acceleration, 0.5f * dt * dt);
-    body->position = vector3_add(body->position, vector3_add(velocity_term, acceleration_term));
+    Vector3 velocity_term = vector3_scale(*state->velocity, dt);
+    Vector3 acceleration_term = vector3_scale(*state->acceleration, 0.5f * dt * dt);
+    *state->position = vector3_add(*state->position, vector3_add(velocity_term, acceleration_term));
     
     // Verlet integration for rotation
-    Vector3 angular_velocity_term = vector3_scale(body->angular_velocity, dt);
-    Vector3 angular_acceleration_term = vector3_scale(body->angular_acceleration, 0.5f * dt * dt);
-    body->rotation = vector3_add(body->rotation, vector3_add(angular_velocity_term, angular_acceleration_term));
+    Vector3 angular_velocity_term = vector3_scale(*state->angular_velocity, dt);
+    Vector3 angular_acceleration_term = vector3_scale(*state->angular_acceleration, 0.5f * dt * dt);
+    *state->rotation = vector3_add(*state->rotation, vector3_add(angular_velocity_term, angular_acceleration_term));
     
     // Update velocity using average of previous and current acceleration:
     // v(t+dt) = v(t) + 0.5*(a(t) + a(t+dt))*dt
-    Vector3 avg_acceleration = vector3_scale(vector3_add(prev_acceleration, body->acceleration), 0.5f);
+    Vector3 avg_acceleration = vector3_scale(vector3_add(prev_acceleration, *state->acceleration), 0.5f);
     Vector3 velocity_change = vector3_scale(avg_acceleration, dt);
-    body->velocity = vector3_add(body->velocity, velocity_change);
+    *state->velocity = vector3_add(*state->velocity, velocity_change);
     
-    Vector3 avg_angular_acceleration = vector3_scale(vector3_add(prev_angular_acceleration, body->angular_acceleration), 0.5f);
+    Vector3 avg_angular_acceleration = vector3_scale(vector3_add(prev_angular_acceleration, *state->angular_acceleration), 0.5f);
     Vector3 angular_velocity_change = vector3_scale(avg_angular_acceleration, dt);
-    body->angular_velocity = vector3_add(body->angular_velocity, angular_velocity_change);
-    
-    // Clear force accumulators
-    rigid_body_clear_forces(body);
+    *state->angular_velocity = vector3_add(*state->angular_velocity, angular_velocity_change);
 }
 
-void integrate_rk4(RigidBody* body, float dt) {
-    if (!body || body->is_static || body->is_sleeping) return;
-    
+static void motion_rk4(MotionState* state, float dt) {
     // RK4 is more complex and computationally expensive
     // For a physics engine, Verlet is usually preferred
     // This is a simplified RK4 implementation
     
-    Vector3 initial_pos = body->position;
-    Vector3 initial_vel = body->velocity;
-    Vector3 initial_rot = body->rotation;
-    Vector3 initial_ang_vel = body->angular_velocity;
+    Vector3 initial_pos = *state->position;
+    Vector3 initial_vel = *state->velocity;
+    Vector3 initial_rot = *state->rotation;
+    Vector3 initial_ang_vel = *state->angular_velocity;
     
     // k1
-    update_acceleration(body);
-    Vector3 k1_vel = body->acceleration;
-    Vector3 k1_pos = body->velocity;
-    Vector3 k1_ang_vel = body->angular_acceleration;
-    Vector3 k1_rot = body->angular_velocity;
+    motion_update_acceleration(state);
+    Vector3 k1_vel = *state->acceleration;
+    Vector3 k1_pos = *state->velocity;
+    Vector3 k1_ang_vel = *state->angular_acceleration;
+    Vector3 k1_rot = *state->angular_velocity;
     
     // k2
-    body->position = vector3_add(initial_pos, vector3_scale(k1_pos, dt * 0.5f));
-    body->velocity = vector3_add(initial_vel, vector3_scale(k1_vel, dt * 0.5f));
-    body->rotation = vector3_add(initial_rot, vector3_scale(k1_rot, dt * 0.5f));
-    body->angular_velocity = vector3_add(initial_ang_vel, vector3_scale(k1_ang_vel, dt * 0.5f));
+    *state->position = vector3_add(initial_pos, vector3_scale(k1_pos, dt * 0.5f));
+    *state->velocity = vector3_add(initial_vel, vector3_scale(k1_vel, dt * 0.5f));
+    *state->rotation = vector3_add(initial_rot, vector3_scale(k1_rot, dt * 0.5f));
+    *state->angular_velocity = vector3_add(initial_ang_vel, vector3_scale(k1_ang_vel, dt * 0.5f));
     
-    update_acceleration(body);
-    Vector3 k2_vel = body->acceleration;
-    Vector3 k2_pos = body->velocity;
-    Vector3 k2_ang_vel = body->angular_acceleration;
-    Vector3 k2_rot = body->angular_velocity;
+    motion_update_acceleration(state);
+    Vector3 k2_vel = *state->acceleration;
+    Vector3 k2_pos = *state->velocity;
+    Vector3 k2_ang_vel = *state->angular_acceleration;
+    Vector3 k2_rot = *state->angular_velocity;
     
     // k3
-    body->position = vector3_add(initial_pos, vector3_scale(k2_pos, dt * 0.5f));
-    body->velocity = vector3_add(initial_vel, vector3_scale(k2_vel, dt * 0.5f));
-    body->rotation = vector3_add(initial_rot, vector3_scale(k2_rot, dt * 0.5f));
-    body->angular_velocity = vector3_add(initial_ang_vel, vector3_scale(k2_ang_vel, dt * 0.5f));
+    *state->position = vector3_add(initial_pos, vector3_scale(k2_pos, dt * 0.5f));
+    *state->velocity = vector3_add(initial_vel, vector3_scale(k2_vel, dt * 0.5f));
+    *state->rotation = vector3_add(initial_rot, vector3_scale(k2_rot, dt * 0.5f));
+    *state->angular_velocity = vector3_add(initial_ang_vel, vector3_scale(k2_ang_vel, dt * 0.5f));
     
-    update_acceleration(body);
-    Vector3 k3_vel = body->acceleration;
-    Vector3 k3_pos = body->velocity;
-    Vector3 k3_ang_vel = body->angular_acceleration;
-    Vector3 k3_rot = body->angular_velocity;
+    motion_update_acceleration(state);
+    Vector3 k3_vel = *state->acceleration;
+    Vector3 k3_pos = *state->velocity;
+    Vector3 k3_ang_vel = *state->angular_acceleration;
+    Vector3 k3_rot = *state->angular_velocity;
     
     // k4
-    body->position = vector3_add(initial_pos, vector3_scale(k3_pos, dt));
-    body->velocity = vector3_add(initial_vel, vector3_scale(k3_vel, dt));
-    body->rotation = vector3_add(initial_rot, vector3_scale(k3_rot, dt));
-    body->angular_velocity = vector3_add(initial_ang_vel, vector3_scale(k3_ang_vel, dt));
+    *state->position = vector3_add(initial_pos, vector3_scale(k3_pos, dt));
+    *state->velocity = vector3_add(initial_vel, vector3_scale(k3_vel, dt));
+    *state->rotation = vector3_add(initial_rot, vector3_scale(k3_rot, dt));
+    *state->angular_velocity = vector3_add(initial_ang_vel, vector3_scale(k3_ang_vel, dt));
     
-    update_acceleration(body);
-    Vector3 k4_vel = body->acceleration;
-    Vector3 k4_pos = body->velocity;
-    Vector3 k4_ang_vel = body->angular_acceleration;
-    Vector3 k4_rot = body->angular_velocity;
+    motion_update_acceleration(state);
+    Vector3 k4_vel = *state->acceleration;
+    Vector3 k4_pos = *state->velocity;
+    Vector3 k4_ang_vel = *state->angular_acceleration;
+    Vector3 k4_rot = *state->angular_velocity;
     
     // Final update
     Vector3 vel_change = vector3_scale(vector3_add(vector3_add(k1_vel, vector3_scale(k2_vel, 2.0f)), 
@@ -135,49 +162,106 @@ void integrate_rk4(RigidBody* body, float dt) {
     Vector3 rot_change = vector3_scale(vector3_add(vector3_add(k1_rot, vector3_scale(k2_rot, 2.0f)), 
                                                   vector3_add(vector3_scale(k3_rot, 2.0f), k4_rot)), dt / 6.0f);
     
-    body->position = vector3_add(initial_pos, pos_change);
-    body->velocity = vector3_add(initial_vel, vel_change);
-    body->rotation = vector3_add(initial_rot, rot_change);
-    body->angular_velocity = vector3_add(initial_ang_vel, ang_vel_change);
-    
-    // Clear force accumulators
-    rigid_body_clear_forces(body);
+    *state->position = vector3_add(initial_pos, pos_change);
+    *state->velocity = vector3_add(initial_vel, vel_change);
+    *state->rotation = vector3_add(initial_rot, rot_change);
+    *state->angular_velocity = vector3_add(initial_ang_vel, ang_vel_change);
 }
 
-void integrate_body(RigidBody* body, float dt, IntegrationMethod method) {
+static void motion_integrate(MotionState* state, float dt, IntegrationMethod method) {
     switch (method) {
         case INTEGRATION_EULER:
-            integrate_euler(body, dt);
-            break;
-        case INTEGRATION_VERLET:
-            integrate_verlet(body, dt);
+            motion_euler(state, dt);
             break;
         case INTEGRATION_RK4:
-            integrate_rk4(body, dt);
+            motion_rk4(state, dt);
             break;
+        case INTEGRATION_VERLET:
         default:
-            integrate_verlet(body, dt);  // Default to Verlet
+            motion_verlet(state, dt);  // Default to Verlet
             break;
     }
+    
+    // Clear force accumulators for next frame
+    *state->force = vector3_zero();
+    *state->torque = vector3_zero();
 }
 
-void apply_damping(RigidBody* body, float linear_damping, float angular_damping) {
-    if (!body || body->is_static) return;
-    
+static inline void motion_damp(Vector3* velocity, Vector3* angular_velocity, float linear_damping, float angular_damping) {
     // Apply linear damping: v = v * (1 - damping)
-    body->velocity = vector3_scale(body->velocity, 1.0f - linear_damping);
+    *velocity = vector3_scale(*velocity, 1.0f - linear_damping);
     
     // Apply angular damping
-    body->angular_velocity = vector3_scale(body->angular_velocity, 1.0f - angular_damping);
-    
-    // Put body to sleep if velocity is very low
-    float linear_speed_sq = vector3_length_squared(body->velocity);
-    float angular_speed_sq = vector3_length_squared(body->angular_velocity);
+    *angular_velocity = vector3_scale(*angular_velocity, 1.0f - angular_damping);
+}
+
+// Returns true when the body has come to rest and should sleep
+static inline bool motion_settle(Vector3* velocity, Vector3* angular_velocity) {
+    float linear_speed_sq = vector3_length_squared(*velocity);
+    float angular_speed_sq = vector3_length_squared(*angular_velocity);
     
     const float sleep_threshold = 0.01f;
     if (linear_speed_sq < sleep_threshold && angular_speed_sq < sleep_threshold) {
+        *velocity = vector3_zero();
+        *angular_velocity = vector3_zero();
+        return true;
+    }
+    
+    return false;
+}
+
+void update_acceleration(RigidBody* body) {
+    if (!body || body->is_static) return;
+    
+    MotionState state = motion_state_from_body(body);
+    motion_update_acceleration(&state);
+}
+
+void integrate_euler(RigidBody* body, float dt) {
+    integrate_body(body, dt, INTEGRATION_EULER);
+}
+
+void integrate_verlet(RigidBody* body, float dt) {
+    integrate_body(body, dt, INTEGRATION_VERLET);
+}
+
+void integrate_rk4(RigidBody* body, float dt) {
+    integrate_body(body, dt, INTEGRATION_RK4);
+}
+
+void integrate_body(RigidBody* body, float dt, IntegrationMethod method) {
+    if (!body || body->is_static || body->is_sleeping) return;
+    
+    MotionState state = motion_state_from_body(body);
+    motion_integrate(&state, dt, method);
+}
+
+void apply_damping(RigidBody* body, float linear_damping, float angular_damping) {
+    if (!body || body->is_static) return;
+    
+    motion_damp(&body->velocity, &body->angular_velocity, linear_damping, angular_damping);
+    
+    // Put body to sleep if velocity is very low
+    if (motion_settle(&body->velocity, &body->angular_velocity)) {
         body->is_sleeping = true;
-        body->velocity = vector3_zero();
-        body->angular_velocity = vector3_zero();
     }
-}
\ No newline at end of file
+}
+
+void integrate_pool_list(BodyPool* pool, const int* indices, int count, float dt, IntegrationMethod method) {
+    if (!pool || !indices) return;
+    
+    for (int k = 0; k < count; k++) {
+        MotionState state = motion_state_from_pool(pool, indices[k]);
+        motion_integrate(&state, dt, method);
+    }
+}
+
+void apply_damping_pool_list(BodyPool* pool, const int* indices, int count, float linear_damping,
+                             float angular_damping) {
+    if (!pool || !indices) return;
+    
+    for (int k = 0; k < count; k++) {
+        int i = indices[k];
+        motion_damp(&pool->velocity[i], &pool->angular_velocity[i], linear_damping, angular_damping);
+    }
+}
@@ -0,0 +1,43 @@
+#include "../include/island.h"
+#include "../include/allocator.h"
+#include <string.h>
+
+void island_set_init(IslandSet* islands) {
+    if (islands) {
+        memset(islands, 0, sizeof(IslandSet));
+    }
+}
+
+void island_set_destroy(IslandSet* islands) {
+    if (!islands) return;
+
+    physics_free(islands->parent, (size_t)islands->capacity * sizeof(int));
+    physics_free(islands->rest_time, (size_t)islands->capacity * sizeof(float));
+    physics_free(islands->sleep_id, (size_t)islands->capacity * sizeof(uint32_t));
+    island_set_init(islands);
+}
+
+bool island_set_reserve(IslandSet* islands, int needed) {
+    if (!islands || needed < 0) return false;
+
+    if (needed > islands->capacity) {
+        int capacity = islands->capacity > 0 ? islands->capacity : 16;
+        while (capacity < needed) {
+            capacity *= 2;
+        }
+
+        IslandSet grown;
+        grown.parent = (int*)physics_alloc((size_t)capacity * sizeof(int));
+        grown.rest_time = (float*)physics_alloc((size_t)capacity * sizeof(float));
+        grown.sleep_id = (uint32_t*)physics_alloc((size_t)capacity * sizeof(uint32_t));
+        grown.capacity = capacity;
+        if (!grown.parent || !grown.rest_time || !grown.sleep_id) {
+            island_set_destroy(&grown);
+            return false;
+        }
+
+        island_set_destroy(islands);
+        *islands = grown;
+    }
+    return true;
+}
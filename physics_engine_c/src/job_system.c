@@ -0,0 +1,353 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "../include/job_system.h"
+#include "../include/allocator.h"
+#include <pthread.h>
+#include <string.h>
+
+#define JOB_CACHE_LINE 64
+
+// Share of the current job owned by one participant
+typedef struct {
+    pthread_mutex_t lock;
+    int begin;
+    int end;
+} JobRange;
+
+// Shares sit on separate cache lines so owners and thieves don't false-share
+typedef union {
+    JobRange range;
+    char line[JOB_CACHE_LINE * ((sizeof(JobRange) + JOB_CACHE_LINE - 1) / JOB_CACHE_LINE)];
+} JobRangeSlot;
+
+typedef struct {
+    JobSystem* jobs;
+    int index;
+} JobWorker;
+
+struct JobSystem {
+    int thread_count;
+    int capacity;                  // Participants allocated for; threads may fail to start
+    pthread_t* threads;            // thread_count - 1 workers; index 0 is the caller
+    JobWorker* workers;
+    JobRangeSlot* ranges;          // One per participant
+
+    // Job hand-off
+    pthread_mutex_t mutex;
+    pthread_cond_t work_ready;
+    pthread_cond_t work_done;
+    unsigned int generation;       // Bumped for every job
+    int busy_workers;              // Workers that have not finished the current job
+    bool shutting_down;
+
+    // Current job
+    JobRangeFunc func;
+    void* context;
+    int grain;
+};
+
+// Take up to one grain from the front of the participant's own share
+static bool job_take_local(JobSystem* jobs, int index, int* begin, int* end) {
+    JobRange* range = &jobs->ranges[index].range;
+    bool found = false;
+
+    pthread_mutex_lock(&range->lock);
+    if (range->begin < range->end) {
+        *begin = range->begin;
+        *end = range->end - range->begin > jobs->grain ? range->begin + jobs->grain : range->end;
+        range->begin = *end;
+        found = true;
+    }
+    pthread_mutex_unlock(&range->lock);
+    return found;
+}
+
+// Move the back half of another participant's share into our own
+static bool job_steal(JobSystem* jobs, int index) {
+    for (int k = 1; k < jobs->thread_count; k++) {
+        JobRange* victim = &jobs->ranges[(index + k) % jobs->thread_count].range;
+        int begin = 0;
+        int end = 0;
+
+        pthread_mutex_lock(&victim->lock);
+        int remaining = victim->end - victim->begin;
+        if (remaining > 0) {
+            // Small shares go whole; larger ones are split so the victim keeps working
+            int stolen = remaining > jobs->grain ? remaining / 2 : remaining;
+            end = victim->end;
+            begin = end - stolen;
+            victim->end = begin;
+        }
+        pthread_mutex_unlock(&victim->lock);
+
+        if (begin < end) {
+            JobRange* own = &jobs->ranges[index].range;
+            pthread_mutex_lock(&own->lock);
+            own->begin = begin;
+            own->end = end;
+            pthread_mutex_unlock(&own->lock);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// Work until every share is empty
+static void job_run(JobSystem* jobs, int index) {
+    int begin, end;
+
+    for (;;) {
+        if (job_take_local(jobs, index, &begin, &end)) {
+            jobs->func(jobs->context, begin, end);
+        } else if (!job_steal(jobs, index)) {
+            return;
+        }
+    }
+}
+
+static void* job_worker_main(void* argument) {
+    JobWorker* worker = (JobWorker*)argument;
+    JobSystem* jobs = worker->jobs;
+    unsigned int seen = 0;
+
+    pthread_mutex_lock(&jobs->mutex);
+    for (;;) {
+        while (!jobs->shutting_down && jobs->generation == seen) {
+            pthread_cond_wait(&jobs->work_ready, &jobs->mutex);
+        }
+        if (jobs->shutting_down) break;
+
+        seen = jobs->generation;
+        pthread_mutex_unlock(&jobs->mutex);
+
+        job_run(jobs, worker->index);
+
+        pthread_mutex_lock(&jobs->mutex);
+        if (--jobs->busy_workers == 0) {
+            pthread_cond_signal(&jobs->work_done);
+        }
+    }
+    pthread_mutex_unlock(&jobs->mutex);
+    return NULL;
+}
+
+static size_t job_ranges_size(int thread_count) {
+    return (size_t)thread_count * sizeof(JobRangeSlot);
+}
+
+JobSystem* job_system_create(int thread_count) {
+    if (thread_count < 1) thread_count = 1;
+
+    JobSystem* jobs = (JobSystem*)physics_alloc(sizeof(JobSystem));
+    if (!jobs) return NULL;
+
+    memset(jobs, 0, sizeof(JobSystem));
+    jobs->thread_count = thread_count;
+    jobs->capacity = thread_count;
+    jobs->ranges = (JobRangeSlot*)physics_alloc_aligned(job_ranges_size(thread_count), JOB_CACHE_LINE);
+    jobs->workers = (JobWorker*)physics_alloc((size_t)thread_count * sizeof(JobWorker));
+    jobs->threads = (pthread_t*)physics_alloc((size_t)thread_count * sizeof(pthread_t));
+    if (!jobs->ranges || !jobs->workers || !jobs->threads) {
+        physics_free_aligned(jobs->ranges, job_ranges_size(thread_count), JOB_CACHE_LINE);
+        physics_free(jobs->workers, (size_t)thread_count * sizeof(JobWorker));
+        physics_free(jobs->threads, (size_t)thread_count * sizeof(pthread_t));
+        physics_free(jobs, sizeof(JobSystem));
+        return NULL;
+    }
+
+    pthread_mutex_init(&jobs->mutex, NULL);
+    pthread_cond_init(&jobs->work_ready, NULL);
+    pthread_cond_init(&jobs->work_done, NULL);
+
+    for (int i = 0; i < thread_count; i++) {
+        pthread_mutex_init(&jobs->ranges[i].range.lock, NULL);
+        jobs->ranges[i].range.begin = 0;
+        jobs->ranges[i].range.end = 0;
+        jobs->workers[i].jobs = jobs;
+        jobs->workers[i].index = i;
+    }
+
+    // Participant 0 is whichever thread calls job_system_parallel_for
+    for (int i = 1; i < thread_count; i++) {
+        if (pthread_create(&jobs->threads[i], NULL, job_worker_main, &jobs->workers[i]) != 0) {
+            // Run with the threads that did start
+            jobs->thread_count = i;
+            break;
+        }
+    }
+
+    return jobs;
+}
+
+void job_system_destroy(JobSystem* jobs) {
+    if (!jobs) return;
+
+    pthread_mutex_lock(&jobs->mutex);
+    jobs->shutting_down = true;
+    pthread_cond_broadcast(&jobs->work_ready);
+    pthread_mutex_unlock(&jobs->mutex);
+
+    for (int i = 1; i < jobs->thread_count; i++) {
+        pthread_join(jobs->threads[i], NULL);
+    }
+
+    int allocated = jobs->capacity;
+    for (int i = 0; i < allocated; i++) {
+        pthread_mutex_destroy(&jobs->ranges[i].range.lock);
+    }
+    pthread_mutex_destroy(&jobs->mutex);
+    pthread_cond_destroy(&jobs->work_ready);
+    pthread_cond_destroy(&jobs->work_done);
+
+    physics_free_aligned(jobs->ranges, job_ranges_size(allocated), JOB_CACHE_LINE);
+    physics_free(jobs->workers, (size_t)allocated * sizeof(JobWorker));
+    physics_free(jobs->threads, (size_t)allocated * sizeof(pthread_t));
+    physics_free(jobs, sizeof(JobSystem));
+}
+
+int job_system_get_thread_count(const JobSystem* jobs) {
+    return jobs ? jobs->thread_count : 1;
+}
+
+void job_system_parallel_for(JobSystem* jobs, int count, int grain, JobRangeFunc func, void* context) {
+    if (!func || count <= 0) return;
+    if (grain < 1) grain = 1;
+
+    if (!jobs || jobs->thread_count < 2 || count <= grain) {
+        func(context, 0, count);
+        return;
+    }
+
+    // Deal out equal shares; stealing evens out whatever imbalance remains
+    int thread_count = jobs->thread_count;
+    for (int i = 0; i < thread_count; i++) {
+        JobRange* range = &jobs->ranges[i].range;
+        pthread_mutex_lock(&range->lock);
+        range->begin = (int)((long long)count * i / thread_count);
+        range->end = (int)((long long)count * (i + 1) / thread_count);
+        pthread_mutex_unlock(&range->lock);
+    }
+
+    pthread_mutex_lock(&jobs->mutex);
+    jobs->func = func;
+    jobs->context = context;
+    jobs->grain = grain;
+    jobs->busy_workers = thread_count - 1;
+    jobs->generation++;
+    pthread_cond_broadcast(&jobs->work_ready);
+    pthread_mutex_unlock(&jobs->mutex);
+
+    job_run(jobs, 0);
+
+    pthread_mutex_lock(&jobs->mutex);
+    while (jobs->busy_workers > 0) {
+        pthread_cond_wait(&jobs->work_done, &jobs->mutex);
+    }
+    pthread_mutex_unlock(&jobs->mutex);
+}
+
+struct JobTask {
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t submitted;
+    pthread_cond_t completed;
+    uint64_t submit_count;         // Last ticket handed out
+    uint64_t complete_count;       // Last ticket finished
+    bool shutting_down;
+
+    void (*func)(void* context);
+    void* context;
+};
+
+static void* job_task_main(void* argument) {
+    JobTask* task = (JobTask*)argument;
+
+    pthread_mutex_lock(&task->mutex);
+    for (;;) {
+        while (!task->shutting_down && task->complete_count == task->submit_count) {
+            pthread_cond_wait(&task->submitted, &task->mutex);
+        }
+        if (task->complete_count == task->submit_count) break;
+
+        void (*func)(void*) = task->func;
+        void* context = task->context;
+        pthread_mutex_unlock(&task->mutex);
+
+        func(context);
+
+        pthread_mutex_lock(&task->mutex);
+        task->complete_count++;
+        pthread_cond_broadcast(&task->completed);
+    }
+    pthread_mutex_unlock(&task->mutex);
+    return NULL;
+}
+
+JobTask* job_task_create(void) {
+    JobTask* task = (JobTask*)physics_alloc(sizeof(JobTask));
+    if (!task) return NULL;
+
+    memset(task, 0, sizeof(JobTask));
+    pthread_mutex_init(&task->mutex, NULL);
+    pthread_cond_init(&task->submitted, NULL);
+    pthread_cond_init(&task->completed, NULL);
+
+    if (pthread_create(&task->thread, NULL, job_task_main, task) != 0) {
+        pthread_mutex_destroy(&task->mutex);
+        pthread_cond_destroy(&task->submitted);
+        pthread_cond_destroy(&task->completed);
+        physics_free(task, sizeof(JobTask));
+        return NULL;
+    }
+    return task;
+}
+
+void job_task_destroy(JobTask* task) {
+    if (!task) return;
+
+    pthread_mutex_lock(&task->mutex);
+    task->shutting_down = true;
+    pthread_cond_signal(&task->submitted);
+    pthread_mutex_unlock(&task->mutex);
+
+    pthread_join(task->thread, NULL);
+    pthread_mutex_destroy(&task->mutex);
+    pthread_cond_destroy(&task->submitted);
+    pthread_cond_destroy(&task->completed);
+    physics_free(task, sizeof(JobTask));
+}
+
+uint64_t job_task_submit(JobTask* task, void (*func)(void* context), void* context) {
+    if (!task || !func) return 0;
+
+    pthread_mutex_lock(&task->mutex);
+    while (task->complete_count != task->submit_count) {
+        pthread_cond_wait(&task->completed, &task->mutex);
+    }
+    task->func = func;
+    task->context = context;
+    uint64_t ticket = ++task->submit_count;
+    pthread_cond_signal(&task->submitted);
+    pthread_mutex_unlock(&task->mutex);
+    return ticket;
+}
+
+bool job_task_is_complete(JobTask* task, uint64_t ticket) {
+    if (!task || ticket == 0) return true;
+
+    pthread_mutex_lock(&task->mutex);
+    bool complete = task->complete_count >= ticket;
+    pthread_mutex_unlock(&task->mutex);
+    return complete;
+}
+
+void job_task_wait(JobTask* task, uint64_t ticket) {
+    if (!task || ticket == 0) return;
+
+    pthread_mutex_lock(&task->mutex);
+    while (task->complete_count < ticket) {
+        pthread_cond_wait(&task->completed, &task->mutex);
+    }
+    pthread_mutex_unlock(&task->mutex);
+}
@@ -0,0 +1,385 @@
+#define _DEFAULT_SOURCE
+
+#include "../include/partition.h"
+#include "../include/allocator.h"
+#include <math.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+// Single-producer, single-consumer ring living in the shared mapping. The
+// producer only writes head and the consumer only writes tail, so a record
+// is handed over by a release store and picked up by an acquire load.
+typedef struct {
+    size_t head;
+    char pad_head[PARTITION_CACHE_LINE - sizeof(size_t)];
+    size_t tail;
+    char pad_tail[PARTITION_CACHE_LINE - sizeof(size_t)];
+} BorderRing;
+
+// Ring directions out of a partition
+#define BORDER_LEFT  0
+#define BORDER_RIGHT 1
+
+struct PartitionDomain {
+    size_t mapping_size;
+    int partition_count;
+    int ring_capacity;
+    float min_x;
+    float max_x;
+    float ghost_width;
+
+    // Offsets into the mapping
+    size_t stats_offset;           // partition_count PartitionStats
+    size_t rings_offset;           // 2 * partition_count rings, see domain_ring
+    size_t ring_stride;            // Ring header plus its records
+};
+
+static size_t align_up(size_t value, size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+static PartitionStats* domain_stats(PartitionDomain* domain, int index) {
+    return (PartitionStats*)((char*)domain + domain->stats_offset) + index;
+}
+
+// Ring carrying records from partition `from` towards `direction`
+static BorderRing* domain_ring(PartitionDomain* domain, int from, int direction) {
+    return (BorderRing*)((char*)domain + domain->rings_offset + (size_t)(2 * from + direction) * domain->ring_stride);
+}
+
+static BorderRecord* ring_records(BorderRing* ring) {
+    return (BorderRecord*)(ring + 1);
+}
+
+PartitionDomain* partition_domain_create(int partition_count, float min_x, float max_x, float ghost_width,
+                                         int ring_capacity) {
+    if (partition_count < 1 || !(max_x > min_x) || ghost_width < 0.0f || ring_capacity < 1) return NULL;
+
+    size_t stats_offset = align_up(sizeof(PartitionDomain), PARTITION_CACHE_LINE);
+    size_t rings_offset = align_up(stats_offset + (size_t)partition_count * sizeof(PartitionStats),
+                                   PARTITION_CACHE_LINE);
+    size_t ring_stride = align_up(sizeof(BorderRing) + (size_t)ring_capacity * sizeof(BorderRecord),
+                                  PARTITION_CACHE_LINE);
+    size_t mapping_size = rings_offset + (size_t)(2 * partition_count) * ring_stride;
+
+    // Anonymous shared memory is inherited across fork and shared by threads
+    void* mapping = mmap(NULL, mapping_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (mapping == MAP_FAILED) return NULL;
+
+    // Fresh mappings are zeroed, so every ring starts empty
+    PartitionDomain* domain = (PartitionDomain*)mapping;
+    domain->mapping_size = mapping_size;
+    domain->partition_count = partition_count;
+    domain->ring_capacity = ring_capacity;
+    domain->min_x = min_x;
+    domain->max_x = max_x;
+    domain->ghost_width = ghost_width;
+    domain->stats_offset = stats_offset;
+    domain->rings_offset = rings_offset;
+    domain->ring_stride = ring_stride;
+    return domain;
+}
+
+void partition_domain_destroy(PartitionDomain* domain) {
+    if (domain) {
+        munmap(domain, domain->mapping_size);
+    }
+}
+
+int partition_domain_get_count(const PartitionDomain* domain) {
+    return domain ? domain->partition_count : 0;
+}
+
+int partition_domain_find(const PartitionDomain* domain, float x) {
+    if (!domain) return -1;
+
+    float width = (domain->max_x - domain->min_x) / (float)domain->partition_count;
+    int index = (int)floorf((x - domain->min_x) / width);
+    if (index < 0) return 0;
+    if (index >= domain->partition_count) return domain->partition_count - 1;
+    return index;
+}
+
+PartitionStats partition_domain_get_stats(const PartitionDomain* domain, int index) {
+    PartitionStats stats;
+    memset(&stats, 0, sizeof(PartitionStats));
+    if (domain && index >= 0 && index < domain->partition_count) {
+        stats = *domain_stats((PartitionDomain*)domain, index);
+    }
+    return stats;
+}
+
+// Move whatever has arrived from one neighbour into the inbox. Returns true
+// once that neighbour's end-of-step record for `step` has been taken.
+// Records stay in the ring while the inbox can't grow.
+static bool partition_receive(Partition* partition, int neighbour, int direction, uint32_t step) {
+    BorderRing* ring = domain_ring(partition->domain, neighbour, direction);
+    BorderRecord* records = ring_records(ring);
+    size_t capacity = (size_t)partition->domain->ring_capacity;
+
+    size_t tail = ring->tail;
+    size_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    bool finished = false;
+
+    while (tail != head && !finished) {
+        const BorderRecord* record = &records[tail % capacity];
+        if (record->type == BORDER_RECORD_END_OF_STEP) {
+            finished = record->step == step;
+        } else if (physics_ensure_capacity((void**)&partition->inbox, &partition->inbox_capacity,
+                                           partition->inbox_count + 1, sizeof(BorderRecord))) {
+            partition->inbox[partition->inbox_count++] = *record;
+        } else {
+            // Leave the record in the ring and retry on the next pump, so a
+            // migrating body is never lost
+            break;
+        }
+        tail++;
+    }
+
+    __atomic_store_n(&ring->tail, tail, __ATOMIC_RELEASE);
+    return finished;
+}
+
+// Receive from both neighbours without waiting; used while a ring is full
+// so two partitions sending to each other can't both stall
+static void partition_pump(Partition* partition, bool* done_left, bool* done_right) {
+    int count = partition->domain->partition_count;
+    int index = partition->index;
+
+    if (index > 0 && !*done_left) {
+        *done_left = partition_receive(partition, index - 1, BORDER_RIGHT, partition->step);
+    }
+    if (index + 1 < count && !*done_right) {
+        *done_right = partition_receive(partition, index + 1, BORDER_LEFT, partition->step);
+    }
+}
+
+static void partition_send(Partition* partition, int direction, BorderRecordType type, const RigidBody* body,
+                           bool* done_left, bool* done_right) {
+    BorderRing* ring = domain_ring(partition->domain, partition->index, direction);
+    size_t capacity = (size_t)partition->domain->ring_capacity;
+    size_t head = ring->head;
+
+    while (head - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE) >= capacity) {
+        partition_pump(partition, done_left, done_right);
+        sched_yield();
+    }
+
+    BorderRecord* record = &ring_records(ring)[head % capacity];
+    record->type = type;
+    record->step = partition->step;
+    if (body) {
+        record->body = *body;
+    }
+    __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+}
+
+bool partition_init(Partition* partition, PartitionDomain* domain, int index) {
+    if (!partition || !domain || index < 0 || index >= domain->partition_count) return false;
+
+    memset(partition, 0, sizeof(Partition));
+    partition->world = physics_world_create();
+    if (!partition->world) return false;
+
+    float width = (domain->max_x - domain->min_x) / (float)domain->partition_count;
+    partition->domain = domain;
+    partition->index = index;
+    partition->min_x = index > 0 ? domain->min_x + width * (float)index : -INFINITY;
+    partition->max_x = index + 1 < domain->partition_count ? domain->min_x + width * (float)(index + 1) : INFINITY;
+    partition->ghost_width = domain->ghost_width;
+    partition->next_local_id = 1;
+
+    memset(domain_stats(domain, index), 0, sizeof(PartitionStats));
+    return true;
+}
+
+void partition_release(Partition* partition) {
+    if (!partition) return;
+
+    physics_world_destroy(partition->world);
+    physics_free(partition->ghosts, (size_t)partition->ghost_capacity * sizeof(PartitionGhost));
+    physics_free(partition->inbox, (size_t)partition->inbox_capacity * sizeof(BorderRecord));
+    memset(partition, 0, sizeof(Partition));
+}
+
+int partition_add_body(Partition* partition, RigidBody* body) {
+    if (!partition || !body || body->is_static) return 0;
+
+    // Negative ids, interleaved by partition, never clash with each other or
+    // with the positive ids from rigid_body_init
+    body->id = -(partition->next_local_id++ * partition->domain->partition_count + partition->index);
+    if (body_handle_is_null(physics_world_add_body_handle(partition->world, body))) return 0;
+
+    domain_stats(partition->domain, partition->index)->owned_bodies++;
+    return body->id;
+}
+
+static int ghost_compare(const void* a, const void* b) {
+    int id_a = ((const PartitionGhost*)a)->id;
+    int id_b = ((const PartitionGhost*)b)->id;
+    return (id_a > id_b) - (id_a < id_b);
+}
+
+// Search the first `count` ghosts, which are sorted by id
+static PartitionGhost* partition_find_ghost(Partition* partition, int count, int id) {
+    if (count == 0) return NULL;
+
+    PartitionGhost key;
+    key.id = id;
+    return (PartitionGhost*)bsearch(&key, partition->ghosts, (size_t)count, sizeof(PartitionGhost), ghost_compare);
+}
+
+// Ghosts are static here but keep the owner's velocity for contact response
+static void partition_copy_ghost(RigidBody* ghost, const RigidBody* body) {
+    *ghost = *body;
+    rigid_body_set_static(ghost, true);
+    ghost->velocity = body->velocity;
+    ghost->is_sleeping = false;
+}
+
+// Existing ghosts are overwritten in place rather than removed and added
+// again: removing a body wakes whatever sleeps against it, so churning
+// ghosts would keep every body near a border awake
+static void partition_apply_inbox(Partition* partition, PartitionStats* stats) {
+    PhysicsWorld* world = partition->world;
+    int sorted_count = partition->ghost_count;
+
+    for (int r = 0; r < partition->inbox_count; r++) {
+        const BorderRecord* record = &partition->inbox[r];
+        PartitionGhost* ghost = partition_find_ghost(partition, sorted_count, record->body.id);
+        RigidBody* existing = ghost ? physics_world_get_body_by_handle(world, ghost->handle) : NULL;
+
+        if (record->type == BORDER_RECORD_MIGRATE) {
+            if (existing) {
+                // The ghost becomes the owned body, keeping its index and handle
+                *existing = record->body;
+                physics_world_mark_body_dirty(world, ghost->handle);
+                ghost->handle = body_handle_null();
+            } else {
+                RigidBody* body = physics_world_create_body(world);
+                if (!body) continue;
+
+                *body = record->body;
+                if (body_handle_is_null(physics_world_add_body_handle(world, body))) {
+                    physics_world_destroy_body(world, body);
+                    continue;
+                }
+            }
+            stats->migrated_in++;
+            stats->owned_bodies++;
+            continue;
+        }
+
+        if (existing) {
+            partition_copy_ghost(existing, &record->body);
+            physics_world_mark_body_dirty(world, ghost->handle);
+            ghost->step = partition->step;
+            stats->ghosts_received++;
+            continue;
+        }
+
+        if (!physics_ensure_capacity((void**)&partition->ghosts, &partition->ghost_capacity,
+                                     partition->ghost_count + 1, sizeof(PartitionGhost))) {
+            continue;
+        }
+        RigidBody* body = physics_world_create_body(world);
+        if (!body) continue;
+
+        partition_copy_ghost(body, &record->body);
+        BodyHandle handle = physics_world_add_body_handle(world, body);
+        if (body_handle_is_null(handle)) {
+            physics_world_destroy_body(world, body);
+            continue;
+        }
+        PartitionGhost* added = &partition->ghosts[partition->ghost_count++];
+        added->id = body->id;
+        added->handle = handle;
+        added->step = partition->step;
+        stats->ghosts_received++;
+    }
+    partition->inbox_count = 0;
+
+    // Drop ghosts that became owned bodies and remove those that weren't
+    // sent this step, which have left the neighbour's border region
+    int kept = 0;
+    for (int g = 0; g < partition->ghost_count; g++) {
+        PartitionGhost ghost = partition->ghosts[g];
+        if (body_handle_is_null(ghost.handle)) continue;
+
+        if (ghost.step != partition->step) {
+            physics_world_destroy_body(world, physics_world_get_body_by_handle(world, ghost.handle));
+            continue;
+        }
+        partition->ghosts[kept++] = ghost;
+    }
+    partition->ghost_count = kept;
+    if (kept > 1) {
+        qsort(partition->ghosts, (size_t)kept, sizeof(PartitionGhost), ghost_compare);
+    }
+}
+
+void partition_step(Partition* partition) {
+    if (!partition) return;
+
+    PhysicsWorld* world = partition->world;
+    PartitionStats* stats = domain_stats(partition->domain, partition->index);
+    bool has_left = partition->index > 0;
+    bool has_right = partition->index + 1 < partition->domain->partition_count;
+    bool done_left = !has_left;
+    bool done_right = !has_right;
+
+    // Walk backwards: removal moves the last body into the freed index
+    for (int i = world->body_count - 1; i >= 0; i--) {
+        RigidBody* body = world->bodies[i];
+        if (body->is_static) continue;
+
+        float x = body->position.x;
+        if (has_left && x < partition->min_x) {
+            partition_send(partition, BORDER_LEFT, BORDER_RECORD_MIGRATE, body, &done_left, &done_right);
+        } else if (has_right && x >= partition->max_x) {
+            partition_send(partition, BORDER_RIGHT, BORDER_RECORD_MIGRATE, body, &done_left, &done_right);
+        } else {
+            if (has_left && x < partition->min_x + partition->ghost_width) {
+                partition_send(partition, BORDER_LEFT, BORDER_RECORD_GHOST, body, &done_left, &done_right);
+                stats->ghosts_sent++;
+            }
+            if (has_right && x >= partition->max_x - partition->ghost_width) {
+                partition_send(partition, BORDER_RIGHT, BORDER_RECORD_GHOST, body, &done_left, &done_right);
+                stats->ghosts_sent++;
+            }
+            continue;
+        }
+
+        physics_world_destroy_body(world, body);
+        stats->migrated_out++;
+        stats->owned_bodies--;
+    }
+
+    if (has_left) {
+        partition_send(partition, BORDER_LEFT, BORDER_RECORD_END_OF_STEP, NULL, &done_left, &done_right);
+    }
+    if (has_right) {
+        partition_send(partition, BORDER_RIGHT, BORDER_RECORD_END_OF_STEP, NULL, &done_left, &done_right);
+    }
+
+    // Wait for both neighbours to finish sending this step
+    while (!done_left || !done_right) {
+        partition_pump(partition, &done_left, &done_right);
+        if (!done_left || !done_right) {
+            sched_yield();
+        }
+    }
+
+    partition_apply_inbox(partition, stats);
+
+    physics_world_step(world);
+    partition->step++;
+    stats->steps = partition->step;
+}
+
+int partition_get_owned_count(const Partition* partition) {
+    if (!partition) return 0;
+    return domain_stats(partition->domain, partition->index)->owned_bodies;
+}
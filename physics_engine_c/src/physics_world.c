@@ -1,10 +1,151 @@
 #include "../include/physics_world.h"
+#include "../include/allocator.h"
+#include <float.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
 
+static bool plane_list_reserve(PlaneList* planes, int needed) {
+    if (needed <= planes->capacity) return true;
+    
+    int capacity = planes->capacity > 0 ? planes->capacity : 4;
+    while (capacity < needed) {
+        capacity *= 2;
+    }
+    
+    float** arrays[] = { &planes->normal_x, &planes->normal_y, &planes->normal_z,
+                         &planes->distance };
+    for (size_t k = 0; k < sizeof(arrays) / sizeof(arrays[0]); k++) {
+        float* grown = (float*)physics_realloc(*arrays[k], (size_t)planes->capacity * sizeof(float),
+                                               (size_t)capacity * sizeof(float));
+        if (!grown) return false;
+        *arrays[k] = grown;
+    }
+    
+    int* indices = (int*)physics_realloc(planes->indices, (size_t)planes->capacity * sizeof(int),
+                                         (size_t)capacity * sizeof(int));
+    if (!indices) return false;
+    planes->indices = indices;
+    
+    planes->capacity = capacity;
+    return true;
+}
+
+static void plane_list_destroy(PlaneList* planes) {
+    size_t bytes = (size_t)planes->capacity * sizeof(float);
+    physics_free(planes->indices, (size_t)planes->capacity * sizeof(int));
+    physics_free(planes->normal_x, bytes);
+    physics_free(planes->normal_y, bytes);
+    physics_free(planes->normal_z, bytes);
+    physics_free(planes->distance, bytes);
+    memset(planes, 0, sizeof(PlaneList));
+}
+
+static void physics_world_destroy_contact_blocks(PhysicsWorld* world) {
+    for (int b = 0; b < world->contact_block_capacity; b++) {
+        ContactBlock* block = &world->contact_blocks[b];
+        physics_free_aligned(block->contacts, (size_t)block->capacity * sizeof(Contact), CONTACT_ALIGNMENT);
+        physics_free(block->plane_separation, (size_t)block->plane_capacity * sizeof(float));
+    }
+    physics_free(world->contact_blocks, (size_t)world->contact_block_capacity * sizeof(ContactBlock));
+    world->contact_blocks = NULL;
+    world->contact_block_capacity = 0;
+}
+
+static void physics_world_destroy_contact_batches(PhysicsWorld* world) {
+    ContactBatches* batches = &world->contact_batches;
+    physics_free(batches->order, (size_t)batches->order_capacity * sizeof(int));
+    physics_free(batches->body_colors, (size_t)batches->body_capacity * sizeof(uint64_t));
+    memset(batches, 0, sizeof(ContactBatches));
+}
+
+static void physics_world_destroy_commands(PhysicsWorld* world) {
+    BodyCommand command;
+    while (command_queue_pop(&world->commands, &command)) {
+        if (command.type == BODY_COMMAND_SPAWN) {
+            physics_world_destroy_body(world, command.body);
+        }
+    }
+    command_queue_destroy(&world->commands);
+    
+    for (int t = 0; t < BODY_COMMAND_TYPE_COUNT; t++) {
+        CommandBatch* batch = &world->command_batches[t];
+        physics_free(batch->commands, (size_t)batch->capacity * sizeof(BodyCommand));
+    }
+    memset(world->command_batches, 0, sizeof(world->command_batches));
+}
+
+// Remember a sleeping island to wake in the next physics_world_wake_islands
+static void physics_world_queue_island_wake(PhysicsWorld* world, uint32_t island) {
+    if (island == 0) return;
+    
+    // On allocation failure the island sleeps on until it is touched again
+    if (physics_ensure_capacity((void**)&world->waking_islands, &world->waking_capacity, world->waking_count + 1,
+                                sizeof(uint32_t))) {
+        world->waking_islands[world->waking_count++] = island;
+    }
+}
+
+// Wake one sleeping body now and queue the rest of its island
+static void physics_world_wake_body(PhysicsWorld* world, int index) {
+    BodyPool* pool = &world->pool;
+    
+    body_pool_set_sleeping(pool, index, false);
+    world->bodies[index]->is_sleeping = false;
+    pool->sleep_time[index] = 0.0f;
+    physics_world_queue_island_wake(world, pool->island[index]);
+    pool->island[index] = 0;
+    world->active_dirty = true;
+}
+
+static int island_id_compare(const void* a, const void* b) {
+    uint32_t id_a = *(const uint32_t*)a;
+    uint32_t id_b = *(const uint32_t*)b;
+    return (id_a > id_b) - (id_a < id_b);
+}
+
+// Wake every body of the queued islands
+static void physics_world_wake_islands(PhysicsWorld* world) {
+    if (world->waking_count == 0) return;
+    
+    BodyPool* pool = &world->pool;
+    qsort(world->waking_islands, (size_t)world->waking_count, sizeof(uint32_t), island_id_compare);
+    
+    for (int i = 0; i < pool->count; i++) {
+        if (!body_pool_is_sleeping(pool, i) || pool->island[i] == 0) continue;
+        
+        if (bsearch(&pool->island[i], world->waking_islands, (size_t)world->waking_count, sizeof(uint32_t),
+                    island_id_compare)) {
+            body_pool_set_sleeping(pool, i, false);
+            world->bodies[i]->is_sleeping = false;
+            pool->sleep_time[i] = 0.0f;
+            pool->island[i] = 0;
+            world->active_dirty = true;
+        }
+    }
+    
+    world->waking_count = 0;
+}
+
+// Bring the active body list up to date with the pool flags. Capacity for
+// every body is reserved as bodies are added, so this never allocates.
+static void physics_world_refresh_active_bodies(PhysicsWorld* world) {
+    if (!world->active_dirty) return;
+    
+    const BodyPool* pool = &world->pool;
+    int count = 0;
+    for (int i = 0; i < pool->count; i++) {
+        if (!(pool->flags[i] & (BODY_FLAG_STATIC | BODY_FLAG_SLEEPING))) {
+            world->active_bodies[count++] = i;
+        }
+    }
+    
+    world->active_count = count;
+    world->active_dirty = false;
+}
+
 PhysicsWorld* physics_world_create(void) {
-    PhysicsWorld* world = (PhysicsWorld*)malloc(sizeof(PhysicsWorld));
+    PhysicsWorld* world = (PhysicsWorld*)physics_alloc(sizeof(PhysicsWorld));
     if (!world) return NULL;
     
     physics_world_init(world);
@@ -14,18 +155,87 @@ PhysicsWorld* physics_world_create(void) {
 void physics_world_destroy(PhysicsWorld* world) {
     if (!world) return;
     
+    physics_world_release(world);
+    physics_free(world, sizeof(PhysicsWorld));
+}
+
+void physics_world_release(PhysicsWorld* world) {
+    if (!world) return;
+    
+    // Let a running step finish before tearing anything down
+    job_task_destroy(world->step_task);
+    body_state_buffers_destroy(world->body_states);
+    
+    // Spawned bodies still in the queue belong to the world
+    physics_world_destroy_commands(world);
+    
     // Clean up all bodies
     physics_world_clear_bodies(world);
-    free(world);
+    job_system_destroy(world->job_system);
+    physics_world_destroy_contact_blocks(world);
+    physics_world_destroy_contact_batches(world);
+    physics_free(world->constraints, (size_t)world->constraint_capacity * sizeof(ContactConstraint));
+    contact_cache_destroy(&world->contact_cache);
+    island_set_destroy(&world->islands);
+    physics_free(world->waking_islands, (size_t)world->waking_capacity * sizeof(uint32_t));
+    physics_free(world->removed_bodies, (size_t)world->removed_capacity * sizeof(RemovedBody));
+    physics_free(world->active_bodies, (size_t)world->active_capacity * sizeof(int));
+    physics_free(world->dirty_bodies, (size_t)world->dirty_capacity * sizeof(BodyHandle));
+    physics_free(world->swept_bodies, (size_t)world->swept_capacity * sizeof(SweptBody));
+    physics_free(world->reduction_partials, (size_t)world->reduction_capacity * sizeof(float));
+    broad_phase_destroy(&world->broad_phase);
+    body_pool_destroy(&world->pool);
+    plane_list_destroy(&world->planes);
+    handle_table_destroy(&world->handles);
+    body_id_map_destroy(&world->body_ids);
+    body_slab_destroy(&world->body_slab);
+    physics_free(world->bodies, (size_t)world->body_capacity * sizeof(RigidBody*));
+    physics_free_aligned(world->contacts, (size_t)world->contact_capacity * sizeof(Contact), CONTACT_ALIGNMENT);
 }
 
 void physics_world_init(PhysicsWorld* world) {
     if (!world) return;
     
-    // Initialize body management
-    memset(world->bodies, 0, sizeof(world->bodies));
+    // Initialize body management; storage is allocated on first use
+    world->bodies = NULL;
     world->body_count = 0;
-    world->collision_count = 0;
+    world->body_capacity = 0;
+    world->contacts = NULL;
+    world->contact_count = 0;
+    world->contact_capacity = 0;
+    world->contact_blocks = NULL;
+    world->contact_block_capacity = 0;
+    memset(&world->contact_batches, 0, sizeof(ContactBatches));
+    world->constraints = NULL;
+    world->constraint_capacity = 0;
+    contact_cache_init(&world->contact_cache);
+    world->solver_iterations = PHYSICS_WORLD_SOLVER_ITERATIONS;
+    world->warm_starting = true;
+    island_set_init(&world->islands);
+    world->sleep_time = PHYSICS_WORLD_SLEEP_TIME;
+    world->next_island_id = 0;
+    world->waking_islands = NULL;
+    world->waking_count = 0;
+    world->waking_capacity = 0;
+    world->removed_bodies = NULL;
+    world->removed_count = 0;
+    world->removed_capacity = 0;
+    world->active_bodies = NULL;
+    world->active_count = 0;
+    world->active_capacity = 0;
+    world->dirty_bodies = NULL;
+    world->dirty_count = 0;
+    world->dirty_capacity = 0;
+    world->tracked_edits = false;
+    world->active_dirty = false;
+    memset(&world->planes, 0, sizeof(PlaneList));
+    body_pool_init(&world->pool, 0);
+    handle_table_init(&world->handles);
+    body_id_map_init(&world->body_ids);
+    body_slab_init(&world->body_slab);
+    
+    // Sweep-and-prune keeps pair generation proportional to overlaps
+    broad_phase_init(&world->broad_phase, BROAD_PHASE_SWEEP_AND_PRUNE);
     
     // Set default world properties
     world->gravity = vector3_create(0.0f, -9.81f, 0.0f);  // Earth gravity
@@ -35,69 +245,241 @@ void physics_world_init(PhysicsWorld* world) {
     // Set default damping
     world->linear_damping = 0.01f;
     world->angular_damping = 0.05f;
+    world->wake_distance = 5.0f;
     
     // Simulation control
     world->is_paused = false;
     world->time_scale = 1.0f;
     world->simulation_iterations = 1;
+    world->adaptive_substeps = false;
+    world->min_substeps = 1;
+    world->max_substeps = PHYSICS_WORLD_MAX_SUBSTEPS;
+    memset(&world->step_stats, 0, sizeof(PhysicsStepStats));
+    memset(&world->last_simulated, 0, sizeof(PhysicsStepStats));
+    world->continuous_collision = false;
+    world->swept_bodies = NULL;
+    world->swept_count = 0;
+    world->swept_capacity = 0;
+    world->speculative_contacts = false;
+    world->speculative_time = 0.0f;
+    world->job_system = NULL;
+    memset(&world->scheduler, 0, sizeof(JobScheduler));
+    world->deterministic = false;
+    world->reduction_partials = NULL;
+    world->reduction_capacity = 0;
+    command_queue_init(&world->commands, PHYSICS_WORLD_COMMAND_CAPACITY);
+    memset(world->command_batches, 0, sizeof(world->command_batches));
+    world->step_task = NULL;
+    world->body_states = NULL;
+    world->step_fence = 0;
+    world->async_dt = 0.0f;
+    world->step_count = 0;
+    world->next_local_id = 0;
+    world->reorder_interval = 0;
+    world->steps_since_reorder = 0;
     
     // Performance tracking
     world->last_frame_time = 0.0f;
     world->collision_checks_performed = 0;
 }
 
-int physics_world_add_body(PhysicsWorld* world, RigidBody* body) {
-    if (!world || !body || world->body_count >= MAX_BODIES) {
-        return -1;
+bool physics_world_reserve(PhysicsWorld* world, int body_capacity, int contact_capacity) {
+    if (!world || body_capacity < 0 || contact_capacity < 0) return false;
+    
+    return physics_ensure_capacity((void**)&world->bodies, &world->body_capacity, body_capacity, sizeof(RigidBody*)) &&
+           body_pool_reserve(&world->pool, body_capacity) &&
+           handle_table_reserve(&world->handles, body_capacity) &&
+           body_id_map_reserve(&world->body_ids, body_capacity) &&
+           body_slab_reserve(&world->body_slab, body_capacity) &&
+           physics_ensure_capacity_aligned((void**)&world->contacts, &world->contact_capacity, contact_capacity,
+                                           sizeof(Contact), CONTACT_ALIGNMENT);
+}
+
+RigidBody* physics_world_create_body(PhysicsWorld* world) {
+    if (!world) return NULL;
+    
+    RigidBody* body = body_slab_alloc(&world->body_slab);
+    rigid_body_init(body);
+    return body;
+}
+
+void physics_world_destroy_body(PhysicsWorld* world, RigidBody* body) {
+    if (!world || !body) return;
+    
+    // Take the body out of the simulation first if it was added
+    BodyHandle handle = physics_world_get_body_handle(world, body->id);
+    if (physics_world_get_body_by_handle(world, handle) == body) {
+        physics_world_remove_body_by_handle(world, handle);
+    }
+    
+    if (body_slab_owns(&world->body_slab, body)) {
+        body_slab_free(&world->body_slab, body);
+    } else {
+        rigid_body_destroy(body);
+    }
+}
+
+BodyHandle physics_world_add_body_handle(PhysicsWorld* world, RigidBody* body) {
+    if (!world || !body) {
+        return body_handle_null();
+    }
+    
+    // Reserve everything up front so nothing needs unwinding once the body is in
+    int needed = world->body_count + 1;
+    bool is_plane = body->shape_type == SHAPE_PLANE;
+    if (is_plane && !plane_list_reserve(&world->planes, world->planes.count + 1)) {
+        return body_handle_null();
+    }
+    
+    if (!physics_ensure_capacity((void**)&world->bodies, &world->body_capacity, needed, sizeof(RigidBody*)) ||
+        !physics_ensure_capacity((void**)&world->active_bodies, &world->active_capacity, needed, sizeof(int)) ||
+        !handle_table_reserve(&world->handles, needed) ||
+        !body_id_map_reserve(&world->body_ids, needed)) {
+        return body_handle_null();
+    }
+    
+    int index = body_pool_add(&world->pool, body);
+    if (index < 0) return body_handle_null();
+    
+    if (!broad_phase_add_body(&world->broad_phase, &world->pool, index)) {
+        body_pool_remove(&world->pool, index);
+        return body_handle_null();
+    }
+    
+    if (is_plane) {
+        world->planes.indices[world->planes.count++] = index;
+    }
+    
+    // The new body has the highest index, so appending keeps the list sorted
+    if (!(world->pool.flags[index] & (BODY_FLAG_STATIC | BODY_FLAG_SLEEPING)) && !world->active_dirty) {
+        world->active_bodies[world->active_count++] = index;
     }
     
     world->bodies[world->body_count] = body;
     world->body_count++;
     
-    return body->id;
+    if (world->next_local_id > 0) {
+        body->id = world->next_local_id++;
+    }
+    
+    BodyHandle handle = handle_table_insert(&world->handles);
+    body_id_map_insert(&world->body_ids, body->id, (int)handle.slot);
+    return handle;
 }
 
-bool physics_world_remove_body(PhysicsWorld* world, int body_id) {
+bool physics_world_remove_body_by_handle(PhysicsWorld* world, BodyHandle handle) {
     if (!world) return false;
     
-    for (int i = 0; i < world->body_count; i++) {
-        if (world->bodies[i] && world->bodies[i]->id == body_id) {
-            // Shift remaining bodies down
-            for (int j = i; j < world->body_count - 1; j++) {
-                world->bodies[j] = world->bodies[j + 1];
-            }
-            world->bodies[world->body_count - 1] = NULL;
-            world->body_count--;
-            return true;
+    int index = handle_table_lookup(&world->handles, handle);
+    if (index < 0) return false;
+    
+    // Swap-remove: the last body moves into the freed index everywhere
+    int last = world->body_count - 1;
+    RigidBody* body = world->bodies[index];
+    
+    // Whatever rested on the body has to wake, asleep or not: its own island
+    // and, on the next load, sleeping bodies touching it. On allocation
+    // failure those sleep on until something else touches them.
+    if (body_pool_is_sleeping(&world->pool, index)) {
+        physics_world_queue_island_wake(world, world->pool.island[index]);
+    }
+    if (physics_ensure_capacity((void**)&world->removed_bodies, &world->removed_capacity, world->removed_count + 1,
+                                sizeof(RemovedBody))) {
+        RemovedBody* removed = &world->removed_bodies[world->removed_count++];
+        removed->shape_type = (ShapeType)world->pool.shape_type[index];
+        removed->shape = world->pool.shape[index];
+        removed->position = world->pool.position[index];
+    }
+    
+    broad_phase_remove_body(&world->broad_phase, index);
+    body_pool_remove(&world->pool, index);
+    world->active_dirty = true;
+    handle_table_remove(&world->handles, index);
+    
+    // Forget the id unless it has since been mapped to another body
+    if (body_id_map_find(&world->body_ids, body->id) == (int)handle.slot) {
+        body_id_map_remove(&world->body_ids, body->id);
+    }
+    
+    PlaneList* planes = &world->planes;
+    for (int p = 0; p < planes->count; p++) {
+        if (planes->indices[p] == index) {
+            planes->indices[p--] = planes->indices[--planes->count];
+        } else if (planes->indices[p] == last) {
+            planes->indices[p] = index;
         }
     }
     
-    return false;
+    world->bodies[index] = world->bodies[last];
+    world->bodies[last] = NULL;
+    world->body_count--;
+    return true;
 }
 
-RigidBody* physics_world_get_body(PhysicsWorld* world, int body_id) {
+RigidBody* physics_world_get_body_by_handle(PhysicsWorld* world, BodyHandle handle) {
     if (!world) return NULL;
     
-    for (int i = 0; i < world->body_count; i++) {
-        if (world->bodies[i] && world->bodies[i]->id == body_id) {
-            return world->bodies[i];
-        }
-    }
+    int index = handle_table_lookup(&world->handles, handle);
+    return index >= 0 ? world->bodies[index] : NULL;
+}
+
+bool physics_world_is_handle_valid(PhysicsWorld* world, BodyHandle handle) {
+    return world && handle_table_lookup(&world->handles, handle) >= 0;
+}
+
+BodyHandle physics_world_get_body_handle(PhysicsWorld* world, int body_id) {
+    if (!world) return body_handle_null();
+    
+    int slot = body_id_map_find(&world->body_ids, body_id);
+    if (slot < 0) return body_handle_null();
     
-    return NULL;
+    BodyHandle handle = { (uint32_t)slot, world->handles.generations[slot] };
+    return handle;
+}
+
+int physics_world_add_body(PhysicsWorld* world, RigidBody* body) {
+    BodyHandle handle = physics_world_add_body_handle(world, body);
+    return body_handle_is_null(handle) ? -1 : body->id;
+}
+
+bool physics_world_remove_body(PhysicsWorld* world, int body_id) {
+    return physics_world_remove_body_by_handle(world, physics_world_get_body_handle(world, body_id));
+}
+
+RigidBody* physics_world_get_body(PhysicsWorld* world, int body_id) {
+    return physics_world_get_body_by_handle(world, physics_world_get_body_handle(world, body_id));
 }
 
 void physics_world_clear_bodies(PhysicsWorld* world) {
     if (!world) return;
     
+    // Bodies from physics_world_create_body go back to the slab, others to the allocator
     for (int i = 0; i < world->body_count; i++) {
-        if (world->bodies[i]) {
-            rigid_body_destroy(world->bodies[i]);
-            world->bodies[i] = NULL;
+        RigidBody* body = world->bodies[i];
+        if (!body) continue;
+        
+        if (body_slab_owns(&world->body_slab, body)) {
+            body_slab_free(&world->body_slab, body);
+        } else {
+            rigid_body_destroy(body);
         }
+        world->bodies[i] = NULL;
     }
     
     world->body_count = 0;
+    world->planes.count = 0;
+    body_pool_clear(&world->pool);
+    handle_table_clear(&world->handles);
+    body_id_map_clear(&world->body_ids);
+    broad_phase_clear(&world->broad_phase);
+    world->waking_count = 0;
+    world->removed_count = 0;
+    world->active_count = 0;
+    world->active_dirty = false;
+    world->dirty_count = 0;
+    
+    // Every cached pair involved a body that is now gone
+    contact_cache_clear(&world->contact_cache);
 }
 
 void physics_world_set_gravity(PhysicsWorld* world, Vector3 gravity) {
@@ -112,188 +494,1685 @@ void physics_world_set_timestep(PhysicsWorld* world, float timestep) {
     }
 }
 
+void physics_world_set_simulation_iterations(PhysicsWorld* world, int iterations) {
+    if (world && iterations > 0) {
+        world->simulation_iterations = iterations;
+    }
+}
+
+void physics_world_set_continuous_collision(PhysicsWorld* world, bool enabled) {
+    if (world) {
+        world->continuous_collision = enabled;
+    }
+}
+
+void physics_world_set_speculative_contacts(PhysicsWorld* world, bool enabled) {
+    if (world) {
+        world->speculative_contacts = enabled;
+    }
+}
+
+bool physics_world_set_adaptive_substeps(PhysicsWorld* world, bool enabled, int min_substeps, int max_substeps) {
+    if (!world || min_substeps < 1 || max_substeps < min_substeps) return false;
+    
+    world->adaptive_substeps = enabled;
+    world->min_substeps = min_substeps;
+    world->max_substeps = max_substeps;
+    return true;
+}
+
 void physics_world_set_integration_method(PhysicsWorld* world, IntegrationMethod method) {
     if (world) {
         world->integration_method = method;
     }
 }
 
-void physics_world_set_damping(PhysicsWorld* world, float linear_damping, float angular_damping) {
-    if (world) {
-        world->linear_damping = fmaxf(0.0f, fminf(1.0f, linear_damping));
-        world->angular_damping = fmaxf(0.0f, fminf(1.0f, angular_damping));
+void physics_world_set_solver_iterations(PhysicsWorld* world, int iterations) {
+    if (world && iterations > 0) {
+        world->solver_iterations = iterations;
     }
 }
 
-void physics_world_step(PhysicsWorld* world) {
+void physics_world_set_warm_starting(PhysicsWorld* world, bool enabled) {
     if (!world) return;
     
-    physics_world_step_with_dt(world, world->timestep);
+    world->warm_starting = enabled;
+    if (!enabled) {
+        contact_cache_clear(&world->contact_cache);
+    }
 }
 
-void physics_world_step_with_dt(PhysicsWorld* world, float dt) {
-    if (!world || world->is_paused || dt <= 0.0f) return;
-    
-    // Apply time scale
-    float scaled_dt = dt * world->time_scale;
+void physics_world_set_damping(PhysicsWorld* world, float linear_damping, float angular_damping) {
+    if (world) {
+        world->linear_damping = fmaxf(0.0f, fminf(1.0f, linear_damping));
+        world->angular_damping = fmaxf(0.0f, fminf(1.0f, angular_damping));
+    }
+}
+
+bool physics_world_set_broad_phase(PhysicsWorld* world, BroadPhaseType type) {
+    if (!world) return false;
+    if (world->broad_phase.type == type) return true;
     
-    // Perform multiple simulation iterations for stability
-    float sub_dt = scaled_dt / (float)world->simulation_iterations;
+    // Rebuild proxies for the bodies already in the world
+    broad_phase_destroy(&world->broad_phase);
+    broad_phase_init(&world->broad_phase, type);
     
-    for (int iter = 0; iter < world->simulation_iterations; iter++) {
-        // Wake up sleeping bodies that might be affected by moving objects
-        physics_world_wake_sleeping_bodies(world);
-        
-        // Apply forces (gravity, user forces, etc.)
-        physics_world_apply_forces(world);
-        
-        // Integrate motion
-        physics_world_integrate_bodies(world, sub_dt);
-        
-        // Detect collisions
-        physics_world_detect_collisions(world);
-        
-        // Resolve collisions
-        physics_world_resolve_collisions(world);
-        
-        // Apply damping
-        for (int i = 0; i < world->body_count; i++) {
-            if (world->bodies[i]) {
-                apply_damping(world->bodies[i], world->linear_damping, world->angular_damping);
-            }
+    for (int i = 0; i < world->body_count; i++) {
+        if (!broad_phase_add_body(&world->broad_phase, &world->pool, i)) {
+            broad_phase_destroy(&world->broad_phase);
+            broad_phase_init(&world->broad_phase, BROAD_PHASE_BRUTE_FORCE);
+            return false;
         }
     }
+    
+    return true;
+}
+
+void physics_world_set_spatial_hash_cell_size(PhysicsWorld* world, float cell_size) {
+    if (world && cell_size >= 0.0f) {
+        // Zero derives the cell size from the bodies on each rebuild
+        world->broad_phase.grid.cell_size = cell_size;
+        spatial_hash_invalidate(&world->broad_phase.grid);
+    }
 }
 
-void physics_world_pause(PhysicsWorld* world, bool paused) {
+void physics_world_set_sleep_time(PhysicsWorld* world, float seconds) {
     if (world) {
-        world->is_paused = paused;
+        world->sleep_time = seconds;
     }
 }
 
-void physics_world_set_time_scale(PhysicsWorld* world, float scale) {
-    if (world && scale >= 0.0f) {
-        world->time_scale = scale;
+void physics_world_set_wake_distance(PhysicsWorld* world, float wake_distance) {
+    if (world && wake_distance >= 0.0f) {
+        world->wake_distance = wake_distance;
     }
 }
 
-void physics_world_detect_collisions(PhysicsWorld* world) {
-    if (!world) return;
+void physics_world_set_reorder_interval(PhysicsWorld* world, int steps) {
+    if (world && steps >= 0) {
+        world->reorder_interval = steps;
+        world->steps_since_reorder = 0;
+    }
+}
+
+bool physics_world_set_local_ids(PhysicsWorld* world, bool enabled) {
+    if (!world || world->body_count > 0) return false;
     
-    world->collision_count = 0;
-    world->collision_checks_performed = 0;
+    world->next_local_id = enabled ? 1 : 0;
+    return true;
+}
+
+bool physics_world_set_thread_count(PhysicsWorld* world, int thread_count) {
+    if (!world || thread_count < 1) return false;
+    if (job_system_get_thread_count(world->job_system) == thread_count) return true;
     
-    // Broad phase: check all pairs of bodies
-    for (int i = 0; i < world->body_count; i++) {
-        for (int j = i + 1; j < world->body_count; j++) {
-            RigidBody* body_a = world->bodies[i];
-            RigidBody* body_b = world->bodies[j];
-            
-            if (!body_a || !body_b) continue;
-            
-            // Skip if both bodies are static
-            if (body_a->is_static && body_b->is_static) continue;
-            
-            // Skip if both bodies are sleeping
-            if (body_a->is_sleeping && body_b->is_sleeping) continue;
-            
-            world->collision_checks_performed++;
-            
-            // Check for collision
-            if (world->collision_count < MAX_COLLISIONS) {
-                CollisionInfo* collision = &world->collisions[world->collision_count];
-                
-                if (detect_collision(body_a, body_b, collision)) {
-                    world->collision_count++;
-                    
-                    // Wake up sleeping bodies involved in collision
-                    body_a->is_sleeping = false;
-                    body_b->is_sleeping = false;
-                }
-            }
-        }
+    job_system_destroy(world->job_system);
+    world->job_system = NULL;
+    
+    if (thread_count > 1) {
+        world->job_system = job_system_create(thread_count);
+        if (!world->job_system) return false;
     }
+    return true;
 }
 
-void physics_world_resolve_collisions(PhysicsWorld* world) {
+int physics_world_get_thread_count(PhysicsWorld* world) {
+    return world ? job_system_get_thread_count(world->job_system) : 1;
+}
+
+void physics_world_set_scheduler(PhysicsWorld* world, const JobScheduler* scheduler) {
     if (!world) return;
     
-    // Resolve all detected collisions
-    for (int i = 0; i < world->collision_count; i++) {
-        resolve_collision(&world->collisions[i]);
+    if (scheduler && scheduler->parallel_for) {
+        world->scheduler = *scheduler;
+    } else {
+        memset(&world->scheduler, 0, sizeof(JobScheduler));
     }
 }
 
-void physics_world_apply_forces(PhysicsWorld* world) {
-    if (!world) return;
-    
-    // Apply gravity to all non-static bodies
-    for (int i = 0; i < world->body_count; i++) {
-        RigidBody* body = world->bodies[i];
-        if (!body || body->is_static || body->is_sleeping) continue;
-        
-        // Apply gravity: F = mg
-        Vector3 gravity_force = vector3_scale(world->gravity, body->mass);
-        rigid_body_add_force(body, gravity_force);
+void physics_world_set_deterministic(PhysicsWorld* world, bool deterministic) {
+    if (world) {
+        world->deterministic = deterministic;
     }
 }
 
-void physics_world_integrate_bodies(PhysicsWorld* world, float dt) {
-    if (!world) return;
+bool physics_world_is_deterministic(PhysicsWorld* world) {
+    return world ? world->deterministic : false;
+}
+
+static inline bool physics_world_is_parallel(const PhysicsWorld* world) {
+    return world->scheduler.parallel_for || job_system_get_thread_count(world->job_system) > 1;
+}
+
+// Run func over the body pool in ranges on whichever scheduler is active
+static void physics_world_parallel_for(PhysicsWorld* world, int count, int grain, JobRangeFunc func,
+                                       void* context) {
+    if (world->scheduler.parallel_for && count > grain) {
+        world->scheduler.parallel_for(world->scheduler.user_data, count, grain, func, context);
+    } else {
+        job_system_parallel_for(world->job_system, count, grain, func, context);
+    }
+}
+
+// Parallel-for contexts for the per-body phases, which run over ranges of
+// the active body list
+typedef struct {
+    BodyPool* pool;
+    const int* bodies;
+    Vector3 gravity;
+} ForceJob;
+
+typedef struct {
+    BodyPool* pool;
+    const int* bodies;
+    float dt;
+    IntegrationMethod method;
+} IntegrateJob;
+
+typedef struct {
+    BodyPool* pool;
+    const int* bodies;
+    float linear_damping;
+    float angular_damping;
+} DampingJob;
+
+static void physics_world_force_range(void* context, int begin, int end) {
+    ForceJob* job = (ForceJob*)context;
+    BodyPool* pool = job->pool;
     
-    for (int i = 0; i < world->body_count; i++) {
-        RigidBody* body = world->bodies[i];
-        if (!body || body->is_static) continue;
+    // Apply gravity to the awake dynamic bodies
+    for (int k = begin; k < end; k++) {
+        int i = job->bodies[k];
         
-        integrate_body(body, dt, world->integration_method);
+        // Apply gravity: F = mg
+        Vector3 gravity_force = vector3_scale(job->gravity, pool->mass[i]);
+        pool->force[i] = vector3_add(pool->force[i], gravity_force);
     }
 }
 
-void physics_world_wake_sleeping_bodies(PhysicsWorld* world) {
-    if (!world) return;
+static void physics_world_integrate_range(void* context, int begin, int end) {
+    IntegrateJob* job = (IntegrateJob*)context;
+    integrate_pool_list(job->pool, job->bodies + begin, end - begin, job->dt, job->method);
+}
+
+static void physics_world_damping_range(void* context, int begin, int end) {
+    DampingJob* job = (DampingJob*)context;
+    apply_damping_pool_list(job->pool, job->bodies + begin, end - begin, job->linear_damping,
+                            job->angular_damping);
+}
+
+// Put islands to sleep whose bodies have all rested for sleep_time. Islands
+// are joined through the last substep's contacts between awake dynamic
+// bodies; static bodies never join two islands.
+static void physics_world_update_sleep(PhysicsWorld* world, float dt) {
+    if (world->sleep_time <= 0.0f) return;
     
-    // Simple approach: wake all bodies within a certain distance of moving bodies
-    const float wake_distance = 5.0f;
+    BodyPool* pool = &world->pool;
+    IslandSet* islands = &world->islands;
+    if (!island_set_reserve(islands, pool->count)) return;
     
-    for (int i = 0; i < world->body_count; i++) {
-        RigidBody* moving_body = world->bodies[i];
-        if (!moving_body || moving_body->is_static || moving_body->is_sleeping) continue;
+    physics_world_refresh_active_bodies(world);
+    int* active = world->active_bodies;
+    const uint8_t inert = BODY_FLAG_STATIC | BODY_FLAG_SLEEPING;
+    const float rest_speed_sq = PHYSICS_WORLD_SLEEP_SPEED * PHYSICS_WORLD_SLEEP_SPEED;
+    
+    for (int k = 0; k < world->active_count; k++) {
+        int i = active[k];
+        island_set_add(islands, i);
         
-        // Check if this body is moving fast enough to wake others
-        float speed_sq = vector3_length_squared(moving_body->velocity);
-        if (speed_sq < 0.1f) continue;
+        if (vector3_length_squared(pool->velocity[i]) < rest_speed_sq &&
+            vector3_length_squared(pool->angular_velocity[i]) < rest_speed_sq) {
+            pool->sleep_time[i] += dt;
+        } else {
+            pool->sleep_time[i] = 0.0f;
+        }
+    }
+    
+    for (int c = 0; c < world->contact_count; c++) {
+        int a = (int)world->contacts[c].index_a;
+        int b = (int)world->contacts[c].index_b;
+        if (!(pool->flags[a] & inert) && !(pool->flags[b] & inert)) {
+            island_set_union(islands, a, b);
+        }
+    }
+    
+    // An island rests as long as its most recently moving body
+    for (int k = 0; k < world->active_count; k++) {
+        int i = active[k];
+        int root = island_set_find(islands, i);
+        if (pool->sleep_time[i] < islands->rest_time[root]) {
+            islands->rest_time[root] = pool->sleep_time[i];
+        }
+    }
+    
+    // Sleeping bodies leave the active list here, which keeps its order
+    int awake = 0;
+    for (int k = 0; k < world->active_count; k++) {
+        int i = active[k];
+        int root = island_set_find(islands, i);
+        if (islands->rest_time[root] < world->sleep_time) {
+            active[awake++] = i;
+            continue;
+        }
         
-        for (int j = 0; j < world->body_count; j++) {
-            if (i == j) continue;
-            
-            RigidBody* sleeping_body = world->bodies[j];
-            if (!sleeping_body || !sleeping_body->is_sleeping) continue;
-            
-            float distance = vector3_distance(moving_body->position, sleeping_body->position);
-            if (distance < wake_distance) {
-                sleeping_body->is_sleeping = false;
+        // Ids only tell islands apart while they sleep, so wrapping is harmless; 0 means none
+        if (islands->sleep_id[root] == 0) {
+            if (++world->next_island_id == 0) {
+                world->next_island_id = 1;
             }
+            islands->sleep_id[root] = world->next_island_id;
         }
+        
+        pool->flags[i] |= BODY_FLAG_SLEEPING;
+        pool->island[i] = islands->sleep_id[root];
+        pool->velocity[i] = vector3_zero();
+        pool->angular_velocity[i] = vector3_zero();
+        
+        // Stores only visit awake bodies, so the final state is written back now
+        body_pool_store(pool, i, world->bodies[i]);
     }
+    world->active_count = awake;
 }
 
-int physics_world_get_body_count(PhysicsWorld* world) {
-    return world ? world->body_count : 0;
-}
-
-int physics_world_get_collision_count(PhysicsWorld* world) {
-    return world ? world->collision_count : 0;
+// Sphere radius or smallest box half extent: how far a body can move before
+// it may pass through something as thin as itself
+static inline float physics_world_min_extent(const BodyPool* pool, int index) {
+    if (pool->shape_type[index] == SHAPE_SPHERE) {
+        return pool->shape[index].sphere.radius;
+    }
+    Vector3 half = pool->shape[index].aabb.half_extents;
+    return fminf(half.x, fminf(half.y, half.z));
 }
 
-float physics_world_get_total_kinetic_energy(PhysicsWorld* world) {
-    if (!world) return 0.0f;
+// Largest speed of an awake body over its smallest half extent, i.e. how
+// many of its own half extents it crosses per second
+static float physics_world_max_speed_ratio(const PhysicsWorld* world) {
+    const BodyPool* pool = &world->pool;
+    float max_ratio_sq = 0.0f;
     
-    float total_energy = 0.0f;
-    for (int i = 0; i < world->body_count; i++) {
-        if (world->bodies[i]) {
-            total_energy += rigid_body_get_kinetic_energy(world->bodies[i]);
+    for (int k = 0; k < world->active_count; k++) {
+        int i = world->active_bodies[k];
+        
+        float extent = physics_world_min_extent(pool, i);
+        if (extent <= 0.0f) continue;
+        
+        float ratio_sq = vector3_length_squared(pool->velocity[i]) / (extent * extent);
+        if (ratio_sq > max_ratio_sq) {
+            max_ratio_sq = ratio_sq;
         }
     }
     
-    return total_energy;
-}
\ No newline at end of file
+    return sqrtf(max_ratio_sq);
+}
+
+// Substeps for an adaptive step of length dt. Penetration shrinks roughly in
+// proportion to the substep length, so the last step's count is scaled by
+// how far its deepest contact overshot the tolerance; a calm step scales it
+// back down the same way. Steps where everything slept ran no substeps and
+// found no contacts, so the last step that did run is used instead.
+static int physics_world_choose_substeps(const PhysicsWorld* world, float dt, float speed_ratio) {
+    const PhysicsStepStats* last = &world->last_simulated;
+    float by_speed = speed_ratio * dt / PHYSICS_WORLD_SUBSTEP_TRAVEL;
+    float by_penetration = (float)last->substeps * last->max_penetration / PHYSICS_WORLD_SUBSTEP_PENETRATION;
+    float needed = fmaxf(by_speed, by_penetration);
+    
+    if (needed >= (float)world->max_substeps) return world->max_substeps;
+    
+    int substeps = (int)ceilf(needed);
+    return substeps > world->min_substeps ? substeps : world->min_substeps;
+}
+
+// Before integrating a substep of length dt, note where bodies start that
+// might move fast enough to tunnel. Speed is bounded by the current velocity
+// plus what the accumulated force adds over the substep.
+static void physics_world_begin_sweep(PhysicsWorld* world, float dt) {
+    world->swept_count = 0;
+    if (!world->continuous_collision) return;
+    
+    const BodyPool* pool = &world->pool;
+    for (int k = 0; k < world->active_count; k++) {
+        int i = world->active_bodies[k];
+        
+        float speed = vector3_length(pool->velocity[i]) + vector3_length(pool->force[i]) * pool->inverse_mass[i] * dt;
+        float allowed = PHYSICS_WORLD_SUBSTEP_TRAVEL * physics_world_min_extent(pool, i);
+        if (speed * dt <= allowed) continue;
+        
+        // Without room the body is simply not swept this substep
+        if (!physics_ensure_capacity((void**)&world->swept_bodies, &world->swept_capacity, world->swept_count + 1,
+                                     sizeof(SweptBody))) {
+            return;
+        }
+        world->swept_bodies[world->swept_count].index = i;
+        world->swept_bodies[world->swept_count].start = pool->position[i];
+        world->swept_count++;
+    }
+}
+
+// One swept body's path while its candidates are tested
+typedef struct {
+    const BodyPool* pool;
+    int index;
+    Vector3 start;
+    Vector3 displacement;
+    Vector3 sweep_min;
+    Vector3 sweep_max;
+    float first;               // Earliest time of impact so far, 1 when none
+    bool hit;
+} SweepQuery;
+
+static bool physics_world_sweep_callback(void* context, int j) {
+    SweepQuery* query = (SweepQuery*)context;
+    const BodyPool* pool = query->pool;
+    if (j == query->index) return true;
+    
+    Vector3 min, max;
+    body_pool_get_aabb(pool, j, &min, &max);
+    if (min.x > query->sweep_max.x || max.x < query->sweep_min.x || min.y > query->sweep_max.y ||
+        max.y < query->sweep_min.y || min.z > query->sweep_max.z || max.z < query->sweep_min.z) {
+        return true;
+    }
+    
+    int i = query->index;
+    float toi;
+    if (sweep_shapes((ShapeType)pool->shape_type[i], &pool->shape[i], query->start, query->displacement,
+                     (ShapeType)pool->shape_type[j], &pool->shape[j], pool->position[j], &toi) &&
+        toi < query->first) {
+        query->first = toi;
+        query->hit = true;
+    }
+    return true;
+}
+
+// After integrating, move each swept body that travelled too far back to its
+// first impact along the path, just inside what it hit, and return how many
+// were stopped. Other bodies are taken at their end positions. Candidates
+// come from the broad phase's grid, rebuilt once over the end positions,
+// plus the swept bodies already stopped, which have moved since.
+static int physics_world_sweep_bodies(PhysicsWorld* world) {
+    if (world->swept_count == 0) return 0;
+    
+    BodyPool* pool = &world->pool;
+    const PlaneList* planes = &world->planes;
+    SpatialHash* grid = &world->broad_phase.grid;
+    bool has_grid = spatial_hash_build(grid, pool);
+    int impacts = 0;
+    
+    for (int s = 0; s < world->swept_count; s++) {
+        SweptBody* swept = &world->swept_bodies[s];
+        int i = swept->index;
+        swept->stopped = false;
+        
+        SweepQuery query;
+        query.pool = pool;
+        query.index = i;
+        query.start = swept->start;
+        query.displacement = vector3_subtract(pool->position[i], swept->start);
+        query.first = 1.0f;
+        query.hit = false;
+        
+        float distance = vector3_length(query.displacement);
+        if (distance <= PHYSICS_WORLD_SUBSTEP_TRAVEL * physics_world_min_extent(pool, i)) continue;
+        
+        ShapeType type = (ShapeType)pool->shape_type[i];
+        const CollisionShape* shape = &pool->shape[i];
+        float toi;
+        
+        for (int p = 0; p < planes->count; p++) {
+            int plane = planes->indices[p];
+            if (sweep_shapes(type, shape, query.start, query.displacement, SHAPE_PLANE, &pool->shape[plane],
+                             pool->position[plane], &toi) && toi < query.first) {
+                query.first = toi;
+                query.hit = true;
+            }
+        }
+        
+        Vector3 start_min, start_max, end_min, end_max;
+        shape_get_aabb(type, shape, query.start, &start_min, &start_max);
+        body_pool_get_aabb(pool, i, &end_min, &end_max);
+        query.sweep_min = vector3_create(fminf(start_min.x, end_min.x), fminf(start_min.y, end_min.y),
+                                         fminf(start_min.z, end_min.z));
+        query.sweep_max = vector3_create(fmaxf(start_max.x, end_max.x), fmaxf(start_max.y, end_max.y),
+                                         fmaxf(start_max.z, end_max.z));
+        
+        if (has_grid) {
+            spatial_hash_query_aabb(grid, pool, query.sweep_min, query.sweep_max,
+                                    physics_world_sweep_callback, &query);
+            for (int k = 0; k < s; k++) {
+                if (world->swept_bodies[k].stopped) {
+                    physics_world_sweep_callback(&query, world->swept_bodies[k].index);
+                }
+            }
+        } else {
+            for (int j = 0; j < pool->count; j++) {
+                if (pool->shape_type[j] != SHAPE_PLANE) {
+                    physics_world_sweep_callback(&query, j);
+                }
+            }
+        }
+        
+        if (query.hit) {
+            float t = fminf(query.first + PHYSICS_WORLD_SWEEP_DEPTH / distance, 1.0f);
+            pool->position[i] = vector3_add(query.start, vector3_scale(query.displacement, t));
+            swept->stopped = true;
+            impacts++;
+        }
+    }
+    
+    return impacts;
+}
+
+static float physics_world_max_penetration(const PhysicsWorld* world) {
+    float max_penetration = 0.0f;
+    for (int c = 0; c < world->contact_count; c++) {
+        if (world->contacts[c].penetration_depth > max_penetration) {
+            max_penetration = world->contacts[c].penetration_depth;
+        }
+    }
+    return max_penetration;
+}
+
+static int physics_world_count_speculative(const PhysicsWorld* world) {
+    int count = 0;
+    for (int c = 0; c < world->contact_count; c++) {
+        count += world->contacts[c].penetration_depth < 0.0f;
+    }
+    return count;
+}
+
+void physics_world_step(PhysicsWorld* world) {
+    if (!world) return;
+    
+    physics_world_step_with_dt(world, world->timestep);
+}
+
+static void physics_world_run_step(PhysicsWorld* world, float dt) {
+    // Commands are applied even while paused so the queue keeps draining
+    physics_world_apply_commands(world);
+    
+    if (world->is_paused || dt <= 0.0f) return;
+    
+    // Apply time scale
+    float scaled_dt = dt * world->time_scale;
+    
+    // Pick up any changes made through the RigidBody structs since the last step
+    physics_world_load_bodies(world);
+    
+    // Periodically restore spatial locality in body storage
+    if (world->reorder_interval > 0 && ++world->steps_since_reorder >= world->reorder_interval) {
+        physics_world_reorder_bodies(world);
+        world->steps_since_reorder = 0;
+    }
+    
+    // Nothing moves while every island sleeps, so the substeps are skipped
+    physics_world_refresh_active_bodies(world);
+    float speed_ratio = physics_world_max_speed_ratio(world);
+    int iterations = 0;
+    if (world->active_count > 0) {
+        iterations = world->adaptive_substeps ? physics_world_choose_substeps(world, scaled_dt, speed_ratio)
+                                              : world->simulation_iterations;
+    } else {
+        world->contact_count = 0;
+    }
+    
+    // Perform multiple simulation iterations for stability
+    float sub_dt = iterations > 0 ? scaled_dt / (float)iterations : scaled_dt;
+    
+    // Tree leaves are stretched along the motion expected over one substep,
+    // and speculative contacts look ahead as far
+    world->broad_phase.prediction_time = sub_dt;
+    world->speculative_time = world->speculative_contacts ? sub_dt : 0.0f;
+    world->broad_phase.speculative_time = world->speculative_time;
+    
+    float max_penetration = 0.0f;
+    int swept_impacts = 0;
+    int speculative = 0;
+    for (int iter = 0; iter < iterations; iter++) {
+        // Apply forces (gravity, user forces, etc.)
+        physics_world_apply_forces(world);
+        
+        // Integrate motion, stopping fast bodies at their first impact
+        physics_world_begin_sweep(world, sub_dt);
+        physics_world_integrate_bodies(world, sub_dt);
+        swept_impacts += physics_world_sweep_bodies(world);
+        
+        // Detect collisions
+        physics_world_detect_collisions(world);
+        max_penetration = fmaxf(max_penetration, physics_world_max_penetration(world));
+        if (world->speculative_time > 0.0f) {
+            speculative += physics_world_count_speculative(world);
+        }
+        
+        // Resolve collisions
+        physics_world_resolve_collisions(world);
+        
+        // Apply damping
+        physics_world_refresh_active_bodies(world);
+        DampingJob damping = { &world->pool, world->active_bodies, world->linear_damping, world->angular_damping };
+        physics_world_parallel_for(world, world->active_count, PHYSICS_WORLD_BODY_GRAIN, physics_world_damping_range,
+                                   &damping);
+    }
+    
+    if (iterations > 0) {
+        physics_world_update_sleep(world, scaled_dt);
+    }
+    
+    world->step_stats.substeps = iterations;
+    world->step_stats.max_speed_ratio = speed_ratio;
+    world->step_stats.max_penetration = max_penetration;
+    world->step_stats.swept_impacts = swept_impacts;
+    world->step_stats.speculative_contacts = speculative;
+    if (iterations > 0) {
+        world->last_simulated = world->step_stats;
+    }
+    
+    physics_world_store_bodies(world);
+    world->step_count++;
+    
+    if (world->body_states) {
+        body_state_buffers_publish(world->body_states, &world->pool, &world->handles, world->bodies,
+                                   world->step_count);
+    }
+}
+
+void physics_world_step_with_dt(PhysicsWorld* world, float dt) {
+    if (!world) return;
+    
+    physics_world_wait(world, world->step_fence);
+    physics_world_run_step(world, dt);
+}
+
+static bool physics_world_push_command(PhysicsWorld* world, BodyCommandType type, BodyHandle handle,
+                                       RigidBody* body, Vector3 value) {
+    if (!world) return false;
+    
+    BodyCommand command;
+    command.type = type;
+    command.handle = handle;
+    command.body = body;
+    command.value = value;
+    return command_queue_push(&world->commands, &command);
+}
+
+bool physics_world_queue_spawn(PhysicsWorld* world, RigidBody* body) {
+    if (!body) return false;
+    return physics_world_push_command(world, BODY_COMMAND_SPAWN, body_handle_null(), body, vector3_zero());
+}
+
+bool physics_world_queue_despawn(PhysicsWorld* world, BodyHandle handle) {
+    return physics_world_push_command(world, BODY_COMMAND_DESPAWN, handle, NULL, vector3_zero());
+}
+
+bool physics_world_queue_teleport(PhysicsWorld* world, BodyHandle handle, Vector3 position) {
+    return physics_world_push_command(world, BODY_COMMAND_TELEPORT, handle, NULL, position);
+}
+
+bool physics_world_queue_impulse(PhysicsWorld* world, BodyHandle handle, Vector3 impulse) {
+    return physics_world_push_command(world, BODY_COMMAND_IMPULSE, handle, NULL, impulse);
+}
+
+bool physics_world_queue_force(PhysicsWorld* world, BodyHandle handle, Vector3 force) {
+    return physics_world_push_command(world, BODY_COMMAND_FORCE, handle, NULL, force);
+}
+
+// Drain the queue into one batch per command type
+static void physics_world_drain_commands(PhysicsWorld* world) {
+    int capacity = command_queue_get_capacity(&world->commands);
+    BodyCommand command;
+    
+    // Stop after one queue's worth so producers pushing now can't keep the step here
+    for (int n = 0; n < capacity && command_queue_pop(&world->commands, &command); n++) {
+        CommandBatch* batch = &world->command_batches[command.type];
+        if (!physics_ensure_capacity((void**)&batch->commands, &batch->capacity, batch->count + 1,
+                                     sizeof(BodyCommand))) {
+            // Out of memory: the command is lost, but a spawned body must not leak
+            if (command.type == BODY_COMMAND_SPAWN) {
+                physics_world_destroy_body(world, command.body);
+            }
+            continue;
+        }
+        batch->commands[batch->count++] = command;
+    }
+}
+
+// Wake a body a command edited. Loads skip sleeping bodies unless they are
+// marked dirty, so the edit would otherwise go unseen.
+static void physics_world_wake_commanded(PhysicsWorld* world, BodyHandle handle, RigidBody* body) {
+    if (body->is_sleeping) {
+        body->is_sleeping = false;
+        physics_world_mark_body_dirty(world, handle);
+    }
+}
+
+void physics_world_apply_commands(PhysicsWorld* world) {
+    if (!world) return;
+    
+    physics_world_drain_commands(world);
+    
+    CommandBatch* batches = world->command_batches;
+    
+    for (int c = 0; c < batches[BODY_COMMAND_DESPAWN].count; c++) {
+        RigidBody* body = physics_world_get_body_by_handle(world, batches[BODY_COMMAND_DESPAWN].commands[c].handle);
+        if (body) {
+            physics_world_destroy_body(world, body);
+        }
+    }
+    
+    for (int c = 0; c < batches[BODY_COMMAND_SPAWN].count; c++) {
+        RigidBody* body = batches[BODY_COMMAND_SPAWN].commands[c].body;
+        if (body_handle_is_null(physics_world_add_body_handle(world, body))) {
+            physics_world_destroy_body(world, body);
+        }
+    }
+    
+    // The rest edit the user-facing bodies, which the step then loads
+    for (int c = 0; c < batches[BODY_COMMAND_TELEPORT].count; c++) {
+        const BodyCommand* command = &batches[BODY_COMMAND_TELEPORT].commands[c];
+        RigidBody* body = physics_world_get_body_by_handle(world, command->handle);
+        if (body && !body->is_static) {
+            body->position = command->value;
+            physics_world_wake_commanded(world, command->handle, body);
+        }
+    }
+    
+    for (int c = 0; c < batches[BODY_COMMAND_IMPULSE].count; c++) {
+        const BodyCommand* command = &batches[BODY_COMMAND_IMPULSE].commands[c];
+        RigidBody* body = physics_world_get_body_by_handle(world, command->handle);
+        if (body && !body->is_static) {
+            rigid_body_add_impulse(body, command->value);
+            physics_world_wake_commanded(world, command->handle, body);
+        }
+    }
+    
+    for (int c = 0; c < batches[BODY_COMMAND_FORCE].count; c++) {
+        const BodyCommand* command = &batches[BODY_COMMAND_FORCE].commands[c];
+        RigidBody* body = physics_world_get_body_by_handle(world, command->handle);
+        if (body && !body->is_static) {
+            rigid_body_add_force(body, command->value);
+            physics_world_wake_commanded(world, command->handle, body);
+        }
+    }
+    
+    for (int t = 0; t < BODY_COMMAND_TYPE_COUNT; t++) {
+        batches[t].count = 0;
+    }
+}
+
+bool physics_world_set_command_capacity(PhysicsWorld* world, int capacity) {
+    if (!world || capacity < 1) return false;
+    
+    physics_world_wait(world, world->step_fence);
+    physics_world_apply_commands(world);
+    
+    CommandQueue queue;
+    if (!command_queue_init(&queue, capacity)) return false;
+    
+    command_queue_destroy(&world->commands);
+    world->commands = queue;
+    return true;
+}
+
+static void physics_world_async_step(void* context) {
+    PhysicsWorld* world = (PhysicsWorld*)context;
+    physics_world_run_step(world, world->async_dt);
+}
+
+PhysicsFence physics_world_step_async(PhysicsWorld* world) {
+    return world ? physics_world_step_async_with_dt(world, world->timestep) : 0;
+}
+
+PhysicsFence physics_world_step_async_with_dt(PhysicsWorld* world, float dt) {
+    if (!world) return 0;
+    
+    if (!world->step_task) {
+        // Start with the current state as the front snapshot
+        world->body_states = body_state_buffers_create();
+        world->step_task = world->body_states ? job_task_create() : NULL;
+        if (!world->step_task ||
+            !body_state_buffers_publish(world->body_states, &world->pool, &world->handles, world->bodies,
+                                        world->step_count)) {
+            job_task_destroy(world->step_task);
+            body_state_buffers_destroy(world->body_states);
+            world->step_task = NULL;
+            world->body_states = NULL;
+            
+            // No thread to run on: step here, already complete
+            physics_world_run_step(world, dt);
+            return 0;
+        }
+    }
+    
+    // The running step reads async_dt, so only change it once that step is done
+    physics_world_wait(world, world->step_fence);
+    world->async_dt = dt;
+    world->step_fence = job_task_submit(world->step_task, physics_world_async_step, world);
+    return world->step_fence;
+}
+
+bool physics_world_is_step_complete(PhysicsWorld* world, PhysicsFence fence) {
+    return world ? job_task_is_complete(world->step_task, fence) : true;
+}
+
+void physics_world_wait(PhysicsWorld* world, PhysicsFence fence) {
+    if (world) {
+        job_task_wait(world->step_task, fence);
+    }
+}
+
+const BodyStateSnapshot* physics_world_acquire_state(PhysicsWorld* world) {
+    return world ? body_state_buffers_acquire(world->body_states) : NULL;
+}
+
+void physics_world_release_state(PhysicsWorld* world, const BodyStateSnapshot* snapshot) {
+    if (world) {
+        body_state_buffers_release(world->body_states, snapshot);
+    }
+}
+
+// A body woken through its RigidBody (by the user or a command) wakes its island
+static void physics_world_load_body(PhysicsWorld* world, int index) {
+    BodyPool* pool = &world->pool;
+    uint8_t flags = pool->flags[index];
+    body_pool_load(pool, index, world->bodies[index]);
+    
+    if (pool->flags[index] != flags) {
+        world->active_dirty = true;
+        if ((flags & BODY_FLAG_SLEEPING) && !body_pool_is_sleeping(pool, index)) {
+            physics_world_wake_body(world, index);
+        }
+    }
+}
+
+// Bounds a removed body reached, grown by the wake margin
+typedef struct {
+    PhysicsWorld* world;
+    Vector3 min;
+    Vector3 max;
+} RemovalWakeQuery;
+
+static bool physics_world_removal_wake_callback(void* context, int body_index) {
+    RemovalWakeQuery* query = (RemovalWakeQuery*)context;
+    PhysicsWorld* world = query->world;
+    if (!body_pool_is_sleeping(&world->pool, body_index)) return true;
+    
+    Vector3 min, max;
+    body_pool_get_aabb(&world->pool, body_index, &min, &max);
+    if (min.x <= query->max.x && max.x >= query->min.x && min.y <= query->max.y && max.y >= query->min.y &&
+        min.z <= query->max.z && max.z >= query->min.z) {
+        physics_world_wake_body(world, body_index);
+    }
+    return true;
+}
+
+// Wake sleeping bodies touching the bodies removed since the last load. The
+// grid is built once for all of them; removed planes test every body.
+static void physics_world_wake_removal_neighbors(PhysicsWorld* world) {
+    if (world->removed_count == 0) return;
+    
+    BodyPool* pool = &world->pool;
+    SpatialHash* grid = &world->broad_phase.grid;
+    bool has_grid = spatial_hash_build(grid, pool);
+    const float margin = PHYSICS_WORLD_REMOVAL_WAKE_MARGIN;
+    
+    for (int r = 0; r < world->removed_count; r++) {
+        const RemovedBody* removed = &world->removed_bodies[r];
+        
+        if (removed->shape_type == SHAPE_PLANE) {
+            Vector3 normal = removed->shape.plane.normal;
+            for (int i = 0; i < pool->count; i++) {
+                if (!body_pool_is_sleeping(pool, i)) continue;
+                
+                // Distance from the plane to the nearest corner of the bounds
+                Vector3 min, max;
+                body_pool_get_aabb(pool, i, &min, &max);
+                Vector3 center = vector3_scale(vector3_add(min, max), 0.5f);
+                Vector3 half = vector3_scale(vector3_subtract(max, min), 0.5f);
+                float reach = fabsf(normal.x) * half.x + fabsf(normal.y) * half.y + fabsf(normal.z) * half.z;
+                if (vector3_dot(normal, center) - removed->shape.plane.distance - reach <= margin) {
+                    physics_world_wake_body(world, i);
+                }
+            }
+            continue;
+        }
+        
+        RemovalWakeQuery query;
+        query.world = world;
+        shape_get_aabb(removed->shape_type, &removed->shape, removed->position, &query.min, &query.max);
+        query.min = vector3_subtract(query.min, vector3_create(margin, margin, margin));
+        query.max = vector3_add(query.max, vector3_create(margin, margin, margin));
+        
+        if (has_grid) {
+            spatial_hash_query_aabb(grid, pool, query.min, query.max, physics_world_removal_wake_callback, &query);
+        } else {
+            for (int i = 0; i < pool->count; i++) {
+                physics_world_removal_wake_callback(&query, i);
+            }
+        }
+    }
+    
+    world->removed_count = 0;
+}
+
+void physics_world_load_bodies(PhysicsWorld* world) {
+    if (!world) return;
+    
+    if (!world->tracked_edits) {
+        for (int i = 0; i < world->pool.count; i++) {
+            physics_world_load_body(world, i);
+        }
+    } else {
+        // Flag changes only mark the active list stale, so it can be walked meanwhile
+        physics_world_refresh_active_bodies(world);
+        for (int k = 0; k < world->active_count; k++) {
+            physics_world_load_body(world, world->active_bodies[k]);
+        }
+        
+        for (int d = 0; d < world->dirty_count; d++) {
+            int index = handle_table_lookup(&world->handles, world->dirty_bodies[d]);
+            if (index >= 0) {
+                physics_world_load_body(world, index);
+            }
+        }
+    }
+    world->dirty_count = 0;
+    
+    physics_world_wake_removal_neighbors(world);
+    physics_world_wake_islands(world);
+}
+
+void physics_world_set_tracked_edits(PhysicsWorld* world, bool enabled) {
+    if (world) {
+        world->tracked_edits = enabled;
+    }
+}
+
+bool physics_world_mark_body_dirty(PhysicsWorld* world, BodyHandle handle) {
+    if (!world || handle_table_lookup(&world->handles, handle) < 0) return false;
+    
+    if (!physics_ensure_capacity((void**)&world->dirty_bodies, &world->dirty_capacity, world->dirty_count + 1,
+                                 sizeof(BodyHandle))) {
+        return false;
+    }
+    world->dirty_bodies[world->dirty_count++] = handle;
+    return true;
+}
+
+void physics_world_store_bodies(PhysicsWorld* world) {
+    if (!world) return;
+    
+    // Static and sleeping bodies don't change, so only awake ones are written
+    physics_world_refresh_active_bodies(world);
+    for (int k = 0; k < world->active_count; k++) {
+        int i = world->active_bodies[k];
+        body_pool_store(&world->pool, i, world->bodies[i]);
+    }
+}
+
+void physics_world_pause(PhysicsWorld* world, bool paused) {
+    if (world) {
+        world->is_paused = paused;
+    }
+}
+
+void physics_world_set_time_scale(PhysicsWorld* world, float scale) {
+    if (world && scale >= 0.0f) {
+        world->time_scale = scale;
+    }
+}
+
+// Body index paired with its Morton code for sorting
+typedef struct {
+    uint32_t code;
+    int index;
+} MortonKey;
+
+// Spread the low 10 bits of v so there are two zero bits between each
+static inline uint32_t morton_expand_bits(uint32_t v) {
+    v &= 0x3FFu;
+    v = (v | (v << 16)) & 0x030000FFu;
+    v = (v | (v << 8)) & 0x0300F00Fu;
+    v = (v | (v << 4)) & 0x030C30C3u;
+    v = (v | (v << 2)) & 0x09249249u;
+    return v;
+}
+
+static inline uint32_t morton_quantize(float value, float min, float scale) {
+    float q = (value - min) * scale;
+    return q <= 0.0f ? 0u : (q >= 1023.0f ? 1023u : (uint32_t)q);
+}
+
+// Ties keep the current order so sorting settled scenes changes nothing
+static int morton_key_compare(const void* a, const void* b) {
+    const MortonKey* key_a = (const MortonKey*)a;
+    const MortonKey* key_b = (const MortonKey*)b;
+    if (key_a->code != key_b->code) return key_a->code < key_b->code ? -1 : 1;
+    return (key_a->index > key_b->index) - (key_a->index < key_b->index);
+}
+
+bool physics_world_reorder_bodies(PhysicsWorld* world) {
+    if (!world) return false;
+    
+    BodyPool* pool = &world->pool;
+    int count = world->body_count;
+    if (count < 2) return true;
+    
+    // Quantize positions within the bounds of the finite bodies
+    Vector3 min = vector3_create(FLT_MAX, FLT_MAX, FLT_MAX);
+    Vector3 max = vector3_create(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+    for (int i = 0; i < count; i++) {
+        if (pool->shape_type[i] == SHAPE_PLANE) continue;
+        
+        Vector3 p = pool->position[i];
+        min = vector3_create(fminf(min.x, p.x), fminf(min.y, p.y), fminf(min.z, p.z));
+        max = vector3_create(fmaxf(max.x, p.x), fmaxf(max.y, p.y), fmaxf(max.z, p.z));
+    }
+    if (min.x > max.x) return true;
+    
+    Vector3 extent = vector3_subtract(max, min);
+    float scale_x = extent.x > 0.0f ? 1023.0f / extent.x : 0.0f;
+    float scale_y = extent.y > 0.0f ? 1023.0f / extent.y : 0.0f;
+    float scale_z = extent.z > 0.0f ? 1023.0f / extent.z : 0.0f;
+    
+    // One block holds the keys, the new order, the old-to-new map and the permute scratch
+    size_t scratch_size = body_pool_permute_scratch_size(pool);
+    if (scratch_size < (size_t)count * sizeof(RigidBody*)) {
+        scratch_size = (size_t)count * sizeof(RigidBody*);
+    }
+    size_t keys_size = (size_t)count * sizeof(MortonKey);
+    size_t map_size = (size_t)count * sizeof(int);
+    size_t block_size = keys_size + 2 * map_size + scratch_size;
+    
+    char* block = (char*)physics_alloc(block_size);
+    if (!block) return false;
+    
+    MortonKey* keys = (MortonKey*)block;
+    int* order = (int*)(block + keys_size);
+    int* remap = (int*)(block + keys_size + map_size);
+    void* scratch = block + keys_size + 2 * map_size;
+    
+    for (int i = 0; i < count; i++) {
+        keys[i].index = i;
+        
+        // Planes have no meaningful position; keep them at the end
+        if (pool->shape_type[i] == SHAPE_PLANE) {
+            keys[i].code = UINT32_MAX;
+            continue;
+        }
+        
+        Vector3 p = pool->position[i];
+        keys[i].code = morton_expand_bits(morton_quantize(p.x, min.x, scale_x)) |
+                       (morton_expand_bits(morton_quantize(p.y, min.y, scale_y)) << 1) |
+                       (morton_expand_bits(morton_quantize(p.z, min.z, scale_z)) << 2);
+    }
+    
+    qsort(keys, (size_t)count, sizeof(MortonKey), morton_key_compare);
+    
+    bool changed = false;
+    for (int i = 0; i < count; i++) {
+        order[i] = keys[i].index;
+        remap[keys[i].index] = i;
+        changed |= order[i] != i;
+    }
+    
+    if (changed) {
+        body_pool_permute(pool, order, scratch);
+        handle_table_permute(&world->handles, order, (int*)scratch);
+        broad_phase_permute(&world->broad_phase, order, (int*)scratch);
+        world->active_dirty = true;
+        
+        RigidBody** bodies = (RigidBody**)scratch;
+        for (int i = 0; i < count; i++) {
+            bodies[i] = world->bodies[order[i]];
+        }
+        memcpy(world->bodies, bodies, (size_t)count * sizeof(RigidBody*));
+        
+        for (int p = 0; p < world->planes.count; p++) {
+            world->planes.indices[p] = remap[world->planes.indices[p]];
+        }
+        
+        // Contacts from the last detection stay readable
+        for (int i = 0; i < world->contact_count; i++) {
+            world->contacts[i].index_a = (uint32_t)remap[world->contacts[i].index_a];
+            world->contacts[i].index_b = (uint32_t)remap[world->contacts[i].index_b];
+        }
+    }
+    
+    physics_free(block, block_size);
+    return true;
+}
+
+// Next free contact in a block's buffer, or NULL if the buffer could not grow
+static Contact* contact_block_next(ContactBlock* block) {
+    if (!physics_ensure_capacity_aligned((void**)&block->contacts, &block->capacity, block->count + 1,
+                                         sizeof(Contact), CONTACT_ALIGNMENT)) {
+        return NULL;
+    }
+    return &block->contacts[block->count];
+}
+
+// Make sure there is a contact block for every block of narrow-phase work
+static bool physics_world_reserve_contact_blocks(PhysicsWorld* world, int block_count) {
+    int old_capacity = world->contact_block_capacity;
+    if (!physics_ensure_capacity((void**)&world->contact_blocks, &world->contact_block_capacity, block_count,
+                                 sizeof(ContactBlock))) {
+        return false;
+    }
+    
+    memset(world->contact_blocks + old_capacity, 0,
+           (size_t)(world->contact_block_capacity - old_capacity) * sizeof(ContactBlock));
+    return true;
+}
+
+// Narrow phase for a single candidate pair of pool slots. Sleep flags are
+// only read here; bodies are woken when the blocks are merged. When
+// speculating, pairs are reported while their gap is within what their
+// relative speed could close in the look-ahead time.
+static void physics_world_test_pair(PhysicsWorld* world, ContactBlock* block, int index_a, int index_b) {
+    BodyPool* pool = &world->pool;
+    uint8_t flags_a = pool->flags[index_a];
+    uint8_t flags_b = pool->flags[index_b];
+    
+    // Skip if neither body can move (static or sleeping)
+    if ((flags_a & (BODY_FLAG_STATIC | BODY_FLAG_SLEEPING)) && (flags_b & (BODY_FLAG_STATIC | BODY_FLAG_SLEEPING))) {
+        return;
+    }
+    
+    block->checks++;
+    
+    // Swept bounds keep the speculative pairs the same for every broad phase
+    float margin = 0.0f;
+    if (world->speculative_time > 0.0f) {
+        if (!body_pool_swept_aabb_overlap(pool, index_a, index_b, world->speculative_time)) return;
+        Vector3 relative_velocity = vector3_subtract(pool->velocity[index_b], pool->velocity[index_a]);
+        margin = vector3_length(relative_velocity) * world->speculative_time;
+    }
+    
+    // Make room for a contact before testing so none is ever dropped
+    Contact* contact = contact_block_next(block);
+    if (contact) {
+        if (collide_shapes_speculative((ShapeType)pool->shape_type[index_a], &pool->shape[index_a],
+                                       pool->position[index_a], (ShapeType)pool->shape_type[index_b],
+                                       &pool->shape[index_b], pool->position[index_b], margin, contact)) {
+            contact->index_a = (uint32_t)index_a;
+            contact->index_b = (uint32_t)index_b;
+            contact->normal_impulse = 0.0f;
+            contact->tangent_impulse = 0.0f;
+            block->count++;
+        }
+    }
+}
+
+// Brute force: rows [begin, end) of the upper triangle of body pairs
+static void physics_world_brute_force_block(PhysicsWorld* world, ContactBlock* block, int begin, int end) {
+    BodyPool* pool = &world->pool;
+    
+    // Planes are handled by the plane pass
+    for (int i = begin; i < end; i++) {
+        if (pool->shape_type[i] == SHAPE_PLANE) continue;
+        
+        for (int j = i + 1; j < pool->count; j++) {
+            if (pool->shape_type[j] == SHAPE_PLANE) continue;
+            physics_world_test_pair(world, block, i, j);
+        }
+    }
+}
+
+// Broad phase: candidate pairs [begin, end)
+static void physics_world_pair_block(PhysicsWorld* world, ContactBlock* block, int begin, int end) {
+    const BroadPhasePair* pairs = world->broad_phase.pairs;
+    
+    for (int i = begin; i < end; i++) {
+        physics_world_test_pair(world, block, pairs[i].index_a, pairs[i].index_b);
+    }
+}
+
+// Planes against active bodies [begin, end); sleeping bodies stay where
+// they fell asleep, resting on planes or not
+static void physics_world_plane_block(PhysicsWorld* world, ContactBlock* block, int begin, int end) {
+    BodyPool* pool = &world->pool;
+    PlaneList* planes = &world->planes;
+    int plane_count = planes->count;
+    
+    if (!physics_ensure_capacity((void**)&block->plane_separation, &block->plane_capacity, plane_count,
+                                 sizeof(float))) {
+        return;
+    }
+    float* separation = block->plane_separation;
+    
+    for (int k = begin; k < end; k++) {
+        int i = world->active_bodies[k];
+        
+        // Spheres extend by their radius along any normal, boxes by |h . n|
+        ShapeType shape_type = (ShapeType)pool->shape_type[i];
+        float radius = 0.0f;
+        Vector3 half = vector3_zero();
+        if (shape_type == SHAPE_SPHERE) {
+            radius = pool->shape[i].sphere.radius;
+        } else {
+            half = pool->shape[i].aabb.half_extents;
+        }
+        
+        Vector3 position = pool->position[i];
+        
+        // Signed gap to every plane (same value as distance_to_plane minus the
+        // extent), less how far the body may fall toward the plane when speculating
+        Vector3 reach = vector3_scale(pool->velocity[i], -world->speculative_time);
+        for (int p = 0; p < plane_count; p++) {
+            float nx = planes->normal_x[p];
+            float ny = planes->normal_y[p];
+            float nz = planes->normal_z[p];
+            float extent = radius + fabsf(half.x * nx) + fabsf(half.y * ny) + fabsf(half.z * nz);
+            float approach = fmaxf(reach.x * nx + reach.y * ny + reach.z * nz, 0.0f);
+            separation[p] = position.x * nx + position.y * ny + position.z * nz - planes->distance[p] - extent -
+                            approach;
+        }
+        
+        block->checks += plane_count;
+        
+        for (int p = 0; p < plane_count; p++) {
+            if (separation[p] >= 0.0f) continue;
+            
+            Contact* contact = contact_block_next(block);
+            if (!contact) return;
+            
+            // Build the contact with the plane as body A
+            int plane = planes->indices[p];
+            float margin = fmaxf(reach.x * planes->normal_x[p] + reach.y * planes->normal_y[p] +
+                                 reach.z * planes->normal_z[p], 0.0f);
+            if (!collide_shapes_speculative(SHAPE_PLANE, &pool->shape[plane], pool->position[plane],
+                                            shape_type, &pool->shape[i], position, margin, contact)) {
+                continue;
+            }
+            
+            contact->index_a = (uint32_t)plane;
+            contact->index_b = (uint32_t)i;
+            contact->normal_impulse = 0.0f;
+            contact->tangent_impulse = 0.0f;
+            block->count++;
+        }
+    }
+}
+
+typedef void (*NarrowPhaseBlockFunc)(PhysicsWorld* world, ContactBlock* block, int begin, int end);
+
+// Parallel-for context: items are split into fixed blocks, each with its own contact buffer
+typedef struct {
+    PhysicsWorld* world;
+    int item_count;
+    int block_size;
+    NarrowPhaseBlockFunc func;
+} NarrowPhaseJob;
+
+static void physics_world_narrow_phase_range(void* context, int begin, int end) {
+    NarrowPhaseJob* job = (NarrowPhaseJob*)context;
+    
+    for (int b = begin; b < end; b++) {
+        ContactBlock* block = &job->world->contact_blocks[b];
+        int first = b * job->block_size;
+        int last = first + job->block_size < job->item_count ? first + job->block_size : job->item_count;
+        
+        block->count = 0;
+        block->checks = 0;
+        job->func(job->world, block, first, last);
+    }
+}
+
+// Run one narrow-phase pass over item_count items, then append the blocks'
+// contacts in block order. Block boundaries depend only on the item count,
+// so the merged order is the same for any thread count or work split.
+static void physics_world_run_narrow_phase(PhysicsWorld* world, int item_count, int block_size,
+                                           NarrowPhaseBlockFunc func) {
+    if (item_count <= 0) return;
+    
+    int block_count = (item_count + block_size - 1) / block_size;
+    if (!physics_world_reserve_contact_blocks(world, block_count)) return;
+    
+    NarrowPhaseJob job = { world, item_count, block_size, func };
+    physics_world_parallel_for(world, block_count, 1, physics_world_narrow_phase_range, &job);
+    
+    int total = world->contact_count;
+    for (int b = 0; b < block_count; b++) {
+        total += world->contact_blocks[b].count;
+    }
+    if (!physics_ensure_capacity_aligned((void**)&world->contacts, &world->contact_capacity, total,
+                                         sizeof(Contact), CONTACT_ALIGNMENT)) {
+        return;
+    }
+    
+    BodyPool* pool = &world->pool;
+    for (int b = 0; b < block_count; b++) {
+        ContactBlock* block = &world->contact_blocks[b];
+        Contact* merged = &world->contacts[world->contact_count];
+        if (block->count > 0) {
+            memcpy(merged, block->contacts, (size_t)block->count * sizeof(Contact));
+        }
+        world->contact_count += block->count;
+        world->collision_checks_performed += block->checks;
+        
+        // A moving body touching a sleeping one wakes its whole island
+        for (int c = 0; c < block->count; c++) {
+            if (body_pool_is_sleeping(pool, (int)merged[c].index_a)) {
+                physics_world_wake_body(world, (int)merged[c].index_a);
+            }
+            if (body_pool_is_sleeping(pool, (int)merged[c].index_b)) {
+                physics_world_wake_body(world, (int)merged[c].index_b);
+            }
+        }
+    }
+    
+    physics_world_wake_islands(world);
+}
+
+void physics_world_detect_collisions(PhysicsWorld* world) {
+    if (!world) return;
+    
+    world->contact_count = 0;
+    world->collision_checks_performed = 0;
+    
+    BodyPool* pool = &world->pool;
+    
+    if (world->broad_phase.type == BROAD_PHASE_BRUTE_FORCE) {
+        // Broad phase: check all pairs of bodies (planes are handled below)
+        physics_world_run_narrow_phase(world, pool->count, PHYSICS_WORLD_ROW_BLOCK,
+                                       physics_world_brute_force_block);
+    } else {
+        // Only pairs whose bounds overlap reach the narrow phase
+        broad_phase_update(&world->broad_phase, pool);
+        if (world->deterministic) {
+            broad_phase_sort_pairs(&world->broad_phase);
+        }
+        physics_world_run_narrow_phase(world, world->broad_phase.pair_count, PHYSICS_WORLD_PAIR_BLOCK,
+                                       physics_world_pair_block);
+    }
+    
+    physics_world_detect_plane_collisions(world);
+}
+
+void physics_world_detect_plane_collisions(PhysicsWorld* world) {
+    if (!world) return;
+    
+    BodyPool* pool = &world->pool;
+    PlaneList* planes = &world->planes;
+    if (planes->count == 0) return;
+    
+    // Refresh the plane arrays; plane bodies may have been re-initialised
+    for (int p = 0; p < planes->count; p++) {
+        const PlaneShape* plane = &pool->shape[planes->indices[p]].plane;
+        planes->normal_x[p] = plane->normal.x;
+        planes->normal_y[p] = plane->normal.y;
+        planes->normal_z[p] = plane->normal.z;
+        planes->distance[p] = plane->distance;
+    }
+    
+    // Only awake bodies can reach a plane
+    physics_world_refresh_active_bodies(world);
+    physics_world_run_narrow_phase(world, world->active_count, PHYSICS_WORLD_BODY_GRAIN, physics_world_plane_block);
+}
+
+static inline ContactBody physics_world_contact_body(BodyPool* pool, int index) {
+    ContactBody view;
+    view.position = &pool->position[index];
+    view.velocity = &pool->velocity[index];
+    view.inverse_mass = pool->inverse_mass[index];
+    view.restitution = pool->restitution[index];
+    view.friction = pool->friction[index];
+    view.is_static = body_pool_is_static(pool, index);
+    return view;
+}
+
+// Solver passes over the contacts. Every pass but prepare writes body
+// velocities or positions, so those run batch by batch when coloured.
+typedef enum {
+    SOLVER_PASS_PREPARE,
+    SOLVER_PASS_WARM_START,
+    SOLVER_PASS_VELOCITY,
+    SOLVER_PASS_POSITION
+} SolverPass;
+
+// Run a pass over contacts order[begin..end) against the pool
+typedef struct {
+    BodyPool* pool;
+    Contact* contacts;
+    ContactConstraint* constraints;
+    const int* order;              // NULL walks the contacts in detection order
+    const HandleTable* handles;    // Pool index -> handle, for cache keys
+    const ContactCache* cache;     // NULL starts every contact cold
+    float dt;                      // Look-ahead of speculative contacts, 0 when not speculating
+    SolverPass pass;
+} ResolveJob;
+
+static void physics_world_resolve_range(void* context, int begin, int end) {
+    ResolveJob* job = (ResolveJob*)context;
+    BodyPool* pool = job->pool;
+    
+    for (int i = begin; i < end; i++) {
+        int c = job->order ? job->order[i] : i;
+        Contact* contact = &job->contacts[c];
+        ContactConstraint* constraint = &job->constraints[c];
+        
+        ContactBody body_a = physics_world_contact_body(pool, (int)contact->index_a);
+        ContactBody body_b = physics_world_contact_body(pool, (int)contact->index_b);
+        
+        switch (job->pass) {
+            case SOLVER_PASS_PREPARE: {
+                contact_constraint_prepare(&body_a, &body_b, contact, job->dt, constraint);
+                constraint->normal_impulse = 0.0f;
+                constraint->tangent_impulse = vector3_zero();
+                if (!job->cache) break;
+                
+                bool swapped;
+                ContactCacheKey key = contact_cache_key(handle_table_get_handle(job->handles, (int)contact->index_a),
+                                                        handle_table_get_handle(job->handles, (int)contact->index_b),
+                                                        &swapped);
+                const ContactCacheEntry* entry = contact_cache_find(job->cache, key);
+                if (entry) {
+                    constraint->normal_impulse = entry->normal_impulse;
+                    constraint->tangent_impulse = swapped ? vector3_negate(entry->tangent_impulse)
+                                                          : entry->tangent_impulse;
+                }
+                break;
+            }
+            case SOLVER_PASS_WARM_START:
+                contact_constraint_warm_start(&body_a, &body_b, contact, constraint);
+                break;
+            case SOLVER_PASS_VELOCITY:
+                contact_constraint_solve(&body_a, &body_b, contact, constraint);
+                break;
+            case SOLVER_PASS_POSITION:
+                contact_correct_position(&body_a, &body_b, contact);
+                break;
+        }
+    }
+}
+
+// Greedy graph colouring: give each contact, in detection order, the lowest
+// batch not yet used by either of its dynamic bodies. Static bodies are only
+// read by the resolver, so any number of batches may share them.
+static bool physics_world_color_contacts(PhysicsWorld* world) {
+    ContactBatches* batches = &world->contact_batches;
+    BodyPool* pool = &world->pool;
+    int contact_count = world->contact_count;
+    
+    if (!physics_ensure_capacity((void**)&batches->body_colors, &batches->body_capacity, pool->count,
+                                 sizeof(uint64_t)) ||
+        !physics_ensure_capacity((void**)&batches->order, &batches->order_capacity, 2 * contact_count,
+                                 sizeof(int))) {
+        return false;
+    }
+    
+    memset(batches->body_colors, 0, (size_t)pool->count * sizeof(uint64_t));
+    memset(batches->batch_start, 0, sizeof(batches->batch_start));
+    
+    // The second half of order holds each contact's batch until the sort below
+    int* contact_batch = batches->order + contact_count;
+    for (int c = 0; c < contact_count; c++) {
+        int a = (int)world->contacts[c].index_a;
+        int b = (int)world->contacts[c].index_b;
+        bool dynamic_a = !body_pool_is_static(pool, a);
+        bool dynamic_b = !body_pool_is_static(pool, b);
+        
+        uint64_t used = (dynamic_a ? batches->body_colors[a] : 0) | (dynamic_b ? batches->body_colors[b] : 0);
+        int batch = 0;
+        while (batch < PHYSICS_WORLD_CONTACT_BATCHES && ((used >> batch) & 1u)) {
+            batch++;
+        }
+        
+        // Out of batches: the contact goes to the overflow batch, resolved serially
+        if (batch < PHYSICS_WORLD_CONTACT_BATCHES) {
+            uint64_t bit = (uint64_t)1 << batch;
+            if (dynamic_a) batches->body_colors[a] |= bit;
+            if (dynamic_b) batches->body_colors[b] |= bit;
+        }
+        
+        contact_batch[c] = batch;
+        batches->batch_start[batch + 1]++;
+    }
+    
+    // Counting sort keeps detection order within each batch
+    for (int k = 0; k <= PHYSICS_WORLD_CONTACT_BATCHES; k++) {
+        batches->batch_start[k + 1] += batches->batch_start[k];
+    }
+    
+    int cursor[PHYSICS_WORLD_CONTACT_BATCHES + 1];
+    memcpy(cursor, batches->batch_start, sizeof(cursor));
+    for (int c = 0; c < contact_count; c++) {
+        batches->order[cursor[contact_batch[c]]++] = c;
+    }
+    
+    return true;
+}
+
+// Run one solver pass over every contact: in coloured batches, each batch
+// in parallel, or serially in detection order
+static void physics_world_run_solver_pass(PhysicsWorld* world, ResolveJob* job, bool batched) {
+    if (!batched) {
+        job->order = NULL;
+        physics_world_resolve_range(job, 0, world->contact_count);
+        return;
+    }
+    
+    ContactBatches* batches = &world->contact_batches;
+    for (int k = 0; k < PHYSICS_WORLD_CONTACT_BATCHES; k++) {
+        int begin = batches->batch_start[k];
+        int count = batches->batch_start[k + 1] - begin;
+        if (count == 0) continue;
+        
+        job->order = batches->order + begin;
+        physics_world_parallel_for(world, count, PHYSICS_WORLD_CONTACT_GRAIN, physics_world_resolve_range, job);
+    }
+    
+    job->order = batches->order;
+    physics_world_resolve_range(job, batches->batch_start[PHYSICS_WORLD_CONTACT_BATCHES],
+                                batches->batch_start[PHYSICS_WORLD_CONTACT_BATCHES + 1]);
+}
+
+// Sequential impulses: warm start from the cached impulses, iterate the
+// velocity constraints, then correct positions once. Only this loop
+// iterates; detection runs once per substep.
+void physics_world_resolve_collisions(PhysicsWorld* world) {
+    if (!world) return;
+    
+    int contact_count = world->contact_count;
+    if (contact_count == 0) {
+        // Nothing touches, so nothing carries over to the next solve
+        if (world->warm_starting) {
+            contact_cache_begin(&world->contact_cache, 0);
+            contact_cache_end(&world->contact_cache);
+        }
+        return;
+    }
+    
+    if (!physics_ensure_capacity((void**)&world->constraints, &world->constraint_capacity, contact_count,
+                                 sizeof(ContactConstraint))) {
+        return;
+    }
+    
+    // With threads, solve each batch of non-conflicting contacts in parallel.
+    // Deterministic worlds use the batch order even when stepping serially.
+    bool batched = (world->deterministic || physics_world_is_parallel(world)) && physics_world_color_contacts(world);
+    
+    ResolveJob job = { &world->pool, world->contacts, world->constraints, NULL, &world->handles,
+                       world->warm_starting ? &world->contact_cache : NULL, world->speculative_time,
+                       SOLVER_PASS_PREPARE };
+    
+    // Preparing only reads the bodies, so it needs no batches
+    physics_world_parallel_for(world, contact_count, PHYSICS_WORLD_CONTACT_GRAIN, physics_world_resolve_range, &job);
+    
+    if (world->warm_starting) {
+        job.pass = SOLVER_PASS_WARM_START;
+        physics_world_run_solver_pass(world, &job, batched);
+    }
+    
+    job.pass = SOLVER_PASS_VELOCITY;
+    for (int iteration = 0; iteration < world->solver_iterations; iteration++) {
+        physics_world_run_solver_pass(world, &job, batched);
+    }
+    
+    job.pass = SOLVER_PASS_POSITION;
+    physics_world_run_solver_pass(world, &job, batched);
+    
+    // Report the accumulated impulses and keep them for the next solve. If
+    // the table can't grow it stays empty and the next solve starts cold.
+    bool caching = world->warm_starting;
+    if (caching) {
+        contact_cache_begin(&world->contact_cache, contact_count);
+    }
+    for (int c = 0; c < contact_count; c++) {
+        Contact* contact = &world->contacts[c];
+        const ContactConstraint* constraint = &world->constraints[c];
+        contact->normal_impulse = constraint->normal_impulse;
+        contact->tangent_impulse = vector3_length(constraint->tangent_impulse);
+        if (!caching) continue;
+        
+        bool swapped;
+        ContactCacheKey key = contact_cache_key(handle_table_get_handle(&world->handles, (int)contact->index_a),
+                                                handle_table_get_handle(&world->handles, (int)contact->index_b),
+                                                &swapped);
+        contact_cache_store(&world->contact_cache, key, constraint->normal_impulse,
+                            swapped ? vector3_negate(constraint->tangent_impulse) : constraint->tangent_impulse);
+    }
+    if (caching) {
+        contact_cache_end(&world->contact_cache);
+    }
+}
+
+void physics_world_apply_forces(PhysicsWorld* world) {
+    if (!world) return;
+    
+    physics_world_refresh_active_bodies(world);
+    ForceJob job = { &world->pool, world->active_bodies, world->gravity };
+    physics_world_parallel_for(world, world->active_count, PHYSICS_WORLD_BODY_GRAIN, physics_world_force_range, &job);
+}
+
+void physics_world_integrate_bodies(PhysicsWorld* world, float dt) {
+    if (!world) return;
+    
+    physics_world_refresh_active_bodies(world);
+    IntegrateJob job = { &world->pool, world->active_bodies, dt, world->integration_method };
+    physics_world_parallel_for(world, world->active_count, PHYSICS_WORLD_BODY_GRAIN,
+                               physics_world_integrate_range, &job);
+}
+
+static bool physics_world_wake_callback(void* context, int body_index) {
+    PhysicsWorld* world = (PhysicsWorld*)context;
+    if (body_pool_is_sleeping(&world->pool, body_index)) {
+        physics_world_wake_body(world, body_index);
+    }
+    return true;
+}
+
+void physics_world_wake_sleeping_bodies(PhysicsWorld* world) {
+    if (!world) return;
+    
+    BodyPool* pool = &world->pool;
+    
+    // Nothing to do unless some body is asleep
+    bool any_sleeping = false;
+    for (int i = 0; i < pool->count; i++) {
+        if (body_pool_is_sleeping(pool, i)) {
+            any_sleeping = true;
+            break;
+        }
+    }
+    if (!any_sleeping) return;
+    
+    // Reuse the grid built by the spatial hash broad phase during the previous
+    // substep; resolution only nudges bodies, well within the wake heuristic's
+    // slack. Other broad phases rebuild it here, once per substep.
+    SpatialHash* grid = &world->broad_phase.grid;
+    if (!grid->is_valid || world->broad_phase.type != BROAD_PHASE_SPATIAL_HASH) {
+        if (!spatial_hash_build(grid, pool)) return;
+    }
+    
+    // Wake all bodies within a certain distance of moving bodies. Waking
+    // only marks the active list stale, so it can be walked meanwhile.
+    physics_world_refresh_active_bodies(world);
+    for (int k = 0; k < world->active_count; k++) {
+        int i = world->active_bodies[k];
+        
+        // Check if this body is moving fast enough to wake others
+        float speed_sq = vector3_length_squared(pool->velocity[i]);
+        if (speed_sq < 0.1f) continue;
+        
+        spatial_hash_query_radius(grid, pool, pool->position[i], world->wake_distance,
+                                  physics_world_wake_callback, world);
+    }
+    
+    physics_world_wake_islands(world);
+}
+
+int physics_world_get_body_count(PhysicsWorld* world) {
+    return world ? world->body_count : 0;
+}
+
+int physics_world_get_collision_count(PhysicsWorld* world) {
+    return world ? world->contact_count : 0;
+}
+
+PhysicsStepStats physics_world_get_step_stats(PhysicsWorld* world) {
+    if (!world) {
+        PhysicsStepStats empty = { 0, 0.0f, 0.0f, 0, 0 };
+        return empty;
+    }
+    return world->step_stats;
+}
+
+const Contact* physics_world_get_contact(PhysicsWorld* world, int index) {
+    if (!world || index < 0 || index >= world->contact_count) return NULL;
+    return &world->contacts[index];
+}
+
+// Kinetic energy of one fixed block of bodies, summed in body order
+// Sleeping bodies are at rest and static ones have infinite mass, so only
+// the active bodies carry energy
+static float physics_world_block_energy(const BodyPool* pool, const int* bodies, int count, int block) {
+    int begin = block * PHYSICS_WORLD_BODY_GRAIN;
+    int end = begin + PHYSICS_WORLD_BODY_GRAIN < count ? begin + PHYSICS_WORLD_BODY_GRAIN : count;
+    
+    float energy = 0.0f;
+    for (int k = begin; k < end; k++) {
+        int i = bodies[k];
+        energy += 0.5f * pool->mass[i] * vector3_length_squared(pool->velocity[i]);
+    }
+    return energy;
+}
+
+typedef struct {
+    const BodyPool* pool;
+    const int* bodies;
+    int count;
+    float* partials;
+} EnergyJob;
+
+static void physics_world_energy_range(void* context, int begin, int end) {
+    EnergyJob* job = (EnergyJob*)context;
+    for (int b = begin; b < end; b++) {
+        job->partials[b] = physics_world_block_energy(job->pool, job->bodies, job->count, b);
+    }
+}
+
+float physics_world_get_total_kinetic_energy(PhysicsWorld* world) {
+    if (!world) return 0.0f;
+    
+    // Block boundaries don't depend on the thread count and the partials are
+    // added in block order, so the total is the same however it was computed
+    physics_world_refresh_active_bodies(world);
+    const int* bodies = world->active_bodies;
+    int count = world->active_count;
+    int block_count = (count + PHYSICS_WORLD_BODY_GRAIN - 1) / PHYSICS_WORLD_BODY_GRAIN;
+    float total_energy = 0.0f;
+    
+    if (physics_ensure_capacity((void**)&world->reduction_partials, &world->reduction_capacity, block_count,
+                                sizeof(float))) {
+        EnergyJob job = { &world->pool, bodies, count, world->reduction_partials };
+        physics_world_parallel_for(world, block_count, 1, physics_world_energy_range, &job);
+        for (int b = 0; b < block_count; b++) {
+            total_energy += world->reduction_partials[b];
+        }
+    } else {
+        for (int b = 0; b < block_count; b++) {
+            total_energy += physics_world_block_energy(&world->pool, bodies, count, b);
+        }
+    }
+    
+    return total_energy;
+}
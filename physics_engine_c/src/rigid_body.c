@@ -1,13 +1,20 @@
 #include "../include/rigid_body.h"
-#include <stdlib.h>
+#include "../include/allocator.h"
 #include <string.h>
 
 static int next_body_id = 1;
 
 RigidBody* rigid_body_create(void) {
-    RigidBody* body = (RigidBody*)malloc(sizeof(RigidBody));
+    RigidBody* body = (RigidBody*)physics_alloc(sizeof(RigidBody));
     if (!body) return NULL;
     
+    rigid_body_init(body);
+    return body;
+}
+
+void rigid_body_init(RigidBody* body) {
+    if (!body) return;
+    
     // Initialize all fields to zero/default values
     memset(body, 0, sizeof(RigidBody));
     
@@ -18,14 +25,14 @@ RigidBody* rigid_body_create(void) {
     body->friction = 0.3f;
     body->is_static = false;
     body->is_sleeping = false;
-    body->id = next_body_id++;
     
-    return body;
+    // Bodies may be created on several threads to be spawned through a world's command queue
+    body->id = __atomic_fetch_add(&next_body_id, 1, __ATOMIC_RELAXED);
 }
 
 void rigid_body_destroy(RigidBody* body) {
     if (body) {
-        free(body);
+        physics_free(body, sizeof(RigidBody));
     }
 }
 
@@ -0,0 +1,261 @@
+#include "../include/spatial_hash.h"
+#include "../include/allocator.h"
+#include <string.h>
+
+static inline unsigned int hash_cell(int cell_x, int cell_y, int cell_z) {
+    return ((unsigned int)cell_x * 73856093u) ^
+           ((unsigned int)cell_y * 19349663u) ^
+           ((unsigned int)cell_z * 83492791u);
+}
+
+// Half-size of the bounding cube of a bounded body
+static inline float body_half_size(const BodyPool* pool, int index) {
+    if (pool->shape_type[index] == SHAPE_SPHERE) {
+        return pool->shape[index].sphere.radius;
+    }
+
+    Vector3 h = pool->shape[index].aabb.half_extents;
+    return fmaxf(h.x, fmaxf(h.y, h.z));
+}
+
+void spatial_hash_init(SpatialHash* hash, float cell_size) {
+    if (!hash) return;
+
+    memset(hash, 0, sizeof(SpatialHash));
+    hash->cell_size = fmaxf(0.0f, cell_size);
+}
+
+void spatial_hash_destroy(SpatialHash* hash) {
+    if (!hash) return;
+
+    float cell_size = hash->cell_size;
+    physics_free(hash->entries, (size_t)hash->entry_capacity * sizeof(SpatialHashEntry));
+    physics_free(hash->staging, (size_t)hash->entry_capacity * sizeof(SpatialHashEntry));
+    physics_free(hash->bucket_starts, (size_t)hash->bucket_capacity * sizeof(int));
+    physics_free(hash->oversized, (size_t)hash->oversized_capacity * sizeof(int));
+    physics_free(hash->entry_buckets, (size_t)hash->entry_bucket_capacity * sizeof(int));
+    spatial_hash_init(hash, cell_size);
+}
+
+void spatial_hash_invalidate(SpatialHash* hash) {
+    if (hash) {
+        hash->is_valid = false;
+    }
+}
+
+// NaN fails both comparisons and lands on the lower limit
+static inline int cell_coordinate(float value) {
+    float cell = floorf(value);
+    if (!(cell > (float)-SPATIAL_HASH_CELL_LIMIT)) return -SPATIAL_HASH_CELL_LIMIT;
+    if (cell > (float)SPATIAL_HASH_CELL_LIMIT) return SPATIAL_HASH_CELL_LIMIT;
+    return (int)cell;
+}
+
+void spatial_hash_get_cell(const SpatialHash* hash, Vector3 position, int* cell_x, int* cell_y, int* cell_z) {
+    *cell_x = cell_coordinate(position.x * hash->inverse_cell_size);
+    *cell_y = cell_coordinate(position.y * hash->inverse_cell_size);
+    *cell_z = cell_coordinate(position.z * hash->inverse_cell_size);
+}
+
+void spatial_hash_get_bucket(const SpatialHash* hash, int cell_x, int cell_y, int cell_z, int* begin, int* end) {
+    if (hash->bucket_count == 0) {
+        *begin = *end = 0;
+        return;
+    }
+
+    unsigned int bucket = hash_cell(cell_x, cell_y, cell_z) & (unsigned int)(hash->bucket_count - 1);
+    *begin = hash->bucket_starts[bucket];
+    *end = hash->bucket_starts[bucket + 1];
+}
+
+bool spatial_hash_build(SpatialHash* hash, const BodyPool* pool) {
+    if (!hash || !pool) return false;
+
+    int body_count = pool->count;
+
+    hash->entry_count = 0;
+    hash->oversized_count = 0;
+    hash->is_valid = false;
+
+    // Pick the cell size: twice the mean body diameter keeps similar bodies to one cell each
+    float cell_size = hash->cell_size;
+    if (cell_size <= 0.0f) {
+        float diameter_sum = 0.0f;
+        int bounded_count = 0;
+
+        for (int i = 0; i < body_count; i++) {
+            if (pool->shape_type[i] == SHAPE_PLANE) continue;
+            diameter_sum += 2.0f * body_half_size(pool, i);
+            bounded_count++;
+        }
+
+        cell_size = bounded_count > 0 ? 2.0f * diameter_sum / (float)bounded_count : 1.0f;
+        if (cell_size <= VECTOR_EPSILON) cell_size = 1.0f;
+    }
+
+    hash->active_cell_size = cell_size;
+    hash->inverse_cell_size = 1.0f / cell_size;
+
+    int entry_capacity = hash->entry_capacity;
+    if (!physics_ensure_capacity((void**)&hash->entries, &entry_capacity, body_count, sizeof(SpatialHashEntry)) ||
+        !physics_ensure_capacity((void**)&hash->staging, &hash->entry_capacity, body_count, sizeof(SpatialHashEntry)) ||
+        !physics_ensure_capacity((void**)&hash->entry_buckets, &hash->entry_bucket_capacity, body_count, sizeof(int)) ||
+        !physics_ensure_capacity((void**)&hash->oversized, &hash->oversized_capacity, body_count, sizeof(int))) {
+        return false;
+    }
+
+    // Bin bodies by the cell containing their position
+    SpatialHashEntry* staging = hash->staging;
+    int staged = 0;
+
+    for (int i = 0; i < body_count; i++) {
+        if (pool->shape_type[i] == SHAPE_PLANE) continue;
+
+        if (2.0f * body_half_size(pool, i) > cell_size) {
+            hash->oversized[hash->oversized_count++] = i;
+            continue;
+        }
+
+        SpatialHashEntry* entry = &staging[staged++];
+        entry->body_index = i;
+        spatial_hash_get_cell(hash, pool->position[i], &entry->cell_x, &entry->cell_y, &entry->cell_z);
+    }
+
+    // Size the table to keep buckets short
+    int bucket_count = 16;
+    while (bucket_count < 2 * staged) {
+        bucket_count *= 2;
+    }
+    if (!physics_ensure_capacity((void**)&hash->bucket_starts, &hash->bucket_capacity, bucket_count + 1, sizeof(int))) {
+        return false;
+    }
+    hash->bucket_count = bucket_count;
+
+    // Counting sort of entries by bucket
+    unsigned int mask = (unsigned int)(bucket_count - 1);
+    memset(hash->bucket_starts, 0, (size_t)(bucket_count + 1) * sizeof(int));
+
+    for (int e = 0; e < staged; e++) {
+        SpatialHashEntry* entry = &staging[e];
+        int bucket = (int)(hash_cell(entry->cell_x, entry->cell_y, entry->cell_z) & mask);
+        hash->entry_buckets[e] = bucket;
+        hash->bucket_starts[bucket + 1]++;
+    }
+
+    for (int b = 0; b < bucket_count; b++) {
+        hash->bucket_starts[b + 1] += hash->bucket_starts[b];
+    }
+
+    // Place entries in bucket order, walking backwards so each bucket stays in body order
+    int* cursor = hash->bucket_starts + 1;
+    for (int e = staged - 1; e >= 0; e--) {
+        int bucket = hash->entry_buckets[e];
+        hash->entries[--cursor[bucket]] = staging[e];
+    }
+
+    // Placement left each bucket's start one slot to the right; shift them back
+    memmove(hash->bucket_starts, hash->bucket_starts + 1, (size_t)bucket_count * sizeof(int));
+    hash->bucket_starts[bucket_count] = staged;
+
+    hash->entry_count = staged;
+    hash->is_valid = true;
+    return true;
+}
+
+void spatial_hash_query_radius(const SpatialHash* hash, const BodyPool* pool, Vector3 center, float radius,
+                               SpatialHashQueryCallback callback, void* context) {
+    if (!hash || !pool || !callback) return;
+
+    float radius_sq = radius * radius;
+
+    int min_x, min_y, min_z, max_x, max_y, max_z;
+    Vector3 extent = vector3_create(radius, radius, radius);
+    spatial_hash_get_cell(hash, vector3_subtract(center, extent), &min_x, &min_y, &min_z);
+    spatial_hash_get_cell(hash, vector3_add(center, extent), &max_x, &max_y, &max_z);
+
+    float cell_volume = (float)(max_x - min_x + 1) * (float)(max_y - min_y + 1) * (float)(max_z - min_z + 1);
+
+    if (cell_volume > (float)hash->entry_count) {
+        // Scanning the entries directly is cheaper than visiting every cell
+        for (int e = 0; e < hash->entry_count; e++) {
+            int index = hash->entries[e].body_index;
+            if (vector3_length_squared(vector3_subtract(pool->position[index], center)) < radius_sq) {
+                if (!callback(context, index)) return;
+            }
+        }
+    } else {
+        for (int x = min_x; x <= max_x; x++) {
+            for (int y = min_y; y <= max_y; y++) {
+                for (int z = min_z; z <= max_z; z++) {
+                    int begin, end;
+                    spatial_hash_get_bucket(hash, x, y, z, &begin, &end);
+
+                    for (int e = begin; e < end; e++) {
+                        const SpatialHashEntry* entry = &hash->entries[e];
+                        if (entry->cell_x != x || entry->cell_y != y || entry->cell_z != z) continue;
+
+                        int index = entry->body_index;
+                        if (vector3_length_squared(vector3_subtract(pool->position[index], center)) < radius_sq) {
+                            if (!callback(context, index)) return;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    for (int k = 0; k < hash->oversized_count; k++) {
+        int index = hash->oversized[k];
+        if (vector3_length_squared(vector3_subtract(pool->position[index], center)) < radius_sq) {
+            if (!callback(context, index)) return;
+        }
+    }
+}
+
+void spatial_hash_query_aabb(const SpatialHash* hash, const BodyPool* pool, Vector3 min, Vector3 max,
+                             SpatialHashQueryCallback callback, void* context) {
+    if (!hash || !pool || !callback) return;
+
+    // Grid bodies are at most a cell across, so any that reach the box have
+    // their positions within half a cell of it
+    float margin = 0.5f * hash->active_cell_size;
+    Vector3 low = vector3_subtract(min, vector3_create(margin, margin, margin));
+    Vector3 high = vector3_add(max, vector3_create(margin, margin, margin));
+
+    int min_x, min_y, min_z, max_x, max_y, max_z;
+    spatial_hash_get_cell(hash, low, &min_x, &min_y, &min_z);
+    spatial_hash_get_cell(hash, high, &max_x, &max_y, &max_z);
+
+    float cell_volume = (float)(max_x - min_x + 1) * (float)(max_y - min_y + 1) * (float)(max_z - min_z + 1);
+
+    if (cell_volume > (float)hash->entry_count) {
+        // Scanning the entries directly is cheaper than visiting every cell
+        for (int e = 0; e < hash->entry_count; e++) {
+            int index = hash->entries[e].body_index;
+            Vector3 position = pool->position[index];
+            if (position.x >= low.x && position.x <= high.x && position.y >= low.y && position.y <= high.y &&
+                position.z >= low.z && position.z <= high.z) {
+                if (!callback(context, index)) return;
+            }
+        }
+    } else {
+        for (int x = min_x; x <= max_x; x++) {
+            for (int y = min_y; y <= max_y; y++) {
+                for (int z = min_z; z <= max_z; z++) {
+                    int begin, end;
+                    spatial_hash_get_bucket(hash, x, y, z, &begin, &end);
+
+                    for (int e = begin; e < end; e++) {
+                        const SpatialHashEntry* entry = &hash->entries[e];
+                        if (entry->cell_x != x || entry->cell_y != y || entry->cell_z != z) continue;
+                        if (!callback(context, entry->body_index)) return;
+                    }
+                }
+            }
+        }
+    }
+
+    for (int k = 0; k < hash->oversized_count; k++) {
+        if (!callback(context, hash->oversized[k])) return;
+    }
+}
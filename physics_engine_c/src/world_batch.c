@@ -0,0 +1,124 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "../include/world_batch.h"
+#include "../include/allocator.h"
+#include <string.h>
+#include <time.h>
+
+static double batch_clock_seconds(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + (double)now.tv_nsec * 1e-9;
+}
+
+PhysicsWorldBatch* physics_world_batch_create(int world_count) {
+    if (world_count < 1) return NULL;
+
+    PhysicsWorldBatch* batch = (PhysicsWorldBatch*)physics_alloc(sizeof(PhysicsWorldBatch));
+    if (!batch) return NULL;
+
+    memset(batch, 0, sizeof(PhysicsWorldBatch));
+    batch->worlds = (PhysicsWorld*)physics_alloc((size_t)world_count * sizeof(PhysicsWorld));
+    if (!batch->worlds) {
+        physics_free(batch, sizeof(PhysicsWorldBatch));
+        return NULL;
+    }
+
+    // Worlds allocate their storage on first use, so an empty world is just its struct
+    batch->world_count = world_count;
+    for (int w = 0; w < world_count; w++) {
+        physics_world_init(&batch->worlds[w]);
+        physics_world_set_local_ids(&batch->worlds[w], true);
+    }
+    return batch;
+}
+
+void physics_world_batch_destroy(PhysicsWorldBatch* batch) {
+    if (!batch) return;
+
+    for (int w = 0; w < batch->world_count; w++) {
+        physics_world_release(&batch->worlds[w]);
+    }
+    job_system_destroy(batch->job_system);
+    physics_free(batch->worlds, (size_t)batch->world_count * sizeof(PhysicsWorld));
+    physics_free(batch, sizeof(PhysicsWorldBatch));
+}
+
+PhysicsWorld* physics_world_batch_get_world(PhysicsWorldBatch* batch, int index) {
+    if (!batch || index < 0 || index >= batch->world_count) return NULL;
+    return &batch->worlds[index];
+}
+
+int physics_world_batch_get_world_count(PhysicsWorldBatch* batch) {
+    return batch ? batch->world_count : 0;
+}
+
+bool physics_world_batch_set_thread_count(PhysicsWorldBatch* batch, int thread_count) {
+    if (!batch || thread_count < 1) return false;
+    if (job_system_get_thread_count(batch->job_system) == thread_count) return true;
+
+    job_system_destroy(batch->job_system);
+    batch->job_system = NULL;
+
+    if (thread_count > 1) {
+        batch->job_system = job_system_create(thread_count);
+        if (!batch->job_system) return false;
+    }
+    return true;
+}
+
+typedef struct {
+    PhysicsWorld* worlds;
+    float dt;                      // <= 0 steps each world with its own timestep
+} BatchStepJob;
+
+static void physics_world_batch_step_range(void* context, int begin, int end) {
+    BatchStepJob* job = (BatchStepJob*)context;
+
+    for (int w = begin; w < end; w++) {
+        PhysicsWorld* world = &job->worlds[w];
+        physics_world_step_with_dt(world, job->dt > 0.0f ? job->dt : world->timestep);
+    }
+}
+
+static void physics_world_batch_run(PhysicsWorldBatch* batch, float dt) {
+    double start = batch_clock_seconds();
+
+    BatchStepJob job = { batch->worlds, dt };
+    job_system_parallel_for(batch->job_system, batch->world_count, WORLD_BATCH_GRAIN,
+                            physics_world_batch_step_range, &job);
+
+    batch->last_step_seconds = batch_clock_seconds() - start;
+    batch->step_seconds += batch->last_step_seconds;
+    batch->world_steps += (uint64_t)batch->world_count;
+}
+
+void physics_world_batch_step(PhysicsWorldBatch* batch) {
+    if (batch) {
+        physics_world_batch_run(batch, 0.0f);
+    }
+}
+
+void physics_world_batch_step_with_dt(PhysicsWorldBatch* batch, float dt) {
+    if (batch && dt > 0.0f) {
+        physics_world_batch_run(batch, dt);
+    }
+}
+
+double physics_world_batch_get_world_steps_per_second(PhysicsWorldBatch* batch) {
+    if (!batch || batch->step_seconds <= 0.0) return 0.0;
+    return (double)batch->world_steps / batch->step_seconds;
+}
+
+double physics_world_batch_get_last_world_steps_per_second(PhysicsWorldBatch* batch) {
+    if (!batch || batch->last_step_seconds <= 0.0) return 0.0;
+    return (double)batch->world_count / batch->last_step_seconds;
+}
+
+void physics_world_batch_reset_stats(PhysicsWorldBatch* batch) {
+    if (!batch) return;
+
+    batch->world_steps = 0;
+    batch->step_seconds = 0.0;
+    batch->last_step_seconds = 0.0;
+}
@@ -0,0 +1,85 @@
+#include "../include/physics_world.h"
+#include <stdio.h>
+
+// Remove a body from the middle of a world and check the handles: the
+// removed body's handle must stop resolving, and keep failing once its slot
+// is reused, while the last body, swapped into the freed index, must still
+// resolve through both its handle and its id.
+
+#define TEST_BODY_COUNT 5
+#define TEST_REMOVED 1
+
+static int failures = 0;
+
+static void expect(bool condition, const char* what) {
+    if (!condition) {
+        fprintf(stderr, "FAIL: %s\n", what);
+        failures++;
+    }
+}
+
+int main(void) {
+    PhysicsWorld* world = physics_world_create();
+    if (!world) {
+        fprintf(stderr, "FAIL: could not create the world\n");
+        return 1;
+    }
+
+    RigidBody* bodies[TEST_BODY_COUNT];
+    BodyHandle handles[TEST_BODY_COUNT];
+    for (int i = 0; i < TEST_BODY_COUNT; i++) {
+        bodies[i] = physics_world_create_body(world);
+        rigid_body_init_sphere(bodies[i], vector3_create((float)i * 2.0f, 1.0f, 0.0f), 0.5f, 1.0f);
+        handles[i] = physics_world_add_body_handle(world, bodies[i]);
+        if (body_handle_is_null(handles[i])) {
+            fprintf(stderr, "FAIL: could not add body %d\n", i);
+            physics_world_destroy(world);
+            return 1;
+        }
+    }
+
+    RigidBody* removed = bodies[TEST_REMOVED];
+    RigidBody* last = bodies[TEST_BODY_COUNT - 1];
+    BodyHandle stale = handles[TEST_REMOVED];
+    int removed_id = removed->id;
+
+    expect(physics_world_remove_body_by_handle(world, stale), "removing a live handle failed");
+    physics_world_destroy_body(world, removed);
+
+    expect(physics_world_get_body_by_handle(world, stale) == NULL, "a removed body's handle still resolves");
+    expect(!physics_world_is_handle_valid(world, stale), "a removed body's handle is still valid");
+    expect(physics_world_get_body(world, removed_id) == NULL, "a removed body's id still resolves");
+    expect(!physics_world_remove_body_by_handle(world, stale), "a removed body's handle was removed twice");
+
+    // The last body now sits in the freed index and still resolves both ways
+    expect(world->bodies[TEST_REMOVED] == last, "the last body was not swapped into the freed index");
+    expect(physics_world_get_body_by_handle(world, handles[TEST_BODY_COUNT - 1]) == last,
+           "the swapped body no longer resolves through its handle");
+    expect(physics_world_get_body(world, last->id) == last, "the swapped body no longer resolves through its id");
+    expect(world->pool.position[TEST_REMOVED].x == last->position.x,
+           "the swapped body's state did not move with it");
+
+    // A new body takes the freed slot under a new generation
+    RigidBody* added = physics_world_create_body(world);
+    rigid_body_init_sphere(added, vector3_create(20.0f, 1.0f, 0.0f), 0.5f, 1.0f);
+    BodyHandle reused = physics_world_add_body_handle(world, added);
+
+    expect(!body_handle_is_null(reused), "adding a body after the removal failed");
+    expect(reused.slot == stale.slot && reused.generation != stale.generation,
+           "the new body did not reuse the freed slot under a new generation");
+    expect(physics_world_get_body_by_handle(world, stale) == NULL, "a stale handle resolves after its slot was reused");
+    expect(physics_world_get_body_by_handle(world, reused) == added, "the new body doesn't resolve through its handle");
+
+    for (int i = 0; i < TEST_BODY_COUNT; i++) {
+        if (i == TEST_REMOVED) continue;
+        expect(physics_world_get_body_by_handle(world, handles[i]) == bodies[i], "a remaining body's handle broke");
+        expect(physics_world_get_body(world, bodies[i]->id) == bodies[i], "a remaining body's id broke");
+    }
+
+    physics_world_destroy(world);
+
+    if (failures > 0) return 1;
+
+    printf("test_body_handles: stale and reused handles rejected, swapped body resolves by handle and id\n");
+    return 0;
+}
@@ -0,0 +1,281 @@
+#include "../include/physics_world.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Check every broad phase against brute force on random scenes with moving,
+// sleeping and removed bodies. One world simulates the scene; after each
+// step its body states are copied into one world per broad phase, which
+// then runs physics_world_detect_collisions. Each must find exactly the
+// contact pairs brute force finds, without more narrow phase checks. Fast
+// and teleported bodies move further in a step than the tree's fat margin
+// and velocity prediction cover. A cluster of touching bodies far overhead
+// lies beyond the spatial hash's cell range.
+
+#define TEST_SCENE_COUNT 4
+#define TEST_BODY_COUNT 240
+#define TEST_STEPS 150
+#define TEST_REMOVAL_INTERVAL 10
+#define TEST_REMOVALS 3
+#define TEST_TELEPORT_INTERVAL 7
+#define TEST_TELEPORTS 4
+#define TEST_FAST_BODY_INTERVAL 10     // Every tenth body is fast
+#define TEST_FAST_SPEED 40.0f
+#define TEST_HALF_WIDTH 8.0f
+#define TEST_FAR_BODIES 4              // The last bodies form the far cluster
+#define TEST_FAR_HEIGHT 1.0e12f
+#define TEST_MAX_CONTACTS 8192
+
+typedef struct {
+    const char* name;
+    BroadPhaseType broad_phase;
+} TestConfig;
+
+static const TestConfig configs[] = {
+    { "brute force", BROAD_PHASE_BRUTE_FORCE },
+    { "sweep and prune", BROAD_PHASE_SWEEP_AND_PRUNE },
+    { "aabb tree", BROAD_PHASE_AABB_TREE },
+    { "spatial hash", BROAD_PHASE_SPATIAL_HASH },
+};
+
+#define TEST_CONFIG_COUNT ((int)(sizeof(configs) / sizeof(configs[0])))
+
+// The simulated world plus one mirror per config. Scene body k is
+// bodies[w][k] in world w, or NULL once removed.
+typedef struct {
+    PhysicsWorld* worlds[1 + TEST_CONFIG_COUNT];
+    RigidBody* bodies[1 + TEST_CONFIG_COUNT][TEST_BODY_COUNT];
+} TestScene;
+
+static unsigned int test_random(unsigned int* state) {
+    *state = *state * 1103515245u + 12345u;
+    return (*state >> 16) & 0x7FFFu;
+}
+
+static float test_random_range(unsigned int* state, float min, float max) {
+    return min + (max - min) * (float)test_random(state) / 32767.0f;
+}
+
+static int pair_compare(const void* a, const void* b) {
+    uint64_t pair_a = *(const uint64_t*)a;
+    uint64_t pair_b = *(const uint64_t*)b;
+    return (pair_a > pair_b) - (pair_a < pair_b);
+}
+
+// Contacts as sorted (lower index, higher index) pairs; -1 if they don't fit
+static int collect_pairs(PhysicsWorld* world, uint64_t* pairs) {
+    int count = physics_world_get_collision_count(world);
+    if (count > TEST_MAX_CONTACTS) return -1;
+
+    for (int c = 0; c < count; c++) {
+        const Contact* contact = physics_world_get_contact(world, c);
+        uint64_t a = contact->index_a < contact->index_b ? contact->index_a : contact->index_b;
+        uint64_t b = contact->index_a < contact->index_b ? contact->index_b : contact->index_a;
+        pairs[c] = (a << 32) | b;
+    }
+    qsort(pairs, (size_t)count, sizeof(uint64_t), pair_compare);
+    return count;
+}
+
+static Vector3 random_position(unsigned int* seed) {
+    return vector3_create(test_random_range(seed, -TEST_HALF_WIDTH, TEST_HALF_WIDTH),
+                          test_random_range(seed, 0.5f, 12.0f),
+                          test_random_range(seed, -TEST_HALF_WIDTH, TEST_HALF_WIDTH));
+}
+
+static void add_plane(PhysicsWorld* world, Vector3 normal, float distance) {
+    RigidBody* plane = physics_world_create_body(world);
+    rigid_body_init_plane(plane, normal, distance);
+    physics_world_add_body(world, plane);
+}
+
+static void destroy_scene(TestScene* scene) {
+    for (int w = 0; w <= TEST_CONFIG_COUNT; w++) {
+        physics_world_destroy(scene->worlds[w]);
+    }
+}
+
+// Build the same random scene in every world
+static bool create_scene(TestScene* scene, unsigned int seed) {
+    memset(scene, 0, sizeof(TestScene));
+    for (int w = 0; w <= TEST_CONFIG_COUNT; w++) {
+        scene->worlds[w] = physics_world_create();
+        if (!scene->worlds[w]) {
+            destroy_scene(scene);
+            return false;
+        }
+        physics_world_set_gravity(scene->worlds[w], vector3_create(0.0f, -9.81f, 0.0f));
+
+        // Walls keep the fast bodies in the scene
+        add_plane(scene->worlds[w], vector3_create(0.0f, 1.0f, 0.0f), 0.0f);
+        add_plane(scene->worlds[w], vector3_create(1.0f, 0.0f, 0.0f), -TEST_HALF_WIDTH - 1.0f);
+        add_plane(scene->worlds[w], vector3_create(-1.0f, 0.0f, 0.0f), -TEST_HALF_WIDTH - 1.0f);
+        add_plane(scene->worlds[w], vector3_create(0.0f, 0.0f, 1.0f), -TEST_HALF_WIDTH - 1.0f);
+        add_plane(scene->worlds[w], vector3_create(0.0f, 0.0f, -1.0f), -TEST_HALF_WIDTH - 1.0f);
+    }
+    for (int c = 0; c < TEST_CONFIG_COUNT; c++) {
+        if (!physics_world_set_broad_phase(scene->worlds[1 + c], configs[c].broad_phase)) {
+            destroy_scene(scene);
+            return false;
+        }
+    }
+
+    for (int k = 0; k < TEST_BODY_COUNT; k++) {
+        Vector3 position = random_position(&seed);
+        float speed = k % TEST_FAST_BODY_INTERVAL == 0 ? TEST_FAST_SPEED : 5.0f;
+        Vector3 velocity = vector3_create(test_random_range(&seed, -speed, speed),
+                                          test_random_range(&seed, -speed, speed),
+                                          test_random_range(&seed, -speed, speed));
+        float size = test_random_range(&seed, 0.3f, 0.7f);
+        bool is_box = test_random(&seed) % 3 == 0;
+        bool is_sleeping = test_random(&seed) % 5 == 0;
+
+        for (int w = 0; w <= TEST_CONFIG_COUNT; w++) {
+            RigidBody* body = physics_world_create_body(scene->worlds[w]);
+            if (!body) {
+                destroy_scene(scene);
+                return false;
+            }
+            if (is_box) {
+                rigid_body_init_aabb(body, position, vector3_create(size, size, size), 2.0f);
+            } else {
+                rigid_body_init_sphere(body, position, size, 1.0f);
+            }
+            rigid_body_set_velocity(body, velocity);
+            body->is_sleeping = is_sleeping;
+
+            if (body_handle_is_null(physics_world_add_body_handle(scene->worlds[w], body))) {
+                physics_world_destroy_body(scene->worlds[w], body);
+                destroy_scene(scene);
+                return false;
+            }
+            scene->bodies[w][k] = body;
+        }
+    }
+    return true;
+}
+
+static void remove_random_bodies(TestScene* scene, unsigned int* seed) {
+    for (int r = 0; r < TEST_REMOVALS; r++) {
+        int k = (int)(test_random(seed) % TEST_BODY_COUNT);
+        if (!scene->bodies[0][k]) continue;
+
+        for (int w = 0; w <= TEST_CONFIG_COUNT; w++) {
+            physics_world_destroy_body(scene->worlds[w], scene->bodies[w][k]);
+            scene->bodies[w][k] = NULL;
+        }
+    }
+}
+
+// Move bodies in the simulated world, which the mirrors then copy
+static void teleport_random_bodies(TestScene* scene, unsigned int* seed) {
+    for (int t = 0; t < TEST_TELEPORTS; t++) {
+        int k = (int)(test_random(seed) % TEST_BODY_COUNT);
+        Vector3 position = random_position(seed);
+        if (scene->bodies[0][k]) {
+            scene->bodies[0][k]->position = position;
+        }
+    }
+}
+
+// Put the far cluster back in place, moving and overlapping along x
+static void place_far_bodies(TestScene* scene) {
+    for (int j = 0; j < TEST_FAR_BODIES; j++) {
+        RigidBody* body = scene->bodies[0][TEST_BODY_COUNT - 1 - j];
+        if (!body) continue;
+
+        body->position = vector3_create(0.4f * (float)j, TEST_FAR_HEIGHT, 0.0f);
+        body->velocity = vector3_create(1.0f, 0.0f, 0.0f);
+        body->is_sleeping = false;
+    }
+}
+
+// Copy the simulated state into the mirrors and detect collisions in each
+static void mirror_scene(TestScene* scene) {
+    for (int w = 1; w <= TEST_CONFIG_COUNT; w++) {
+        for (int k = 0; k < TEST_BODY_COUNT; k++) {
+            const RigidBody* source = scene->bodies[0][k];
+            RigidBody* body = scene->bodies[w][k];
+            if (!source) continue;
+
+            body->position = source->position;
+            body->velocity = source->velocity;
+            body->is_sleeping = source->is_sleeping;
+        }
+        physics_world_load_bodies(scene->worlds[w]);
+        physics_world_detect_collisions(scene->worlds[w]);
+    }
+}
+
+// Returns the number of failed checks
+static int run_scene(unsigned int scene_id, int* compared_pairs) {
+    static TestScene scene;
+    static uint64_t expected[TEST_MAX_CONTACTS];
+    static uint64_t found[TEST_MAX_CONTACTS];
+
+    if (!create_scene(&scene, scene_id)) {
+        fprintf(stderr, "FAIL: scene %u: could not build the scene\n", scene_id);
+        return 1;
+    }
+
+    unsigned int seed = scene_id;
+    int failures = 0;
+    for (int step = 0; step < TEST_STEPS && failures == 0; step++) {
+        if (step % TEST_REMOVAL_INTERVAL == TEST_REMOVAL_INTERVAL - 1) {
+            remove_random_bodies(&scene, &seed);
+        }
+        physics_world_step(scene.worlds[0]);
+        if (step % TEST_TELEPORT_INTERVAL == TEST_TELEPORT_INTERVAL - 1) {
+            teleport_random_bodies(&scene, &seed);
+        }
+        place_far_bodies(&scene);
+        mirror_scene(&scene);
+
+        PhysicsWorld* reference = scene.worlds[1];
+        int expected_count = collect_pairs(reference, expected);
+        if (expected_count < 0) {
+            fprintf(stderr, "FAIL: scene %u step %d: more than %d contacts\n", scene_id, step, TEST_MAX_CONTACTS);
+            failures++;
+            break;
+        }
+        *compared_pairs += expected_count;
+
+        for (int c = 1; c < TEST_CONFIG_COUNT; c++) {
+            PhysicsWorld* world = scene.worlds[1 + c];
+            int found_count = collect_pairs(world, found);
+
+            if (found_count != expected_count ||
+                memcmp(found, expected, (size_t)expected_count * sizeof(uint64_t)) != 0) {
+                fprintf(stderr, "FAIL: scene %u step %d: %s found %d contact pairs, brute force %d\n", scene_id, step,
+                        configs[c].name, found_count, expected_count);
+                failures++;
+            }
+            if (world->collision_checks_performed > reference->collision_checks_performed) {
+                fprintf(stderr, "FAIL: scene %u step %d: %s made %d narrow phase checks, brute force %d\n", scene_id,
+                        step, configs[c].name, world->collision_checks_performed,
+                        reference->collision_checks_performed);
+                failures++;
+            }
+        }
+    }
+
+    destroy_scene(&scene);
+    return failures;
+}
+
+int main(void) {
+    int failures = 0;
+    int compared_pairs = 0;
+
+    for (unsigned int scene_id = 1; scene_id <= TEST_SCENE_COUNT; scene_id++) {
+        failures += run_scene(scene_id, &compared_pairs);
+    }
+
+    if (failures > 0) return 1;
+
+    for (int c = 1; c < TEST_CONFIG_COUNT; c++) {
+        printf("test_broad_phase: %s matched brute force on %d contact pairs\n", configs[c].name, compared_pairs);
+    }
+    return 0;
+}
@@ -0,0 +1,106 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "../include/command_queue.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Stress the lock-free command queue with several producers pushing into a
+// small ring while the consumer pops concurrently. Every command must arrive
+// exactly once, and each producer's commands in the order it pushed them.
+
+#define TEST_PRODUCERS 4
+#define TEST_COMMANDS_PER_PRODUCER 200000
+#define TEST_QUEUE_CAPACITY 64
+
+typedef struct {
+    CommandQueue* queue;
+    int producer;
+} ProducerArgs;
+
+static void* producer_main(void* context) {
+    ProducerArgs* args = (ProducerArgs*)context;
+
+    for (int i = 0; i < TEST_COMMANDS_PER_PRODUCER; i++) {
+        BodyCommand command;
+        command.type = BODY_COMMAND_FORCE;
+        command.handle.slot = (uint32_t)args->producer;
+        command.handle.generation = (uint32_t)i;
+        command.body = NULL;
+        command.value = vector3_create((float)args->producer, (float)i, 0.0f);
+
+        // A full ring makes the push fail; retry once the consumer has run
+        while (!command_queue_push(args->queue, &command)) {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+int main(void) {
+    CommandQueue queue;
+    if (!command_queue_init(&queue, TEST_QUEUE_CAPACITY)) {
+        fprintf(stderr, "FAIL: could not create the queue\n");
+        return 1;
+    }
+
+    pthread_t threads[TEST_PRODUCERS];
+    ProducerArgs args[TEST_PRODUCERS];
+    for (int p = 0; p < TEST_PRODUCERS; p++) {
+        args[p].queue = &queue;
+        args[p].producer = p;
+        if (pthread_create(&threads[p], NULL, producer_main, &args[p]) != 0) {
+            fprintf(stderr, "FAIL: could not start producer %d\n", p);
+            return 1;
+        }
+    }
+
+    // Next sequence number expected from each producer
+    int expected[TEST_PRODUCERS] = { 0 };
+    long received = 0;
+    long total = (long)TEST_PRODUCERS * TEST_COMMANDS_PER_PRODUCER;
+    int failures = 0;
+
+    while (received < total) {
+        BodyCommand command;
+        if (!command_queue_pop(&queue, &command)) {
+            sched_yield();
+            continue;
+        }
+
+        int producer = (int)command.handle.slot;
+        int sequence = (int)command.handle.generation;
+        if (producer < 0 || producer >= TEST_PRODUCERS || command.type != BODY_COMMAND_FORCE ||
+            command.value.x != (float)producer) {
+            if (failures++ < 10) fprintf(stderr, "FAIL: corrupt command from producer %d\n", producer);
+        } else if (sequence != expected[producer]) {
+            if (failures++ < 10) {
+                fprintf(stderr, "FAIL: producer %d sent %d, expected %d\n", producer, sequence, expected[producer]);
+            }
+            expected[producer] = sequence + 1;
+        } else {
+            expected[producer]++;
+        }
+        received++;
+    }
+
+    for (int p = 0; p < TEST_PRODUCERS; p++) {
+        pthread_join(threads[p], NULL);
+    }
+
+    BodyCommand extra;
+    if (command_queue_pop(&queue, &extra)) {
+        fprintf(stderr, "FAIL: queue still holds commands after all were received\n");
+        failures++;
+    }
+
+    command_queue_destroy(&queue);
+
+    if (failures > 0) {
+        fprintf(stderr, "test_command_queue: %d failure(s)\n", failures);
+        return 1;
+    }
+    printf("test_command_queue: %ld commands from %d producers, all in order\n", total, TEST_PRODUCERS);
+    return 0;
+}
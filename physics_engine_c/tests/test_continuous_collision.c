@@ -0,0 +1,96 @@
+#include "../include/physics_world.h"
+#include <stdio.h>
+
+// Fire a small fast sphere at a plane and at a thin static box with one
+// simulation iteration per step. It covers several times its own size in a
+// step, so without continuous collision it ends the step past the surface;
+// with it the sphere must stop at the surface and the step must report a
+// swept impact.
+
+#define TEST_RADIUS 0.1f
+#define TEST_SPEED 200.0f
+#define TEST_START_HEIGHT 1.0f
+#define TEST_BOX_HALF_HEIGHT 0.05f
+
+typedef struct {
+    const char* name;
+    bool is_plane;
+} TestTarget;
+
+// Height of the sphere's centre after the first step, and the step's swept impacts
+static bool run_shot(const TestTarget* target, bool continuous, float* height, int* swept_impacts) {
+    PhysicsWorld* world = physics_world_create();
+    if (!world) return false;
+
+    physics_world_set_simulation_iterations(world, 1);
+    physics_world_set_continuous_collision(world, continuous);
+
+    // Both targets have their top surface at y = 0
+    RigidBody* ground = physics_world_create_body(world);
+    if (target->is_plane) {
+        rigid_body_init_plane(ground, vector3_create(0.0f, 1.0f, 0.0f), 0.0f);
+    } else {
+        rigid_body_init_aabb(ground, vector3_create(0.0f, -TEST_BOX_HALF_HEIGHT, 0.0f),
+                             vector3_create(5.0f, TEST_BOX_HALF_HEIGHT, 5.0f), 1.0f);
+        rigid_body_set_static(ground, true);
+    }
+    physics_world_add_body(world, ground);
+
+    RigidBody* sphere = physics_world_create_body(world);
+    rigid_body_init_sphere(sphere, vector3_create(0.0f, TEST_START_HEIGHT, 0.0f), TEST_RADIUS, 1.0f);
+    rigid_body_set_velocity(sphere, vector3_create(0.0f, -TEST_SPEED, 0.0f));
+    sphere->restitution = 0.0f;
+    physics_world_add_body(world, sphere);
+
+    physics_world_step(world);
+    *height = sphere->position.y;
+    *swept_impacts = physics_world_get_step_stats(world).swept_impacts;
+
+    physics_world_destroy(world);
+    return true;
+}
+
+int main(void) {
+    static const TestTarget targets[] = {
+        { "plane", true },
+        { "thin box", false },
+    };
+    int target_count = (int)(sizeof(targets) / sizeof(targets[0]));
+    int failures = 0;
+
+    for (int t = 0; t < target_count; t++) {
+        const TestTarget* target = &targets[t];
+        float discrete_height, swept_height;
+        int discrete_impacts, swept_impacts;
+
+        if (!run_shot(target, false, &discrete_height, &discrete_impacts) ||
+            !run_shot(target, true, &swept_height, &swept_impacts)) {
+            fprintf(stderr, "FAIL: %s: could not run the scene\n", target->name);
+            failures++;
+            continue;
+        }
+
+        // Without sweeping the sphere's centre ends below the surface; a thin
+        // box is passed through entirely
+        float tunnel_height = target->is_plane ? 0.0f : -2.0f * TEST_BOX_HALF_HEIGHT - TEST_RADIUS;
+        if (discrete_height >= tunnel_height) {
+            fprintf(stderr, "FAIL: %s: without continuous collision the sphere stopped at y = %f\n", target->name,
+                    discrete_height);
+            failures++;
+            continue;
+        }
+
+        if (swept_height < TEST_RADIUS - CONTACT_CORRECTION_SLOP || swept_height > TEST_RADIUS ||
+            swept_impacts == 0) {
+            fprintf(stderr, "FAIL: %s: with continuous collision the sphere ended at y = %f after %d swept impacts\n",
+                    target->name, swept_height, swept_impacts);
+            failures++;
+            continue;
+        }
+
+        printf("test_continuous_collision: %s: tunnelled to y = %.3f, swept stop at y = %.3f\n", target->name,
+               discrete_height, swept_height);
+    }
+
+    return failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,148 @@
+#include "../include/physics_world.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Run the same scene on one thread and on several in deterministic mode and
+// require the final body states to match bit for bit, for every broad phase
+// and with the optional collision features switched on.
+
+#define TEST_BODY_COUNT 600
+#define TEST_STEPS 240
+#define TEST_THREADS 4
+
+typedef struct {
+    const char* name;
+    BroadPhaseType broad_phase;
+    bool speculative;
+    bool continuous;
+    bool adaptive;
+} TestConfig;
+
+typedef struct {
+    Vector3 position;
+    Vector3 velocity;
+    bool is_sleeping;
+} BodyState;
+
+static unsigned int test_random(unsigned int* state) {
+    *state = *state * 1103515245u + 12345u;
+    return (*state >> 16) & 0x7FFFu;
+}
+
+static float test_random_range(unsigned int* state, float min, float max) {
+    return min + (max - min) * (float)test_random(state) / 32767.0f;
+}
+
+static void add_plane(PhysicsWorld* world, Vector3 normal, float distance) {
+    RigidBody* plane = physics_world_create_body(world);
+    rigid_body_init_plane(plane, normal, distance);
+    physics_world_add_body(world, plane);
+}
+
+// Simulate the scene and copy out each body's state in id order
+static bool run_scene(const TestConfig* config, int thread_count, BodyState* states) {
+    PhysicsWorld* world = physics_world_create();
+    if (!world) return false;
+
+    physics_world_set_deterministic(world, true);
+    if (!physics_world_set_broad_phase(world, config->broad_phase) ||
+        !physics_world_set_thread_count(world, thread_count)) {
+        physics_world_destroy(world);
+        return false;
+    }
+    physics_world_set_speculative_contacts(world, config->speculative);
+    physics_world_set_continuous_collision(world, config->continuous);
+    if (config->adaptive) {
+        physics_world_set_adaptive_substeps(world, true, 1, PHYSICS_WORLD_MAX_SUBSTEPS);
+    }
+
+    add_plane(world, vector3_create(0.0f, 1.0f, 0.0f), 0.0f);
+    add_plane(world, vector3_create(1.0f, 0.0f, 0.0f), -12.0f);
+    add_plane(world, vector3_create(-1.0f, 0.0f, 0.0f), -12.0f);
+    add_plane(world, vector3_create(0.0f, 0.0f, 1.0f), -12.0f);
+    add_plane(world, vector3_create(0.0f, 0.0f, -1.0f), -12.0f);
+
+    unsigned int seed = 7u;
+    int ids[TEST_BODY_COUNT];
+    for (int i = 0; i < TEST_BODY_COUNT; i++) {
+        RigidBody* body = physics_world_create_body(world);
+        Vector3 position = vector3_create(test_random_range(&seed, -10.0f, 10.0f),
+                                          test_random_range(&seed, 1.0f, 25.0f),
+                                          test_random_range(&seed, -10.0f, 10.0f));
+        if (i % 3 == 0) {
+            rigid_body_init_aabb(body, position, vector3_create(0.4f, 0.4f, 0.4f), 2.0f);
+        } else {
+            rigid_body_init_sphere(body, position, 0.4f, 1.0f);
+        }
+
+        // A few fast bodies give continuous collision something to sweep
+        float speed = (i % 50 == 0) ? 80.0f : 3.0f;
+        rigid_body_set_velocity(body, vector3_create(test_random_range(&seed, -speed, speed),
+                                                     test_random_range(&seed, -speed, 0.0f),
+                                                     test_random_range(&seed, -speed, speed)));
+        ids[i] = body->id;
+        physics_world_add_body(world, body);
+    }
+
+    for (int step = 0; step < TEST_STEPS; step++) {
+        physics_world_step(world);
+    }
+
+    bool complete = true;
+    for (int i = 0; i < TEST_BODY_COUNT; i++) {
+        const RigidBody* body = physics_world_get_body(world, ids[i]);
+        if (!body) {
+            complete = false;
+            break;
+        }
+        memset(&states[i], 0, sizeof(BodyState));
+        states[i].position = body->position;
+        states[i].velocity = body->velocity;
+        states[i].is_sleeping = body->is_sleeping;
+    }
+
+    physics_world_destroy(world);
+    return complete;
+}
+
+int main(void) {
+    static const TestConfig configs[] = {
+        { "brute force", BROAD_PHASE_BRUTE_FORCE, false, false, false },
+        { "sweep and prune", BROAD_PHASE_SWEEP_AND_PRUNE, false, false, false },
+        { "aabb tree", BROAD_PHASE_AABB_TREE, false, false, false },
+        { "spatial hash", BROAD_PHASE_SPATIAL_HASH, false, false, false },
+        { "speculative + continuous + adaptive", BROAD_PHASE_SWEEP_AND_PRUNE, true, true, true },
+    };
+    int config_count = (int)(sizeof(configs) / sizeof(configs[0]));
+
+    static BodyState serial[TEST_BODY_COUNT];
+    static BodyState threaded[TEST_BODY_COUNT];
+    int failures = 0;
+
+    for (int c = 0; c < config_count; c++) {
+        const TestConfig* config = &configs[c];
+        if (!run_scene(config, 1, serial) || !run_scene(config, TEST_THREADS, threaded)) {
+            fprintf(stderr, "FAIL: %s: could not run the scene\n", config->name);
+            failures++;
+            continue;
+        }
+
+        int mismatched = 0;
+        for (int i = 0; i < TEST_BODY_COUNT; i++) {
+            if (memcmp(&serial[i], &threaded[i], sizeof(BodyState)) != 0) {
+                mismatched++;
+            }
+        }
+
+        if (mismatched > 0) {
+            fprintf(stderr, "FAIL: %s: %d of %d bodies differ between 1 and %d threads\n", config->name,
+                    mismatched, TEST_BODY_COUNT, TEST_THREADS);
+            failures++;
+        } else {
+            printf("test_determinism: %s: 1 and %d threads match\n", config->name, TEST_THREADS);
+        }
+    }
+
+    return failures > 0 ? 1 : 0;
+}
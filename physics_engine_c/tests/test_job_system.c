@@ -0,0 +1,143 @@
+#include "../include/job_system.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+// Check that parallel-fors visit every item exactly once for a range of
+// thread counts, item counts and grains, and that a job task runs its
+// submissions one at a time in submission order.
+
+#define TEST_MAX_ITEMS 100003
+#define TEST_TASKS 64
+
+typedef struct {
+    int* visits;
+    int count;
+    int bad_ranges;
+} VisitJob;
+
+static void visit_range(void* context, int begin, int end) {
+    VisitJob* job = (VisitJob*)context;
+    if (begin < 0 || end > job->count || begin >= end) {
+        __atomic_add_fetch(&job->bad_ranges, 1, __ATOMIC_RELAXED);
+        return;
+    }
+    for (int i = begin; i < end; i++) {
+        __atomic_add_fetch(&job->visits[i], 1, __ATOMIC_RELAXED);
+    }
+}
+
+typedef struct {
+    int order[TEST_TASKS];
+    int count;
+} TaskLog;
+
+typedef struct {
+    TaskLog* log;
+    int value;
+} TaskArgs;
+
+static void log_task(void* context) {
+    TaskArgs* args = (TaskArgs*)context;
+    args->log->order[args->log->count++] = args->value;
+}
+
+static int test_parallel_for(int* visits) {
+    static const int thread_counts[] = { 1, 2, 4, 8 };
+    static const int counts[] = { 0, 1, 7, 255, 256, 1000, TEST_MAX_ITEMS };
+    static const int grains[] = { 1, 16, 256 };
+    int failures = 0;
+
+    for (int t = 0; t < (int)(sizeof(thread_counts) / sizeof(thread_counts[0])); t++) {
+        JobSystem* jobs = job_system_create(thread_counts[t]);
+        if (!jobs) {
+            fprintf(stderr, "FAIL: could not start %d threads\n", thread_counts[t]);
+            failures++;
+            continue;
+        }
+
+        for (int c = 0; c < (int)(sizeof(counts) / sizeof(counts[0])); c++) {
+            for (int g = 0; g < (int)(sizeof(grains) / sizeof(grains[0])); g++) {
+                VisitJob job = { visits, counts[c], 0 };
+                for (int i = 0; i < job.count; i++) {
+                    visits[i] = 0;
+                }
+
+                job_system_parallel_for(jobs, job.count, grains[g], visit_range, &job);
+
+                int wrong = 0;
+                for (int i = 0; i < job.count; i++) {
+                    if (visits[i] != 1) wrong++;
+                }
+                if (wrong > 0 || job.bad_ranges > 0) {
+                    fprintf(stderr, "FAIL: %d threads, %d items, grain %d: %d items not visited once, %d bad ranges\n",
+                            thread_counts[t], job.count, grains[g], wrong, job.bad_ranges);
+                    failures++;
+                }
+            }
+        }
+
+        job_system_destroy(jobs);
+    }
+
+    if (failures == 0) {
+        printf("test_job_system: parallel-for visited every item once\n");
+    }
+    return failures;
+}
+
+static int test_task_order(void) {
+    JobTask* task = job_task_create();
+    if (!task) {
+        fprintf(stderr, "FAIL: could not start a job task\n");
+        return 1;
+    }
+
+    TaskLog log;
+    log.count = 0;
+    TaskArgs args[TEST_TASKS];
+    uint64_t tickets[TEST_TASKS];
+    for (int i = 0; i < TEST_TASKS; i++) {
+        args[i].log = &log;
+        args[i].value = i;
+        tickets[i] = job_task_submit(task, log_task, &args[i]);
+    }
+    job_task_wait(task, tickets[TEST_TASKS - 1]);
+
+    int failures = 0;
+    for (int i = 0; i < TEST_TASKS; i++) {
+        if (!job_task_is_complete(task, tickets[i])) {
+            fprintf(stderr, "FAIL: ticket %d incomplete after waiting for a later one\n", i);
+            failures++;
+        }
+    }
+    if (log.count != TEST_TASKS) {
+        fprintf(stderr, "FAIL: %d of %d task submissions ran\n", log.count, TEST_TASKS);
+        failures++;
+    } else {
+        for (int i = 0; i < TEST_TASKS; i++) {
+            if (log.order[i] != i) {
+                fprintf(stderr, "FAIL: submission %d ran in position %d\n", log.order[i], i);
+                failures++;
+                break;
+            }
+        }
+    }
+
+    job_task_destroy(task);
+    if (failures == 0) {
+        printf("test_job_system: %d task submissions ran in order\n", TEST_TASKS);
+    }
+    return failures;
+}
+
+int main(void) {
+    int* visits = (int*)malloc(TEST_MAX_ITEMS * sizeof(int));
+    if (!visits) {
+        fprintf(stderr, "FAIL: out of memory\n");
+        return 1;
+    }
+
+    int failures = test_parallel_for(visits) + test_task_order();
+    free(visits);
+    return failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,582 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "../include/physics_world.h"
+#include "../include/job_system.h"
+#include "../include/allocator.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// charvak_run: load a scene description and run it headless as fast as it
+// goes, once for every combination of the swept parameters. Each run gets
+// its own world, stepped serially; runs are spread over a thread pool.
+// One metrics row per run is written as CSV or JSON.
+//
+// Scene files hold one directive per line; '#' starts a comment:
+//   gravity x y z
+//   timestep dt                    (fractions such as 1/120 are accepted)
+//   steps n
+//   iterations n                   (0 picks the substeps adaptively each step)
+//   integration euler|verlet|rk4
+//   contacts discrete|speculative
+//   restitution r
+//   friction f
+//   plane nx ny nz distance
+//   sphere x y z radius mass [vx vy vz]
+//   box x y z hx hy hz mass [vx vy vz]
+//   sphere_grid nx ny nz x y z spacing radius mass
+// Material, timestep, iterations, integration and contacts are the defaults
+// for the sweep; the command line replaces them with lists of values.
+
+#define RUN_MAX_VALUES 32
+#define RUN_LINE_LENGTH 512
+
+typedef struct {
+    ShapeType shape_type;
+    Vector3 position;              // Plane normal for planes
+    Vector3 velocity;
+    Vector3 half_extents;          // Sphere radius in x
+    float distance;                // Plane distance
+    float mass;
+} SceneBody;
+
+typedef struct {
+    Vector3 gravity;
+    int steps;
+    SceneBody* bodies;
+    int body_count;
+    int body_capacity;
+} Scene;
+
+// Values taken by each swept parameter
+typedef struct {
+    float restitution[RUN_MAX_VALUES];
+    float friction[RUN_MAX_VALUES];
+    float timestep[RUN_MAX_VALUES];
+    int iterations[RUN_MAX_VALUES];
+    int integration[RUN_MAX_VALUES];
+    int contacts[RUN_MAX_VALUES];
+    int restitution_count;
+    int friction_count;
+    int timestep_count;
+    int iterations_count;
+    int integration_count;
+    int contacts_count;
+} Sweep;
+
+typedef struct {
+    float restitution;
+    float friction;
+    float timestep;
+    int iterations;
+    IntegrationMethod integration;
+    int contacts;                  // Index into contacts_names
+
+    // Metrics
+    bool completed;
+    int body_count;
+    double seconds;
+    double steps_per_second;
+    float final_energy;
+    float max_penetration;         // Deepest contact seen in any substep
+    float mean_substeps;           // Over steps that ran; all-asleep steps run none
+} RunResult;
+
+static const char* integration_names[] = { "euler", "verlet", "rk4" };
+static const char* contacts_names[] = { "discrete", "speculative" };
+
+static double run_clock_seconds(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + (double)now.tv_nsec * 1e-9;
+}
+
+static bool parse_float(const char* text, float* value) {
+    char* end;
+    double number = strtod(text, &end);
+    if (end == text) return false;
+
+    // Allow a/b so timesteps can be written as 1/120
+    if (*end == '/') {
+        const char* denominator_text = end + 1;
+        double denominator = strtod(denominator_text, &end);
+        if (end == denominator_text || denominator == 0.0) return false;
+        number /= denominator;
+    }
+    if (*end != '\0') return false;
+
+    *value = (float)number;
+    return true;
+}
+
+static bool parse_int(const char* text, int* value) {
+    char* end;
+    long number = strtol(text, &end, 10);
+    if (end == text || *end != '\0') return false;
+
+    *value = (int)number;
+    return true;
+}
+
+static bool parse_name(const char* text, const char* const* names, int name_count, int* value) {
+    for (int m = 0; m < name_count; m++) {
+        if (strcmp(text, names[m]) == 0) {
+            *value = m;
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool parse_integration(const char* text, int* value) {
+    return parse_name(text, integration_names, (int)(sizeof(integration_names) / sizeof(integration_names[0])), value);
+}
+
+static bool parse_contacts(const char* text, int* value) {
+    return parse_name(text, contacts_names, (int)(sizeof(contacts_names) / sizeof(contacts_names[0])), value);
+}
+
+// Parse a comma-separated list into values of element_size bytes
+static int parse_list(const char* text, void* values, size_t element_size, bool (*parse)(const char*, void*)) {
+    char buffer[RUN_LINE_LENGTH];
+    if (strlen(text) >= sizeof(buffer)) return -1;
+    strcpy(buffer, text);
+
+    int count = 0;
+    for (char* item = strtok(buffer, ","); item; item = strtok(NULL, ",")) {
+        if (count == RUN_MAX_VALUES || !parse(item, (char*)values + (size_t)count * element_size)) return -1;
+        count++;
+    }
+    return count;
+}
+
+static bool parse_float_item(const char* text, void* value) { return parse_float(text, (float*)value); }
+static bool parse_iterations_item(const char* text, void* value) { return parse_int(text, (int*)value) && *(int*)value >= 0; }
+static bool parse_integration_item(const char* text, void* value) { return parse_integration(text, (int*)value); }
+static bool parse_contacts_item(const char* text, void* value) { return parse_contacts(text, (int*)value); }
+
+static SceneBody* scene_add_body(Scene* scene, ShapeType shape_type) {
+    if (!physics_ensure_capacity((void**)&scene->bodies, &scene->body_capacity, scene->body_count + 1,
+                                 sizeof(SceneBody))) {
+        return NULL;
+    }
+
+    SceneBody* body = &scene->bodies[scene->body_count++];
+    memset(body, 0, sizeof(SceneBody));
+    body->shape_type = shape_type;
+    return body;
+}
+
+// Reads the scene and the sweep defaults it sets. Returns false and
+// reports the line on a malformed directive.
+static bool scene_load(Scene* scene, Sweep* sweep, const char* path) {
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        fprintf(stderr, "charvak_run: cannot open scene %s\n", path);
+        return false;
+    }
+
+    char line[RUN_LINE_LENGTH];
+    int line_number = 0;
+    bool ok = true;
+
+    while (ok && fgets(line, sizeof(line), file)) {
+        line_number++;
+        char* comment = strchr(line, '#');
+        if (comment) *comment = '\0';
+
+        char* words[16];
+        int word_count = 0;
+        for (char* word = strtok(line, " \t\r\n"); word && word_count < 16; word = strtok(NULL, " \t\r\n")) {
+            words[word_count++] = word;
+        }
+        if (word_count == 0) continue;
+
+        float f[16] = { 0 };
+        int numbers = word_count - 1;
+        for (int w = 1; w < word_count && ok; w++) {
+            ok = parse_float(words[w], &f[w - 1]);
+        }
+
+        const char* directive = words[0];
+        SceneBody* body = NULL;
+        if (!ok) {
+            // Reported below; integration and contacts take a word argument
+            ok = numbers == 1 && ((strcmp(directive, "integration") == 0 &&
+                                   parse_integration(words[1], &sweep->integration[0])) ||
+                                  (strcmp(directive, "contacts") == 0 &&
+                                   parse_contacts(words[1], &sweep->contacts[0])));
+        } else if (strcmp(directive, "gravity") == 0 && numbers == 3) {
+            scene->gravity = vector3_create(f[0], f[1], f[2]);
+        } else if (strcmp(directive, "timestep") == 0 && numbers == 1 && f[0] > 0.0f) {
+            sweep->timestep[0] = f[0];
+        } else if (strcmp(directive, "steps") == 0 && numbers == 1 && f[0] >= 1.0f) {
+            scene->steps = (int)f[0];
+        } else if (strcmp(directive, "iterations") == 0 && numbers == 1 && f[0] >= 0.0f) {
+            sweep->iterations[0] = (int)f[0];
+        } else if (strcmp(directive, "restitution") == 0 && numbers == 1) {
+            sweep->restitution[0] = f[0];
+        } else if (strcmp(directive, "friction") == 0 && numbers == 1) {
+            sweep->friction[0] = f[0];
+        } else if (strcmp(directive, "plane") == 0 && numbers == 4) {
+            ok = (body = scene_add_body(scene, SHAPE_PLANE)) != NULL;
+            if (ok) {
+                body->position = vector3_create(f[0], f[1], f[2]);
+                body->distance = f[3];
+            }
+        } else if (strcmp(directive, "sphere") == 0 && (numbers == 5 || numbers == 8)) {
+            ok = (body = scene_add_body(scene, SHAPE_SPHERE)) != NULL;
+            if (ok) {
+                body->position = vector3_create(f[0], f[1], f[2]);
+                body->half_extents.x = f[3];
+                body->mass = f[4];
+                body->velocity = vector3_create(f[5], f[6], f[7]);
+            }
+        } else if (strcmp(directive, "box") == 0 && (numbers == 7 || numbers == 10)) {
+            ok = (body = scene_add_body(scene, SHAPE_AABB)) != NULL;
+            if (ok) {
+                body->position = vector3_create(f[0], f[1], f[2]);
+                body->half_extents = vector3_create(f[3], f[4], f[5]);
+                body->mass = f[6];
+                body->velocity = vector3_create(f[7], f[8], f[9]);
+            }
+        } else if (strcmp(directive, "sphere_grid") == 0 && numbers == 9) {
+            int nx = (int)f[0], ny = (int)f[1], nz = (int)f[2];
+            for (int i = 0; i < nx * ny * nz && ok; i++) {
+                ok = (body = scene_add_body(scene, SHAPE_SPHERE)) != NULL;
+                if (ok) {
+                    body->position = vector3_create(f[3] + (float)(i % nx) * f[6],
+                                                    f[4] + (float)(i / (nx * nz)) * f[6],
+                                                    f[5] + (float)((i / nx) % nz) * f[6]);
+                    body->half_extents.x = f[7];
+                    body->mass = f[8];
+                }
+            }
+        } else {
+            ok = false;
+        }
+    }
+
+    if (!ok) {
+        fprintf(stderr, "charvak_run: %s:%d: invalid directive\n", path, line_number);
+    }
+    fclose(file);
+    return ok;
+}
+
+static void scene_release(Scene* scene) {
+    physics_free(scene->bodies, (size_t)scene->body_capacity * sizeof(SceneBody));
+    memset(scene, 0, sizeof(Scene));
+}
+
+// Build a world for one run, step it and record the metrics
+static void run_scene(const Scene* scene, RunResult* result) {
+    PhysicsWorld world;
+    physics_world_init(&world);
+    physics_world_set_local_ids(&world, true);
+    physics_world_set_gravity(&world, scene->gravity);
+    physics_world_set_timestep(&world, result->timestep);
+    if (result->iterations > 0) {
+        physics_world_set_simulation_iterations(&world, result->iterations);
+    } else {
+        physics_world_set_adaptive_substeps(&world, true, 1, PHYSICS_WORLD_MAX_SUBSTEPS);
+    }
+    physics_world_set_integration_method(&world, result->integration);
+    physics_world_set_speculative_contacts(&world, result->contacts == 1);
+
+    // Bodies are never edited between steps, so loads can skip resting ones
+    physics_world_set_tracked_edits(&world, true);
+
+    for (int b = 0; b < scene->body_count; b++) {
+        const SceneBody* source = &scene->bodies[b];
+        RigidBody* body = physics_world_create_body(&world);
+        if (!body) {
+            physics_world_release(&world);
+            return;
+        }
+
+        if (source->shape_type == SHAPE_PLANE) {
+            rigid_body_init_plane(body, source->position, source->distance);
+        } else if (source->shape_type == SHAPE_SPHERE) {
+            rigid_body_init_sphere(body, source->position, source->half_extents.x, source->mass);
+        } else {
+            rigid_body_init_aabb(body, source->position, source->half_extents, source->mass);
+        }
+        rigid_body_set_velocity(body, source->velocity);
+        rigid_body_set_restitution(body, result->restitution);
+        rigid_body_set_friction(body, result->friction);
+
+        if (physics_world_add_body(&world, body) == -1) {
+            physics_world_destroy_body(&world, body);
+            physics_world_release(&world);
+            return;
+        }
+    }
+
+    float max_penetration = 0.0f;
+    long substeps = 0;
+    int simulated_steps = 0;
+    double start = run_clock_seconds();
+
+    for (int step = 0; step < scene->steps; step++) {
+        physics_world_step(&world);
+
+        PhysicsStepStats stats = physics_world_get_step_stats(&world);
+        if (stats.max_penetration > max_penetration) max_penetration = stats.max_penetration;
+        if (stats.substeps > 0) {
+            substeps += stats.substeps;
+            simulated_steps++;
+        }
+    }
+
+    result->seconds = run_clock_seconds() - start;
+    result->steps_per_second = result->seconds > 0.0 ? (double)scene->steps / result->seconds : 0.0;
+    result->body_count = physics_world_get_body_count(&world);
+    result->final_energy = physics_world_get_total_kinetic_energy(&world);
+    result->max_penetration = max_penetration;
+    result->mean_substeps = simulated_steps > 0 ? (float)((double)substeps / (double)simulated_steps) : 0.0f;
+    result->completed = true;
+
+    physics_world_release(&world);
+}
+
+typedef struct {
+    const Scene* scene;
+    RunResult* results;
+} RunJob;
+
+static void run_range(void* context, int begin, int end) {
+    RunJob* job = (RunJob*)context;
+
+    for (int r = begin; r < end; r++) {
+        run_scene(job->scene, &job->results[r]);
+    }
+}
+
+static void write_csv(FILE* out, const RunResult* results, int run_count, int steps) {
+    fprintf(out, "run,restitution,friction,timestep,iterations,integration,contacts,bodies,steps,"
+                 "seconds,steps_per_second,final_energy,max_penetration,mean_substeps,completed\n");
+    for (int r = 0; r < run_count; r++) {
+        const RunResult* result = &results[r];
+        fprintf(out, "%d,%g,%g,%g,%d,%s,%s,%d,%d,%.6f,%.1f,%.6g,%.6g,%.3g,%d\n",
+                r, result->restitution, result->friction, result->timestep, result->iterations,
+                integration_names[result->integration], contacts_names[result->contacts], result->body_count,
+                steps, result->seconds,
+                result->steps_per_second, result->final_energy, result->max_penetration, result->mean_substeps,
+                result->completed ? 1 : 0);
+    }
+}
+
+static void write_json(FILE* out, const RunResult* results, int run_count, int steps) {
+    fprintf(out, "[\n");
+    for (int r = 0; r < run_count; r++) {
+        const RunResult* result = &results[r];
+        fprintf(out, "  {\"run\": %d, \"restitution\": %g, \"friction\": %g, \"timestep\": %g, "
+                     "\"iterations\": %d, \"integration\": \"%s\", \"contacts\": \"%s\", "
+                     "\"bodies\": %d, \"steps\": %d, "
+                     "\"seconds\": %.6f, \"steps_per_second\": %.1f, \"final_energy\": %.6g, "
+                     "\"max_penetration\": %.6g, \"mean_substeps\": %.3g, \"completed\": %s}%s\n",
+                r, result->restitution, result->friction, result->timestep, result->iterations,
+                integration_names[result->integration], contacts_names[result->contacts], result->body_count,
+                steps, result->seconds, result->steps_per_second, result->final_energy, result->max_penetration,
+                result->mean_substeps, result->completed ? "true" : "false", r + 1 < run_count ? "," : "");
+    }
+    fprintf(out, "]\n");
+}
+
+static void print_usage(void) {
+    fprintf(stderr,
+            "Usage: charvak_run [options] SCENE\n"
+            "Runs SCENE headless once per combination of the swept values.\n"
+            "\n"
+            "Options (LIST is comma-separated and overrides the scene's value):\n"
+            "  -r, --restitution LIST   Restitution of every body\n"
+            "  -f, --friction LIST      Friction of every body\n"
+            "  -t, --timestep LIST      Timesteps, e.g. 1/60,1/120\n"
+            "  -i, --iterations LIST    Simulation iterations per step; 0 adapts them each step\n"
+            "  -m, --integration LIST   euler, verlet or rk4\n"
+            "  -c, --contacts LIST      discrete, or speculative to catch gaps closing within a step\n"
+            "  -s, --steps N            Steps per run\n"
+            "  -j, --jobs N             Worker threads (default 1)\n"
+            "  -o, --output FILE        Write results to FILE instead of stdout\n"
+            "      --format csv|json    Output format (default from FILE's extension, else csv)\n"
+            "  -h, --help               Show this message\n");
+}
+
+static bool is_option(const char* arg, const char* short_name, const char* long_name) {
+    return (short_name && strcmp(arg, short_name) == 0) || strcmp(arg, long_name) == 0;
+}
+
+int main(int argc, char** argv) {
+    Scene scene;
+    memset(&scene, 0, sizeof(Scene));
+    scene.gravity = vector3_create(0.0f, -9.81f, 0.0f);
+    scene.steps = 600;
+
+    // Scene defaults, replaced by the scene file and then by the command line
+    Sweep sweep;
+    memset(&sweep, 0, sizeof(Sweep));
+    sweep.restitution[0] = 0.5f;
+    sweep.friction[0] = 0.3f;
+    sweep.timestep[0] = 1.0f / 60.0f;
+    sweep.iterations[0] = 1;
+    sweep.integration[0] = INTEGRATION_VERLET;
+
+    Sweep overrides;
+    memset(&overrides, 0, sizeof(Sweep));
+    const char* scene_path = NULL;
+    const char* output_path = NULL;
+    const char* format = NULL;
+    int steps = 0;
+    int jobs = 1;
+
+    for (int a = 1; a < argc; a++) {
+        const char* arg = argv[a];
+        const char* value = a + 1 < argc ? argv[a + 1] : NULL;
+        int count = 0;
+
+        if (is_option(arg, "-h", "--help")) {
+            print_usage();
+            return 0;
+        }
+        if (arg[0] != '-') {
+            scene_path = arg;
+            continue;
+        }
+        if (!value) {
+            fprintf(stderr, "charvak_run: %s needs a value\n", arg);
+            return 2;
+        }
+        a++;
+
+        if (is_option(arg, "-r", "--restitution")) {
+            count = overrides.restitution_count = parse_list(value, overrides.restitution, sizeof(float), parse_float_item);
+        } else if (is_option(arg, "-f", "--friction")) {
+            count = overrides.friction_count = parse_list(value, overrides.friction, sizeof(float), parse_float_item);
+        } else if (is_option(arg, "-t", "--timestep")) {
+            count = overrides.timestep_count = parse_list(value, overrides.timestep, sizeof(float), parse_float_item);
+            for (int v = 0; v < count; v++) {
+                if (!(overrides.timestep[v] > 0.0f)) count = -1;
+            }
+        } else if (is_option(arg, "-i", "--iterations")) {
+            count = overrides.iterations_count = parse_list(value, overrides.iterations, sizeof(int), parse_iterations_item);
+        } else if (is_option(arg, "-m", "--integration")) {
+            count = overrides.integration_count = parse_list(value, overrides.integration, sizeof(int),
+                                                             parse_integration_item);
+        } else if (is_option(arg, "-c", "--contacts")) {
+            count = overrides.contacts_count = parse_list(value, overrides.contacts, sizeof(int), parse_contacts_item);
+        } else if (is_option(arg, "-s", "--steps")) {
+            count = parse_int(value, &steps) && steps > 0 ? 1 : -1;
+        } else if (is_option(arg, "-j", "--jobs")) {
+            count = parse_int(value, &jobs) && jobs > 0 ? 1 : -1;
+        } else if (is_option(arg, "-o", "--output")) {
+            output_path = value;
+            count = 1;
+        } else if (is_option(arg, NULL, "--format")) {
+            format = value;
+            count = strcmp(value, "csv") == 0 || strcmp(value, "json") == 0 ? 1 : -1;
+        } else {
+            fprintf(stderr, "charvak_run: unknown option %s\n", arg);
+            print_usage();
+            return 2;
+        }
+
+        if (count < 1) {
+            fprintf(stderr, "charvak_run: invalid value for %s: %s\n", arg, value);
+            return 2;
+        }
+    }
+
+    if (!scene_path) {
+        print_usage();
+        return 2;
+    }
+    if (!scene_load(&scene, &sweep, scene_path)) {
+        scene_release(&scene);
+        return 1;
+    }
+    if (steps > 0) scene.steps = steps;
+
+    // Unswept parameters keep the single value from the scene
+    if (overrides.restitution_count) memcpy(sweep.restitution, overrides.restitution, sizeof(sweep.restitution));
+    if (overrides.friction_count) memcpy(sweep.friction, overrides.friction, sizeof(sweep.friction));
+    if (overrides.timestep_count) memcpy(sweep.timestep, overrides.timestep, sizeof(sweep.timestep));
+    if (overrides.iterations_count) memcpy(sweep.iterations, overrides.iterations, sizeof(sweep.iterations));
+    if (overrides.integration_count) memcpy(sweep.integration, overrides.integration, sizeof(sweep.integration));
+    if (overrides.contacts_count) memcpy(sweep.contacts, overrides.contacts, sizeof(sweep.contacts));
+    sweep.restitution_count = overrides.restitution_count ? overrides.restitution_count : 1;
+    sweep.friction_count = overrides.friction_count ? overrides.friction_count : 1;
+    sweep.timestep_count = overrides.timestep_count ? overrides.timestep_count : 1;
+    sweep.iterations_count = overrides.iterations_count ? overrides.iterations_count : 1;
+    sweep.integration_count = overrides.integration_count ? overrides.integration_count : 1;
+    sweep.contacts_count = overrides.contacts_count ? overrides.contacts_count : 1;
+
+    int run_count = sweep.restitution_count * sweep.friction_count * sweep.timestep_count *
+                    sweep.iterations_count * sweep.integration_count * sweep.contacts_count;
+    RunResult* results = (RunResult*)physics_alloc((size_t)run_count * sizeof(RunResult));
+    if (!results) {
+        fprintf(stderr, "charvak_run: out of memory\n");
+        scene_release(&scene);
+        return 1;
+    }
+
+    // Cartesian product, with contacts varying fastest
+    memset(results, 0, (size_t)run_count * sizeof(RunResult));
+    for (int r = 0; r < run_count; r++) {
+        int rest = r;
+        RunResult* result = &results[r];
+        result->contacts = sweep.contacts[rest % sweep.contacts_count];
+        rest /= sweep.contacts_count;
+        result->integration = (IntegrationMethod)sweep.integration[rest % sweep.integration_count];
+        rest /= sweep.integration_count;
+        result->iterations = sweep.iterations[rest % sweep.iterations_count];
+        rest /= sweep.iterations_count;
+        result->timestep = sweep.timestep[rest % sweep.timestep_count];
+        rest /= sweep.timestep_count;
+        result->friction = sweep.friction[rest % sweep.friction_count];
+        rest /= sweep.friction_count;
+        result->restitution = sweep.restitution[rest];
+    }
+
+    JobSystem* job_system = jobs > 1 ? job_system_create(jobs) : NULL;
+    if (jobs > 1 && !job_system) {
+        fprintf(stderr, "charvak_run: could not start %d threads, running serially\n", jobs);
+    }
+
+    double start = run_clock_seconds();
+    RunJob job = { &scene, results };
+    job_system_parallel_for(job_system, run_count, 1, run_range, &job);
+    double seconds = run_clock_seconds() - start;
+    job_system_destroy(job_system);
+
+    FILE* out = output_path ? fopen(output_path, "w") : stdout;
+    if (!out) {
+        fprintf(stderr, "charvak_run: cannot write %s\n", output_path);
+        physics_free(results, (size_t)run_count * sizeof(RunResult));
+        scene_release(&scene);
+        return 1;
+    }
+
+    if (!format) {
+        size_t length = output_path ? strlen(output_path) : 0;
+        format = length >= 5 && strcmp(output_path + length - 5, ".json") == 0 ? "json" : "csv";
+    }
+    if (strcmp(format, "json") == 0) {
+        write_json(out, results, run_count, scene.steps);
+    } else {
+        write_csv(out, results, run_count, scene.steps);
+    }
+    if (out != stdout) fclose(out);
+
+    int failed = 0;
+    for (int r = 0; r < run_count; r++) {
+        failed += results[r].completed ? 0 : 1;
+    }
+    fprintf(stderr, "charvak_run: %d runs of %d steps, %d bodies, in %.2f s on %d thread(s)%s\n",
+            run_count, scene.steps, scene.body_count, seconds, jobs, failed ? " (some runs failed)" : "");
+
+    physics_free(results, (size_t)run_count * sizeof(RunResult));
+    scene_release(&scene);
+    return failed ? 1 : 0;
+}